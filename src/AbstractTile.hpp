@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 
+#include "InternedString.hpp"
 #include "Types.hpp"
 
 #include "libtcod.hpp"
@@ -34,8 +35,8 @@ namespace rlns
             int character;
             TCODColor fgColor;
             TCODColor bgColor;
-            std::string shortdesc;
-            std::string longdesc;
+            InternedString shortdesc; // shared with every other object described alike
+            InternedString longdesc;
 
 
         // Member Functions
@@ -43,8 +44,8 @@ namespace rlns
             AbstractTile(const int c, 
                          const TCODColor& fg, 
                          const TCODColor& bg,
-                         const std::string& sd,
-                         const std::string& ld)
+                         const InternedString& sd,
+                         const InternedString& ld)
             : character(c), fgColor(fg), bgColor(bg), shortdesc(sd), longdesc(ld) {}
 
             AbstractTile(RLNSZip& zip) // used for save game loading
@@ -57,8 +58,8 @@ namespace rlns
             TCODColor getFgColor() const { return fgColor; }
             TCODColor getBgColor() const { return bgColor; }
 
-            std::string shortDescription() const { return shortdesc; }
-            std::string longDescription() const { return longdesc; }
+            const std::string& shortDescription() const { return shortdesc; }
+            const std::string& longDescription() const { return longdesc; }
 
             virtual void saveToDisk(RLNSZip&) const;
     };
@@ -34,6 +34,7 @@ namespace rlns
             virtual ~Actor() {}
 
             void giveItem(const ItemPtr);
+            const Inventory& getInventory() const { return inventory; }
 
             void shiftPosition(const DirectionType); 
 
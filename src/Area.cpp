@@ -38,11 +38,11 @@ namespace rlns
     /*--------------------------------------------------------------------------------
         Function    : Area::getRandomPoint
         Description : returns a random Point contained in the room.
-        Inputs      : TCODRandom generator
+        Inputs      : random number generator
         Outputs     : None
         Return      : Point
     --------------------------------------------------------------------------------*/
-    Point Area::getRandomPoint(TCODRandom& rand) const
+    Point Area::getRandomPoint(Random& rand) const
     {
         int x = rand.getInt(topLeft.X(), bottomRight.X());
         int y = rand.getInt(topLeft.Y(), bottomRight.Y());
@@ -51,6 +51,167 @@ namespace rlns
 
 
 
+    /*--------------------------------------------------------------------------------
+        Function    : Area::localIndex
+        Description : Converts a map coordinate inside the area's bounding box into
+                      an index into openIndex.
+        Inputs      : Point inside the area
+        Outputs     : None
+        Return      : int
+    --------------------------------------------------------------------------------*/
+    int Area::localIndex(const Point& pt) const
+    {
+        int width = dimensions.X() + 1;
+        return (pt.Y() - topLeft.Y()) * width + (pt.X() - topLeft.X());
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Area::addOpenCell
+        Description : Appends a cell to the open cell list if it isn't already there.
+        Inputs      : Point inside the area
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Area::addOpenCell(const Point& pt)
+    {
+        int& index = openIndex.at(localIndex(pt));
+        if(index >= 0) return;
+
+        index = openCells.size();
+        openCells.push_back(pt);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Area::removeOpenCell
+        Description : Removes a cell from the open cell list by swapping the last
+                      cell into its slot, so the removal is constant time.
+        Inputs      : Point inside the area
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Area::removeOpenCell(const Point& pt)
+    {
+        int& index = openIndex.at(localIndex(pt));
+        if(index < 0) return;
+
+        Point last = openCells.back();
+        openCells.at(index) = last;
+        openIndex.at(localIndex(last)) = index;
+        openCells.pop_back();
+        index = -1;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Area::findOpenCells
+        Description : Scans the area's bounding box and rebuilds the list of walkable
+                      cells.  This is run once the map has been generated; after
+                      that, edits should be reported through updateOpenCell().
+        Inputs      : Map object
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Area::findOpenCells(const MapPtr map)
+    {
+        openCells.clear();
+        openIndex.assign((dimensions.X()+1) * (dimensions.Y()+1), -1);
+
+        // the area may overhang the map edge by its wall ring
+        int left   = max(topLeft.X(), 0);
+        int top    = max(topLeft.Y(), 0);
+        int right  = min(bottomRight.X(), static_cast<int>(map->getWidth())-1);
+        int bottom = min(bottomRight.Y(), static_cast<int>(map->getHeight())-1);
+
+        for(int y=top; y<=bottom; ++y)
+        {
+            for(int x=left; x<=right; ++x)
+            {
+                if(map->isWalkable(x,y))
+                {
+                    addOpenCell(Point(x,y));
+                }
+            }
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Area::updateOpenCell
+        Description : Re-checks a single cell after the map was edited there and adds
+                      it to or removes it from the open cell list.
+        Inputs      : Map object, edited Point
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Area::updateOpenCell(const MapPtr map, const Point& pt)
+    {
+        if(!contains(pt) || openIndex.empty()) return;
+        if(!map->isInBoard(pt)) return;
+
+        if(map->isWalkable(pt))
+            addOpenCell(pt);
+        else
+            removeOpenCell(pt);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Area::getRandomOpenPoint
+        Description : returns a random walkable Point in the area with a single draw.
+                      findOpenCells() must have been called first.
+        Inputs      : random number generator
+        Outputs     : None
+        Return      : Point
+    --------------------------------------------------------------------------------*/
+    Point Area::getRandomOpenPoint(Random& rand) const
+    {
+        if(openCells.empty())
+        {
+            throw out_of_range("Area has no open cells");
+        }
+        return openCells[rand.getInt(0, openCells.size()-1)];
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Area::getRandomOpenPoints
+        Description : Picks up to n distinct walkable Points in the area, for spawning
+                      several objects at once.  Uses Floyd's sampling algorithm so the
+                      cost depends on n rather than on the size of the area.
+        Inputs      : result vector, random number generator, number of Points wanted
+        Outputs     : None
+        Return      : void (the Points are returned through the vector parameter)
+    --------------------------------------------------------------------------------*/
+    void Area::getRandomOpenPoints(vector<Point>& result, Random& rand, const size_t n) const
+    {
+        result.clear();
+
+        int total = openCells.size();
+        int wanted = min(static_cast<int>(n), total);
+
+        set<int> chosen;
+        for(int j=total-wanted; j<total; ++j)
+        {
+            int i = rand.getInt(0, j);
+            if(!chosen.insert(i).second)
+            {
+                chosen.insert(j);
+                i = j;
+            }
+            result.push_back(openCells[i]);
+        }
+    }
+
+
+
     /*--------------------------------------------------------------------------------
         Function    : Area::getPossibleCorridorTo
         Description : returns a pair<Area,DirectionType> containing the area of a
@@ -111,12 +272,12 @@ namespace rlns
     /*-------------------------------------------------------------------------------- 
         Function    : addColumnsToSquareArea
         Description : adds a series of columns to any square room.
-        Inputs      : Map object, random number generator, topleft and 
+        Inputs      : tile buffer, random number generator, topleft and 
                       bottomright corners of a room
         Outputs     : None
         Return      : void
     --------------------------------------------------------------------------------*/
-    void addColumnsToSquareRoom(MapPtr map, TCODRandom& rand, const Area& room)
+    void addColumnsToSquareRoom(TileBuffer& tiles, Random& rand, const Area& room)
     {
         Point columnOffset(2,2);
         Point TL = room.getTL() + columnOffset;
@@ -136,7 +297,7 @@ namespace rlns
                 if((x + y) & 1) continue;
                 if(x % density) continue;
                 if(y % density) continue;
-                map->setBottomMostAt(x,y, map->tileset->getWallTileID());
+                tiles.setBottomMostAt(x,y, tiles.tileset->getWallTileID());
             }
         }
     }
@@ -150,11 +311,11 @@ namespace rlns
     /*--------------------------------------------------------------------------------
         Function    : squareHall
         Description : generates an empty square room that fills an entire node.
-        Inputs      : Level object, BSP node
+        Inputs      : tile buffer, BSP node
         Outputs     : None
         Return      : a Area object to add to the Level's roomList
     --------------------------------------------------------------------------------*/
-    Area squareHall(MapPtr map, const TCODBsp& node)
+    Area squareHall(TileBuffer& tiles, const BSPNode& node)
     {
         // get node dimensions, offset one to account for room walls
         int x = node.x, y = node.y;         // topleft corner
@@ -165,7 +326,7 @@ namespace rlns
         {
             for(int b=y; b<h; b++)
             {
-                map->setBottomMostAt(a,b, map->tileset->getFloorTileID());
+                tiles.setBottomMostAt(a,b, tiles.tileset->getFloorTileID());
             }
         }
 
@@ -178,12 +339,12 @@ namespace rlns
         Function    : squareArea
         Description : similar to squareHall(), except that it only digs out a
                       subsection of the node.
-        Inputs      : Level object, BSP node, random number generator, minimum room
+        Inputs      : tile buffer, BSP node, random number generator, minimum room
                       dimension
         Outputs     : None
         Return      : a Area object to add to the Level's roomList
     --------------------------------------------------------------------------------*/
-    Area squareRoom(MapPtr map, const TCODBsp& node, TCODRandom& rand, const int minDim)
+    Area squareRoom(TileBuffer& tiles, const BSPNode& node, Random& rand, const int minDim)
     {
         // get the node dimensions, they're the room limits
         int xlim = node.x, ylim = node.y;
@@ -200,7 +361,7 @@ namespace rlns
         {
             for(int b=y; b<h; b++)
             {
-                map->setBottomMostAt(a,b, map->tileset->getFloorTileID());
+                tiles.setBottomMostAt(a,b, tiles.tileset->getFloorTileID());
             }
         }
 
@@ -216,14 +377,14 @@ namespace rlns
                       therefore as big as the node, one of the smaller rooms will
                       stretch across the full width of the node, and the other
                       across the height.
-        Inputs      : Level object, BSP node, random number generator, minimum room
+        Inputs      : tile buffer, BSP node, random number generator, minimum room
                       dimension
         Outputs     : None
         Return      : a Area object to add to the Level's roomList
     --------------------------------------------------------------------------------*/
     // TODO: Consider breaking this function up into
     // T shaped rooms, L shaped rooms, and + shaped rooms.
-    Area crossHall(MapPtr map, const TCODBsp& node, TCODRandom& rand, const int minDim)
+    Area crossHall(TileBuffer& tiles, const BSPNode& node, Random& rand, const int minDim)
     {
         // get the node dimensions, they're the room limits
         int llim = node.x, tlim = node.y;
@@ -246,8 +407,8 @@ namespace rlns
         unsigned int brx1, brx2;
         unsigned int bry1, bry2;
 
-        unsigned int width  = rand.getInt(minDim, 3*node.w/4, 0);
-        unsigned int height = rand.getInt(minDim, 3*node.h/4, 0);
+        unsigned int width  = rand.getInt(minDim, 3*node.w/4);
+        unsigned int height = rand.getInt(minDim, 3*node.h/4);
 
         if(vert)
         {
@@ -280,24 +441,24 @@ namespace rlns
 
         // cross rooms occasionally dig all the way up to the map edge.
         // These next few lines are a hack to prevent this.
-        if(brx1 == map->getWidth()) --brx1;
-        if(bry1 == map->getHeight()) --bry1;
-        if(brx2 == map->getWidth()) --brx2;
-        if(bry2 == map->getHeight()) --bry2;
+        if(brx1 == tiles.getMapWidth()) --brx1;
+        if(bry1 == tiles.getMapHeight()) --bry1;
+        if(brx2 == tiles.getMapWidth()) --brx2;
+        if(bry2 == tiles.getMapHeight()) --bry2;
 
         // dig the rooms
         for(unsigned int a=tlx1; a<brx1; a++)
         {
             for(unsigned int b=tly1; b<bry1; b++)
             {
-                map->setBottomMostAt(a,b, map->tileset->getFloorTileID());
+                tiles.setBottomMostAt(a,b, tiles.tileset->getFloorTileID());
             }
         }
         for(unsigned int a=tlx2; a<brx2; a++)
         {
             for(unsigned int b=tly2; b<bry2; b++)
             {
-                map->setBottomMostAt(a,b, map->tileset->getFloorTileID());
+                tiles.setBottomMostAt(a,b, tiles.tileset->getFloorTileID());
             }
         }
         return Area(Point(llim-1, tlim-1), Point(rlim, blim));
@@ -315,11 +476,11 @@ namespace rlns
                       as big across as the smallest node dimension; if the node is not
                       square, this may make a circular hall much smaller than its 
                       parent node.
-        Inputs      : Level object, TCODBsp node
+        Inputs      : tile buffer, BSP node
         Outputs     : None
         Return      : a Area object to add to the Level's roomList 
     --------------------------------------------------------------------------------*/
-    Area circularHall(MapPtr map, const TCODBsp& node)
+    Area circularHall(TileBuffer& tiles, const BSPNode& node)
     {
         // get node dimensions, offset one if a dimension is even to allow
         // for a center point.
@@ -344,7 +505,7 @@ namespace rlns
                 // and avoids the square root function in distance
                 if(relDistance(center, Point(a,b)) < radius*radius)
                 {
-                    map->setBottomMostAt(a,b, map->tileset->getFloorTileID());
+                    tiles.setBottomMostAt(a,b, tiles.tileset->getFloorTileID());
                 }
             }
         }
@@ -4,10 +4,14 @@
 #include <algorithm>
 #include <iostream>
 #include <stdexcept>
+#include <set>
 #include <utility>
+#include <vector>
 
+#include "BSPTree.hpp"
 #include "Map.hpp"
 #include "Point.hpp"
+#include "Random.hpp"
 #include "Utility.hpp"
 
 #include "libtcod.hpp"
@@ -33,7 +37,19 @@ namespace rlns
             Point bottomRight;
             Point dimensions;
 
+            // Compact list of the walkable cells inside the area, so that random
+            // placement is a single indexed draw instead of a rejection loop.
+            // openIndex maps each cell of the bounding box to its position in
+            // openCells (or -1), which keeps updates after map edits O(1).
+            std::vector<Point> openCells;
+            std::vector<int> openIndex;
+
         // Member Functions
+        private:
+            int localIndex(const Point&) const;
+            void addOpenCell(const Point&);
+            void removeOpenCell(const Point&);
+
         public:
             Area() {}
 
@@ -52,18 +68,29 @@ namespace rlns
             Point getBR()  const { return bottomRight; }
             Point getDim() const { return dimensions; }
 
-            Point getRandomPoint(TCODRandom&) const;
+            bool contains(const Point& pt) const
+            { return pt.withinBounds(topLeft, bottomRight); }
+
+            size_t getNumOpenCells() const
+            { return openCells.size(); }
+
+            void findOpenCells(const MapPtr);
+            void updateOpenCell(const MapPtr, const Point&);
+
+            Point getRandomPoint(Random&) const;
+            Point getRandomOpenPoint(Random&) const;
+            void getRandomOpenPoints(std::vector<Point>&, Random&, const size_t) const;
             std::pair<Area, DirectionType> getPossibleCorridorTo(const Area&) const;
     };
 
     // Area creation helper functions
-    void addColumnsToSquareRoom(MapPtr, TCODRandom&, const Area&);
+    void addColumnsToSquareRoom(TileBuffer&, Random&, const Area&);
 
     // Area creation functions (Halls fill the whole node, rooms take a subset)
-    Area squareHall(MapPtr, const TCODBsp&);
-    Area squareRoom(MapPtr, const TCODBsp&, TCODRandom&, const int);
-    Area crossHall(MapPtr, const TCODBsp&, TCODRandom&, const int);
-    Area circularHall(MapPtr, const TCODBsp&);
+    Area squareHall(TileBuffer&, const BSPNode&);
+    Area squareRoom(TileBuffer&, const BSPNode&, Random&, const int);
+    Area crossHall(TileBuffer&, const BSPNode&, Random&, const int);
+    Area circularHall(TileBuffer&, const BSPNode&);
 }
 
 #endif
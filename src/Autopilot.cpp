@@ -0,0 +1,90 @@
+#include "Autopilot.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    const int Autopilot::PICK_UP_ODDS;
+
+    /*--------------------------------------------------------------------------------
+        Function    : typedKey
+        Description : Returns the key press that types the given character.
+        Inputs      : character
+        Outputs     : None
+        Return      : TCOD_key_t
+    --------------------------------------------------------------------------------*/
+    static TCOD_key_t typedKey(const char c)
+    {
+        TCOD_key_t key = TCOD_key_t();
+        key.vk = TCODK_CHAR;
+        key.c = c;
+        key.pressed = true;
+        return key;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Autopilot::Autopilot(uint32_t)
+        Description : Makes an autopilot that walks at random.  The same seed
+                      always gives the same walk.
+        Inputs      : seed
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    Autopilot::Autopilot(const uint32_t seed)
+    : next(0), rand(seed) {}
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Autopilot::Autopilot(string)
+        Description : Makes an autopilot that presses the keys of a script.  Keys
+                      are given as the characters they type, as in 'uiojlm,.' for
+                      the eight directions and 'd' to pick up.  A script with no
+                      key that makes a playable event gives a random walk.
+        Inputs      : script
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    Autopilot::Autopilot(const string& keys)
+    : next(0), rand(0u)
+    {
+        for(size_t i=0; i<keys.size(); ++i)
+        {
+            switch(handler.keyToEvent(typedKey(keys[i])))
+            {
+                case NO_EVENT:
+                case COMMAND:
+                case EQUIPMENT:
+                case SAVE:
+                    break;
+                default:
+                    script += keys[i];
+                    break;
+            }
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Autopilot::nextEvent
+        Description : Returns the event to play next.
+        Inputs      : None
+        Outputs     : None
+        Return      : EventType
+    --------------------------------------------------------------------------------*/
+    EventType Autopilot::nextEvent()
+    {
+        if(!script.empty())
+        {
+            char c = script[next];
+            next = (next + 1) % script.size();
+            return handler.keyToEvent(typedKey(c));
+        }
+
+        if(rand.getInt(0, PICK_UP_ODDS - 1) == 0) return ITEM;
+        return static_cast<EventType>(rand.getInt(MOVE_NORTH, MOVE_NORTHWEST));
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef RLNS_AUTOPILOT_HPP
+#define RLNS_AUTOPILOT_HPP
+
+#include <string>
+
+#include <stdint.h>
+
+#include "EventHandler.hpp"
+#include "Random.hpp"
+#include "Types.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : Autopilot
+        Description : Plays instead of the player, for running without a window.
+                      It either presses the keys of a script in turn, over and
+                      over, or walks at random and now and then picks up what it
+                      stands on.  Script keys become events as the EventHandler
+                      would make them; the ones that would wait on the keyboard
+                      (the command prompt, the inventory and saving) are skipped.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class Autopilot
+    {
+        // Member Variables
+        private:
+            static const int PICK_UP_ODDS = 16; // one event in this many is a pick up
+
+            EventHandler handler;
+            std::string script; // empty for a random walk
+            size_t next;
+            Random rand;
+
+        // Member Functions
+        public:
+            explicit Autopilot(const uint32_t);
+            explicit Autopilot(const std::string&);
+
+            EventType nextEvent();
+    };
+}
+
+#endif
@@ -0,0 +1,174 @@
+#include "BSPTree.hpp"
+#include "Area.hpp"
+#include "Pool.hpp"
+#include "Tileset.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Function    : BSPTree::BSPTree
+        Description : Constructor for the BSPTree class.  The tree starts out as a
+                      single leaf covering the given rectangle.
+        Inputs      : topleft corner, width and height of the root node
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    BSPTree::BSPTree(const int x, const int y, const int w, const int h)
+    {
+        nodes.push_back(BSPNode(x, y, w, h, 0));
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : BSPTree::splitNode
+        Description : Splits a leaf in two, appending both children to the node
+                      array.  A node too small to hold two children of the minimum
+                      size is left alone.  Nodes that are too wide or too tall are
+                      always cut across their long side; otherwise the orientation
+                      is random.
+        Inputs      : node index, random number generator, minimum node width and
+                      height, maximum width/height and height/width ratios
+        Outputs     : None
+        Return      : bool (true if the node was split)
+    --------------------------------------------------------------------------------*/
+    bool BSPTree::splitNode(const size_t i, Random& rand, const int minHSize,
+                            const int minVSize, const float maxHRatio, const float maxVRatio)
+    {
+        // copy the node, since adding its children may move the array
+        const BSPNode node = nodes[i];
+
+        if(node.w < 2*minHSize && node.h < 2*minVSize) return false;
+
+        bool horizontal;
+        if(node.h < 2*minVSize || node.w > node.h*maxHRatio)
+            horizontal = false;
+        else if(node.w < 2*minHSize || node.h > node.w*maxVRatio)
+            horizontal = true;
+        else
+            horizontal = rand.getInt(0,1) == 0;
+
+        int position;
+        int level = node.level+1;
+        if(horizontal)
+        {
+            position = rand.getInt(node.y+minVSize, node.y+node.h-minVSize);
+            nodes.push_back(BSPNode(node.x, node.y, node.w, position-node.y, level));
+            nodes.push_back(BSPNode(node.x, position, node.w, node.y+node.h-position, level));
+        }
+        else
+        {
+            position = rand.getInt(node.x+minHSize, node.x+node.w-minHSize);
+            nodes.push_back(BSPNode(node.x, node.y, position-node.x, node.h, level));
+            nodes.push_back(BSPNode(position, node.y, node.x+node.w-position, node.h, level));
+        }
+
+        nodes[i].position = position;
+        nodes[i].horizontal = horizontal;
+        nodes[i].left = nodes.size()-2;
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : BSPTree::splitRecursive
+        Description : Splits the tree one level at a time, up to the given number of
+                      levels.  Any previous split is discarded first.  Since every
+                      level is finished before the next begins, the node array ends
+                      up in level order.
+        Inputs      : random number generator, number of levels, minimum node width
+                      and height, maximum width/height and height/width ratios
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void BSPTree::splitRecursive(Random& rand, const int recurseLevel, const int minHSize,
+                                 const int minVSize, const float maxHRatio, const float maxVRatio)
+    {
+        nodes.erase(nodes.begin()+1, nodes.end());
+        nodes.front().left = -1;
+
+        size_t levelBegin = 0;
+        for(int level=0; level<recurseLevel; ++level)
+        {
+            size_t levelEnd = nodes.size();
+            for(size_t i=levelBegin; i<levelEnd; ++i)
+            {
+                splitNode(i, rand, minHSize, minVSize, maxHRatio, maxVRatio);
+            }
+
+            // nothing left that can be split
+            if(nodes.size() == levelEnd) break;
+            levelBegin = levelEnd;
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : BSPTree::splitRecursive
+        Description : Splits the tree using the BSP parameters of a tileset.
+        Inputs      : random number generator, tileset
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void BSPTree::splitRecursive(Random& rand, const Tileset& tileset)
+    {
+        splitRecursive(rand, tileset.getRecurseLevel(), tileset.getMinHSize(),
+                       tileset.getMinVSize(), tileset.getMaxHRatio(), tileset.getMaxVRatio());
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : BSPTree::splitRecursive
+        Description : Splits the tree using the BSP parameters of a tileset and a
+                      fresh random number generator, so that the same seed always
+                      gives the same layout.
+        Inputs      : seed, tileset
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void BSPTree::splitRecursive(const unsigned int seed, const Tileset& tileset)
+    {
+        Random rand(seed);
+        splitRecursive(rand, tileset);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : BSPTree::getLeaves
+        Description : Fills the given vector with the leaves of the tree, in the same
+                      order forEachLeaf() visits them.  The pointers stay valid until
+                      the tree is split again.
+        Inputs      : vector to fill
+        Outputs     : leaf nodes
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void BSPTree::getLeaves(vector<const BSPNode*>& leaves) const
+    {
+        forEachLeaf([&leaves](const BSPNode& node) { leaves.push_back(&node); });
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : BSPTree::getLeafAreas
+        Description : Fills the given vector with one Area per leaf, covering the
+                      leaf's rectangle.
+        Inputs      : vector to fill
+        Outputs     : leaf Areas
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void BSPTree::getLeafAreas(vector<AreaPtr>& areas) const
+    {
+        forEachLeaf([&areas](const BSPNode& node)
+        {
+            areas.push_back(allocatePooled<Area>(Arena::global(), "Area", Point(node.x, node.y),
+                                                 Point(node.x+node.w-1, node.y+node.h-1)));
+        });
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef RLNS_BSPTREE_HPP
+#define RLNS_BSPTREE_HPP
+
+#include <vector>
+
+#include "Random.hpp"
+#include "Types.hpp"
+
+#include "libtcod.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : BSPNode
+        Description : One rectangle of a BSPTree.  Split nodes keep the index of
+                      their first child; the second child always follows it.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    struct BSPNode
+    {
+        int x, y, w, h;     // topleft corner and dimensions
+        int position;       // coordinate of the split line, if split
+        bool horizontal;    // orientation of the split line, if split
+        int level;          // depth in the tree, the root is level 0
+        int left;           // index of the first child, -1 for leaves
+
+        BSPNode(const int nx, const int ny, const int nw, const int nh, const int lvl)
+        : x(nx), y(ny), w(nw), h(nh), position(0), horizontal(false), level(lvl), left(-1) {}
+
+        bool isLeaf() const { return left < 0; }
+        int right() const { return left+1; }
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : BSPTree
+        Description : Binary space partition of a rectangle, used by the map builders
+                      to lay out areas.  Nodes are stored in a single array in level
+                      order, with both children of a node stored next to each other,
+                      so traversal is a linear walk instead of pointer chasing.  The
+                      split rules follow libtcod's TCODBsp.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class BSPTree
+    {
+        // Member Variables
+        private:
+            std::vector<BSPNode> nodes;
+
+        // Member Functions
+        private:
+            bool splitNode(const size_t, Random&, const int, const int,
+                           const float, const float);
+
+        public:
+            BSPTree(const int, const int, const int, const int);
+
+            void splitRecursive(Random&, const int, const int, const int,
+                                const float, const float);
+            void splitRecursive(Random&, const Tileset&);
+            void splitRecursive(const unsigned int, const Tileset&);
+
+            size_t size() const
+            { return nodes.size(); }
+            const BSPNode& getRoot() const
+            { return nodes.front(); }
+            const BSPNode& at(const size_t i) const
+            { return nodes.at(i); }
+
+            void getLeaves(std::vector<const BSPNode*>&) const;
+            void getLeafAreas(std::vector<AreaPtr>&) const;
+
+            // Calls f on every node in level order, root first
+            template<typename Function>
+            void forEachNode(Function f) const
+            {
+                for(size_t i=0; i<nodes.size(); ++i) f(nodes[i]);
+            }
+
+            // Calls f on every leaf in inverted level order, deepest first
+            template<typename Function>
+            void forEachLeaf(Function f) const
+            {
+                for(size_t i=nodes.size(); i-->0;)
+                {
+                    if(nodes[i].isLeaf()) f(nodes[i]);
+                }
+            }
+    };
+}
+
+#endif
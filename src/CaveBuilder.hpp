@@ -2,59 +2,178 @@
 #define RLNS_CAVEBUILDER_HPP
 
 #include <iostream>
+#include <vector>
 
+#include "BSPTree.hpp"
 #include "MapBuilder.hpp"
+#include "PhasedBuilder.hpp"
 #include "Point.hpp"
+#include "Random.hpp"
 #include "Tile.hpp"
+#include "Vault.hpp"
 
 namespace rlns
 {
+    // Non-member Functions
+
+    bool isOpenArea(const MapPtr, const BSPNode&);
+    void randomizeFloorTiles(const MapPtr, Random&);
+
+
+
     /*--------------------------------------------------------------------------------
-        Class       : CaveBuilder
-        Description : Builds the Cave tileset map.
-        Parents     : MapBuilder
+        Class       : CellularCarver
+        Description : Carving policy that randomly fills the map with floor and wall
+                      tiles and then refines it with a cellular automaton: a tile
+                      becomes a wall if it was a wall and SurviveLimit or more of its
+                      eight neighbors were walls, or if it was not a wall and
+                      BirthLimit or more were.  Each BSP leaf with enough open tiles
+                      becomes an Area.
+
+                      The automaton runs on a flat copy of the bottom layer, laid out
+                      column by column like the map, and is written back once at the
+                      end.  Cells are updated in place in the same order as before, so
+                      a given seed produces the same cave.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    template<int Iterations, int SurviveLimit, int BirthLimit>
+    struct CellularCarver
+    {
+        template<class Builder>
+        static void run(Builder& b)
+        {
+            const MapPtr map = b.map;
+            int width = map->getWidth();
+            int height = map->getHeight();
+            int wallID = map->tileset->getWallTileID();
+            int floorID = map->tileset->getFloorTileID();
+
+            std::vector<int> cells(width*height);
+            for(int x=0; x<width; ++x)
+            {
+                for(int y=0; y<height; ++y)
+                {
+                    if(b.rand.getInt(0,1) == 1)
+                        cells[x*height+y] = floorID;
+                    else
+                        cells[x*height+y] = map->bottomMostAt(x,y);
+                }
+            }
+
+            for(int i=0; i<Iterations; ++i)
+            {
+                for(int x=1; x<width-1; ++x)
+                {
+                    for(int y=1; y<height-1; ++y)
+                    {
+                        int* c = &cells[x*height+y];
+                        int count = (c[-1] == wallID)        + (c[height-1] == wallID)
+                                  + (c[height] == wallID)    + (c[height+1] == wallID)
+                                  + (c[1] == wallID)         + (c[-height+1] == wallID)
+                                  + (c[-height] == wallID)   + (c[-height-1] == wallID);
+
+                        if((*c == wallID && count >= SurviveLimit)
+                        || (*c != wallID && count >= BirthLimit))
+                        {
+                            *c = wallID;
+                        }
+                        else
+                        {
+                            *c = floorID;
+                        }
+                    }
+                }
+            }
+
+            for(int x=0; x<width; ++x)
+            {
+                for(int y=0; y<height; ++y)
+                {
+                    if(map->bottomMostAt(x,y) != cells[x*height+y])
+                        map->setBottomMostAt(x,y, cells[x*height+y]);
+                }
+            }
+
+            // add Areas
+            b.bsp->forEachLeaf([&b](const BSPNode& node)
+            {
+                if(isOpenArea(b.map, node))
+                {
+                    b.addArea(AreaPtr(new Area(Point(node.x, node.y),
+                                               Point(node.w+node.x-1, node.h+node.y-1))));
+                }
+            });
+        }
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : TunnelConnector
+        Description : Connection policy that makes sure each area is reachable from
+                      the one before it, digging a curvy tunnel where it is not.
+        Parents     : None
         Children    : None
         Friends     : None
     --------------------------------------------------------------------------------*/
-    class CaveBuilder: public MapBuilder
+    struct TunnelConnector
     {
-        // Member Variables
-        private:
-            /*------------------------------------------------------------------------
-                Class       : CaveCallback
-                Description : This class is passed to the libtcod BSP traversal 
-                              functions, where its visitNode function will be called
-                              on each node in that tree.
-                Parents     : TCODBspCallback
-                Children    : None
-                Friends     : None
-            ------------------------------------------------------------------------*/
-            class CaveCallback: public ITCODBspCallback
+        template<class Builder>
+        static void run(Builder& b)
+        {
+            for(size_t i=1; i<b.areas.size(); ++i)
             {
-                public:
-                    bool visitNode(TCODBsp*, void*);
-            };
-
-
-        // Member Functions
-        private:
-            void ensureStairsAreReachable();
-            void fillRandomly();
-            bool isOpenArea(const TCODBsp&);
-            void randomizeFloorTiles();
-            void replaceBorderWalls();
-
-        protected:
-            virtual void buildBSPTree();
-            virtual void constructAreas();
-            virtual void connectAreas();
-            virtual void addLights() {}
-            virtual void finishMap();
-
-        public:
-            CaveBuilder(const MapPtr m)
-            : MapBuilder(m) {}
+                Point origin = b.areas[i-1]->getRandomOpenPoint(b.rand);
+                Point dest = b.areas[i]->getRandomOpenPoint(b.rand);
+
+                if(!isReachable(b.map, origin, dest))
+                {
+                    std::vector<Point> path;
+                    getCurvyPathBetweenPoints(&path, b.map, &b.rand, origin, dest);
+                    makePath(b.map, path, b.map->tileset->getFloorTileID());
+                }
+            }
+        }
     };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : CaveFinisher
+        Description : Finishing policy that places the stairs, makes sure they are
+                      connected, seals the map border and varies the floor tiles.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    struct CaveFinisher
+    {
+        template<class Builder>
+        static void run(Builder& b)
+        {
+            b.placeStairs();
+            ensureStairsAreReachable(b.map, b.rand);
+            replaceBorderWalls(b.map);
+            randomizeFloorTiles(b.map, b.rand);
+        }
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : CaveBuilder
+        Description : Builds the Cave tileset map, using the 4-5 cellular automaton
+                      rule for five iterations, with up to two open vaults.
+        Parents     : PhasedBuilder
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    typedef PhasedBuilder< BSPPartition,
+                           VaultCarver<CellularCarver<5, 4, 5>, 2>,
+                           TunnelConnector,
+                           CaveFinisher > CaveBuilder;
 }
 
 #endif
@@ -0,0 +1,503 @@
+#include "DataCache.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Function    : CacheReader::getCount
+        Description : Reads the number of entries that follow.  Every entry takes at
+                      least a byte, so a count larger than what is left of the
+                      buffer means the cache is damaged.
+        Inputs      : None
+        Outputs     : throws runtime_error if the count can't be right
+        Return      : uint32_t
+    --------------------------------------------------------------------------------*/
+    uint32_t CacheReader::getCount()
+    {
+        uint32_t n = get<uint32_t>();
+        if(static_cast<size_t>(end - pos) < n)
+            throw runtime_error("data cache is damaged");
+        return n;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : CacheReader::getString
+        Description : Reads a length-prefixed string.
+        Inputs      : None
+        Outputs     : throws runtime_error if the cache is truncated
+        Return      : string
+    --------------------------------------------------------------------------------*/
+    string CacheReader::getString()
+    {
+        uint32_t n = get<uint32_t>();
+        if(static_cast<size_t>(end - pos) < n)
+            throw runtime_error("data cache is truncated");
+        string s(pos, n);
+        pos += n;
+        return s;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : CacheReader::getColor
+        Description : Reads a color as three bytes.
+        Inputs      : None
+        Outputs     : throws runtime_error if the cache is truncated
+        Return      : TCODColor
+    --------------------------------------------------------------------------------*/
+    TCODColor CacheReader::getColor()
+    {
+        uint8_t r = get<uint8_t>();
+        uint8_t g = get<uint8_t>();
+        uint8_t b = get<uint8_t>();
+        return TCODColor(r, g, b);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : CacheWriter::putString
+        Description : Writes a length-prefixed string.
+        Inputs      : string
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void CacheWriter::putString(const string& s)
+    {
+        put<uint32_t>(s.size());
+        buffer.insert(buffer.end(), s.begin(), s.end());
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : CacheWriter::putColor
+        Description : Writes a color as three bytes.
+        Inputs      : color
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void CacheWriter::putColor(const TCODColor& c)
+    {
+        put<uint8_t>(c.r);
+        put<uint8_t>(c.g);
+        put<uint8_t>(c.b);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : CacheWriter::saveToFile
+        Description : Writes the cache to a temporary file and moves it into place,
+                      so that an interrupted write never leaves a broken cache.
+        Inputs      : file name
+        Outputs     : None
+        Return      : bool (whether the cache was written)
+    --------------------------------------------------------------------------------*/
+    bool CacheWriter::saveToFile(const string& name) const
+    {
+        string temp = name + ".tmp";
+        FILE* file = fopen(temp.c_str(), "wb");
+        if(file == NULL) return false;
+
+        bool ok = buffer.empty() || fwrite(&buffer[0], 1, buffer.size(), file) == buffer.size();
+        ok = (fclose(file) == 0) && ok;
+
+        remove(name.c_str()); // rename doesn't replace files on Windows
+        if(!ok || rename(temp.c_str(), name.c_str()) != 0)
+        {
+            remove(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : DataCache::hashFile
+        Description : Computes the 64 bit FNV-1a hash of a file's contents.
+        Inputs      : file name
+        Outputs     : None
+        Return      : uint64_t
+    --------------------------------------------------------------------------------*/
+    uint64_t DataCache::hashFile(const string& name)
+    {
+        MappedFile file(name);
+        uint64_t hash = 14695981039346656037ULL;
+        for(size_t i=0; i<file.size(); ++i)
+        {
+            hash ^= static_cast<unsigned char>(file.begin()[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : DataCache::stampFile
+        Description : Fills in the size and modification time of a source file, and
+                      its hash if asked to.
+        Inputs      : file name, stamp to fill in, whether to hash the contents
+        Outputs     : None
+        Return      : bool (whether the file exists)
+    --------------------------------------------------------------------------------*/
+    bool DataCache::stampFile(const string& name, SourceStamp& stamp, const bool withHash)
+    {
+        struct stat info;
+        if(stat(name.c_str(), &info) != 0) return false;
+
+        stamp.path = name;
+        stamp.size = info.st_size;
+        stamp.modified = info.st_mtime;
+        stamp.hash = withHash ? hashFile(name) : 0;
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : DataCache::load
+        Description : Loads the Tile, Tileset and Vault lists from the cache if it
+                      is up to date with every source file.  The cached size and
+                      modification time are checked first; only if the time has
+                      changed is the source hashed.
+        Inputs      : None
+        Outputs     : None
+        Return      : bool (whether the lists were loaded)
+    --------------------------------------------------------------------------------*/
+    bool DataCache::load() const
+    {
+        MappedFile file(filename);
+        if(!file.isOpen()) return false;
+
+        try
+        {
+            CacheReader reader(file.begin(), file.size());
+            if(reader.get<uint32_t>() != MAGIC || reader.get<uint32_t>() != VERSION)
+                return false;
+
+            uint32_t numSources = reader.get<uint32_t>();
+            if(numSources != sources.size()) return false;
+
+            for(uint32_t i=0; i<numSources; ++i)
+            {
+                SourceStamp cached;
+                cached.path = reader.getString();
+                cached.size = reader.get<uint64_t>();
+                cached.modified = reader.get<int64_t>();
+                cached.hash = reader.get<uint64_t>();
+
+                SourceStamp current;
+                if(cached.path != sources[i] || !stampFile(sources[i], current, false))
+                    return false;
+                if(current.size != cached.size)
+                    return false;
+                if(current.modified != cached.modified && hashFile(sources[i]) != cached.hash)
+                    return false;
+            }
+
+            loadTiles(reader);
+            loadTilesets(reader);
+            loadVaults(reader);
+        }
+        catch(runtime_error& e)
+        {
+            cerr << "Ignoring data cache: " << e.what() << endl;
+            Tile::list.clear();
+            Tileset::list.clear();
+            Vault::list.clear();
+            return false;
+        }
+
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : DataCache::save
+        Description : Writes the Tile, Tileset and Vault lists to the cache, along
+                      with the stamps of the source files they were parsed from.
+        Inputs      : None
+        Outputs     : None
+        Return      : bool (whether the cache was written)
+    --------------------------------------------------------------------------------*/
+    bool DataCache::save() const
+    {
+        CacheWriter writer;
+        writer.put<uint32_t>(MAGIC);
+        writer.put<uint32_t>(VERSION);
+
+        writer.put<uint32_t>(sources.size());
+        for(size_t i=0; i<sources.size(); ++i)
+        {
+            SourceStamp stamp;
+            if(!stampFile(sources[i], stamp, true)) return false;
+
+            writer.putString(stamp.path);
+            writer.put<uint64_t>(stamp.size);
+            writer.put<int64_t>(stamp.modified);
+            writer.put<uint64_t>(stamp.hash);
+        }
+
+        saveTiles(writer);
+        saveTilesets(writer);
+        saveVaults(writer);
+
+        return writer.saveToFile(filename);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : DataCache::saveTiles
+        Description : Writes every entry of the Tile list.  Tiles with several
+                      characters have one entry per character.
+        Inputs      : cache writer
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void DataCache::saveTiles(CacheWriter& writer)
+    {
+        writer.put<uint32_t>(Tile::list.size());
+
+        multimap<int, TilePtr>::const_iterator it, end;
+        end = Tile::list.end();
+        for(it = Tile::list.begin(); it != end; ++it)
+        {
+            const Tile& tile = *it->second;
+            writer.put<int32_t>(it->first);
+            writer.put<int32_t>(tile.getChar());
+            writer.put<int32_t>(tile.getNumChars());
+            writer.putColor(tile.getFgColor());
+            writer.putColor(tile.getBgColor());
+            writer.putString(tile.shortDescription());
+            writer.putString(tile.longDescription());
+            writer.putString(tile.getLight());
+
+            for(int a=0; a<NUM_TILE_ACTIONS; ++a)
+            {
+                writer.put<int32_t>(tile.getAction(static_cast<TileActionType>(a)));
+            }
+
+            uint32_t flags = (tile.blocksLight()           << BLOCKS_LIGHT)
+                           | (tile.blocksWalking()         << BLOCKS_WALK)
+                           | (tile.isDirectionallyLinked() << DIRECTIONALLY_LINKED)
+                           | (tile.hasMultipleChars()      << MULTIPLE_CHARS)
+                           | (tile.isNotable()             << NOTABLE);
+            writer.put<uint32_t>(flags);
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : DataCache::loadTiles
+        Description : Reads back the Tile list written by saveTiles().
+        Inputs      : cache reader
+        Outputs     : throws runtime_error if the cache is truncated
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void DataCache::loadTiles(CacheReader& reader)
+    {
+        Tile::list.clear();
+
+        uint32_t count = reader.getCount();
+        for(uint32_t i=0; i<count; ++i)
+        {
+            int id = reader.get<int32_t>();
+            int ch = reader.get<int32_t>();
+            int numChars = reader.get<int32_t>();
+            TCODColor fg = reader.getColor();
+            TCODColor bg = reader.getColor();
+            string shortdesc = reader.getString();
+            string longdesc = reader.getString();
+            string light = reader.getString();
+
+            array<int, NUM_TILE_ACTIONS> actions;
+            for(int a=0; a<NUM_TILE_ACTIONS; ++a)
+            {
+                actions[a] = reader.get<int32_t>();
+            }
+
+            uint32_t bits = reader.get<uint32_t>();
+            array<bool, NUM_TILE_FLAGS> flags;
+            for(int f=0; f<NUM_TILE_FLAGS; ++f)
+            {
+                flags[f] = (bits >> f) & 1;
+            }
+
+            TilePtr tile(new Tile(ch, numChars, fg, bg, shortdesc, longdesc, light, actions, flags));
+            Tile::list.insert(pair<int, TilePtr>(id, tile));
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : DataCache::saveTilesets
+        Description : Writes every entry of the Tileset list.
+        Inputs      : cache writer
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void DataCache::saveTilesets(CacheWriter& writer)
+    {
+        writer.put<uint32_t>(Tileset::list.size());
+        for(size_t i=0; i<Tileset::list.size(); ++i)
+        {
+            const Tileset& t = *Tileset::list[i];
+            writer.putString(t.getName());
+            writer.put<int32_t>(t.getType());
+            writer.put<int32_t>(t.getFloorTileID());
+            writer.put<int32_t>(t.getWallTileID());
+            writer.put<int32_t>(t.getFillerTileID());
+            writer.put<int32_t>(t.getUpStairTileID());
+            writer.put<int32_t>(t.getDownStairTileID());
+            writer.put<int32_t>(t.getN_S_DoorID());
+            writer.put<int32_t>(t.getE_W_DoorID());
+            writer.putColor(t.getAmbientLight());
+            writer.put<int32_t>(t.getMapWidth());
+            writer.put<int32_t>(t.getMapHeight());
+            writer.put<int32_t>(t.getRecurseLevel());
+            writer.put<int32_t>(t.getMinHSize());
+            writer.put<int32_t>(t.getMinVSize());
+            writer.put<float>(t.getMaxHRatio());
+            writer.put<float>(t.getMaxVRatio());
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : DataCache::loadTilesets
+        Description : Reads back the Tileset list written by saveTilesets().
+        Inputs      : cache reader
+        Outputs     : throws runtime_error if the cache is truncated
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void DataCache::loadTilesets(CacheReader& reader)
+    {
+        Tileset::list.clear();
+
+        uint32_t count = reader.getCount();
+        for(uint32_t i=0; i<count; ++i)
+        {
+            string name = reader.getString();
+
+            temp_tileset temp;
+            temp.n = name.c_str();
+            temp.type = static_cast<MapType>(reader.get<int32_t>());
+            temp.ft = reader.get<int32_t>();
+            temp.wt = reader.get<int32_t>();
+            temp.flt = reader.get<int32_t>();
+            temp.us = reader.get<int32_t>();
+            temp.ds = reader.get<int32_t>();
+            temp.nsd = reader.get<int32_t>();
+            temp.ewd = reader.get<int32_t>();
+            temp.al = reader.getColor();
+            temp.mw = reader.get<int32_t>();
+            temp.mh = reader.get<int32_t>();
+            temp.rl = reader.get<int32_t>();
+            temp.mhs = reader.get<int32_t>();
+            temp.mvs = reader.get<int32_t>();
+            temp.mhr = reader.get<float>();
+            temp.mvr = reader.get<float>();
+
+            Tileset::list.push_back(TilesetPtr(new Tileset(temp)));
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : DataCache::saveVaults
+        Description : Writes every entry of the Vault list.
+        Inputs      : cache writer
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void DataCache::saveVaults(CacheWriter& writer)
+    {
+        writer.put<uint32_t>(Vault::list.size());
+        for(size_t i=0; i<Vault::list.size(); ++i)
+        {
+            const Vault& v = *Vault::list[i];
+            writer.putString(v.getName());
+            writer.put<uint8_t>(v.isOpen());
+
+            const vector<string>& layout = v.getLayout();
+            writer.put<uint32_t>(layout.size());
+            for(size_t r=0; r<layout.size(); ++r)
+            {
+                writer.putString(layout[r]);
+            }
+
+            const vector<string>& tilesets = v.getTilesets();
+            writer.put<uint32_t>(tilesets.size());
+            for(size_t t=0; t<tilesets.size(); ++t)
+            {
+                writer.putString(tilesets[t]);
+            }
+
+            const map<char, int>& legend = v.getLegend();
+            writer.put<uint32_t>(legend.size());
+            map<char, int>::const_iterator it, end;
+            end = legend.end();
+            for(it = legend.begin(); it != end; ++it)
+            {
+                writer.put<char>(it->first);
+                writer.put<int32_t>(it->second);
+            }
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : DataCache::loadVaults
+        Description : Reads back the Vault list written by saveVaults().
+        Inputs      : cache reader
+        Outputs     : throws runtime_error if the cache is truncated
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void DataCache::loadVaults(CacheReader& reader)
+    {
+        Vault::list.clear();
+
+        uint32_t count = reader.getCount();
+        for(uint32_t i=0; i<count; ++i)
+        {
+            string name = reader.getString();
+            bool open = reader.get<uint8_t>() != 0;
+
+            vector<string> layout(reader.getCount());
+            for(size_t r=0; r<layout.size(); ++r)
+            {
+                layout[r] = reader.getString();
+            }
+
+            vector<string> tilesets(reader.getCount());
+            for(size_t t=0; t<tilesets.size(); ++t)
+            {
+                tilesets[t] = reader.getString();
+            }
+
+            map<char, int> legend;
+            uint32_t numEntries = reader.getCount();
+            for(uint32_t e=0; e<numEntries; ++e)
+            {
+                char c = reader.get<char>();
+                legend[c] = reader.get<int32_t>();
+            }
+
+            Vault::list.push_back(VaultPtr(new Vault(name, layout, tilesets, legend, open)));
+        }
+    }
+}
@@ -0,0 +1,150 @@
+#ifndef RLNS_DATACACHE_HPP
+#define RLNS_DATACACHE_HPP
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <sys/stat.h>
+
+#include "MappedFile.hpp"
+#include "Tile.hpp"
+#include "Tileset.hpp"
+#include "Types.hpp"
+#include "Vault.hpp"
+
+#include "libtcod.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : CacheReader
+        Description : Reads the fixed-size fields and strings of the data cache in
+                      order, checking each read against the end of the buffer.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class CacheReader
+    {
+        // Member Variables
+        private:
+            const char* pos;
+            const char* end;
+
+        // Member Functions
+        public:
+            CacheReader(const char* b, const size_t n): pos(b), end(b+n) {}
+
+            template<typename T>
+            T get()
+            {
+                if(static_cast<size_t>(end - pos) < sizeof(T))
+                    throw std::runtime_error("data cache is truncated");
+                T value;
+                memcpy(&value, pos, sizeof(T));
+                pos += sizeof(T);
+                return value;
+            }
+
+            uint32_t getCount();
+            std::string getString();
+            TCODColor getColor();
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : CacheWriter
+        Description : Builds the data cache in memory, in the order CacheReader
+                      reads it back.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class CacheWriter
+    {
+        // Member Variables
+        private:
+            std::vector<char> buffer;
+
+        // Member Functions
+        public:
+            template<typename T>
+            void put(const T value)
+            {
+                const char* bytes = reinterpret_cast<const char*>(&value);
+                buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+            }
+
+            void putString(const std::string&);
+            void putColor(const TCODColor&);
+
+            bool saveToFile(const std::string&) const;
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : DataCache
+        Description : Binary cache of the parsed datafiles, so that an unchanged set
+                      of datafiles is loaded without running the text parsers.  The
+                      cache records the size, modification time and hash of each
+                      source file; if any of them changed, or the cache was written
+                      by a different format version, load() fails and the caller
+                      parses the text files and calls save().  A source whose
+                      modification time changed but whose contents did not still
+                      counts as unchanged.
+
+                      Covers the Tile, Tileset and Vault lists.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class DataCache
+    {
+        // Static Variables
+        public:
+            static const uint32_t MAGIC = 0x524C4E44; // "RLND"
+            static const uint32_t VERSION = 1;
+
+        // Member Variables
+        private:
+            struct SourceStamp
+            {
+                std::string path;
+                uint64_t size;
+                int64_t modified;
+                uint64_t hash;
+            };
+
+            std::string filename;
+            std::vector<std::string> sources;
+
+        // Member Functions
+        private:
+            static bool stampFile(const std::string&, SourceStamp&, const bool);
+            static uint64_t hashFile(const std::string&);
+
+            static void loadTiles(CacheReader&);
+            static void loadTilesets(CacheReader&);
+            static void loadVaults(CacheReader&);
+            static void saveTiles(CacheWriter&);
+            static void saveTilesets(CacheWriter&);
+            static void saveVaults(CacheWriter&);
+
+        public:
+            DataCache(const std::string& f): filename(f) {}
+
+            void addSource(const std::string& s) { sources.push_back(s); }
+
+            bool load() const;
+            bool save() const;
+    };
+}
+
+#endif
@@ -0,0 +1,170 @@
+#include "DatafileWatcher.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Function    : DatafileWatcher::DatafileWatcher
+        Description : Opens an inotify instance if the platform has one.
+        Inputs      : None
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    DatafileWatcher::DatafileWatcher()
+    : inotify(-1)
+    {
+    #ifdef __linux__
+        inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    #endif
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : DatafileWatcher::~DatafileWatcher
+        Description : Closes the inotify instance, which drops all of its watches.
+        Inputs      : None
+        Outputs     : None
+        Return      : None (destructor)
+    --------------------------------------------------------------------------------*/
+    DatafileWatcher::~DatafileWatcher()
+    {
+    #ifdef __linux__
+        if(inotify >= 0) close(inotify);
+    #endif
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : DatafileWatcher::modifiedTime
+        Description : Returns the modification time of a file.
+        Inputs      : file name
+        Outputs     : None
+        Return      : time_t (0 if the file doesn't exist)
+    --------------------------------------------------------------------------------*/
+    time_t DatafileWatcher::modifiedTime(const string& path)
+    {
+        struct stat info;
+        if(stat(path.c_str(), &info) != 0) return 0;
+        return info.st_mtime;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : DatafileWatcher::addFile
+        Description : Starts watching a file.  The directory is watched rather than
+                      the file itself, since saving through a rename replaces the
+                      file the watch was on.
+        Inputs      : file name, function to call when it changes
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void DatafileWatcher::addFile(const string& path, const function<void()>& reload)
+    {
+        size_t slash = path.find_last_of("/\\");
+        string directory = slash == string::npos ? "." : path.substr(0, slash);
+
+        WatchedFile file = { path, path.substr(slash+1), -1, modifiedTime(path), reload };
+
+    #ifdef __linux__
+        if(inotify >= 0)
+        {
+            map<string, int>::iterator it = directories.find(directory);
+            if(it == directories.end())
+            {
+                int watch = inotify_add_watch(inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+                it = directories.insert(make_pair(directory, watch)).first;
+            }
+            file.watch = it->second;
+        }
+    #endif
+
+        files.push_back(file);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : DatafileWatcher::readEvents
+        Description : Drains the inotify queue, marking every watched file that was
+                      written or renamed into place.
+        Inputs      : flags to mark, one per watched file
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void DatafileWatcher::readEvents(vector<bool>& changed)
+    {
+    #ifdef __linux__
+        alignas(inotify_event) char buffer[4096];
+
+        ssize_t length;
+        while((length = read(inotify, buffer, sizeof(buffer))) > 0)
+        {
+            for(char* p = buffer; p < buffer + length; )
+            {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                if(event->len > 0)
+                {
+                    for(size_t i=0; i<files.size(); ++i)
+                    {
+                        if(files[i].watch == event->wd && files[i].name == event->name)
+                            changed[i] = true;
+                    }
+                }
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+    #else
+        (void) changed;
+    #endif
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : DatafileWatcher::poll
+        Description : Reloads every watched file that changed since the last poll,
+                      and prints how long each reload took.
+        Inputs      : None
+        Outputs     : reload times, or the error if a reload failed
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void DatafileWatcher::poll()
+    {
+        vector<bool> changed(files.size(), false);
+
+        readEvents(changed);
+        for(size_t i=0; i<files.size(); ++i)
+        {
+            if(files[i].watch >= 0) continue;
+
+            time_t modified = modifiedTime(files[i].path);
+            if(modified != files[i].modified)
+            {
+                files[i].modified = modified;
+                changed[i] = true;
+            }
+        }
+
+        for(size_t i=0; i<files.size(); ++i)
+        {
+            if(!changed[i]) continue;
+
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            try
+            {
+                files[i].reload();
+            }
+            catch(exception& e)
+            {
+                cerr << "Couldn't reload " << files[i].path << ": " << e.what() << endl;
+                continue;
+            }
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            cerr << "Reloaded " << files[i].path << " in " << ms << " ms" << endl;
+        }
+    }
+}
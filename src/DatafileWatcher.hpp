@@ -0,0 +1,69 @@
+#ifndef RLNS_DATAFILEWATCHER_HPP
+#define RLNS_DATAFILEWATCHER_HPP
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : DatafileWatcher
+        Description : Watches a few datafiles for changes and calls a reload function
+                      for each one that changed.  poll() never blocks, so it can be
+                      called every frame.  On Linux the watcher uses inotify on the
+                      files' directories, so it catches editors that save by writing
+                      a new file and renaming it over the old one; elsewhere, or if
+                      inotify is unavailable, it compares modification times.
+                      Reloads run in the order the files were added, so later files
+                      can depend on earlier ones (tilesets on tiles, say).
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class DatafileWatcher
+    {
+        // Member Variables
+        private:
+            struct WatchedFile
+            {
+                std::string path;
+                std::string name;           // path without its directory
+                int watch;                  // inotify watch on the directory, or -1
+                time_t modified;
+                std::function<void()> reload;
+            };
+
+            std::vector<WatchedFile> files;
+            std::map<std::string, int> directories; // directory -> inotify watch
+            int inotify;                            // -1 if not using inotify
+
+        // Member Functions
+        private:
+            static time_t modifiedTime(const std::string&);
+            void readEvents(std::vector<bool>&);
+
+            DatafileWatcher(const DatafileWatcher&);
+            DatafileWatcher& operator=(const DatafileWatcher&);
+
+        public:
+            DatafileWatcher();
+            ~DatafileWatcher();
+
+            void addFile(const std::string&, const std::function<void()>&);
+            void poll();
+    };
+}
+
+#endif
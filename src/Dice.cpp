@@ -2,73 +2,45 @@
 
 namespace rlns
 {
-    DieRollerPtr DieRoller::instance;
-
     /*--------------------------------------------------------------------------------
-        Function    : DieRoller::get
-        Description : Public access to the private DieRoller instance, as part of the
-                      Singleton pattern
-        Inputs      : None
+        Function    : clampDie
+        Description : Turns a die size with a modifier added into a die there is:
+                      sizes below D3 or above D30 become those, and a size
+                      between that no die has becomes a D3.
+        Inputs      : size
         Outputs     : None
-        Return      : DieRollerPtr
+        Return      : DieType
     --------------------------------------------------------------------------------*/
-    DieRollerPtr DieRoller::get()
-    {
-        if(instance.get() == 0)
-        {
-            RNGType rng;
-            rng.seed(static_cast<const unsigned int>(time(0)));
-            instance.reset(new DieRoller(rng));
-        }
-        return instance;
-    }
-
-
-
-    DieRoll DieRoller::roll(int die)
+    static DieType clampDie(int die)
     {
         if (die < D3) die = D3;
         else if (die > D30) die = D30;
 
         switch(die)
         {
-            case D3:
-                return DieRoll(D3, d3());        
-            case D4:
-                return DieRoll(D4, d4());        
-            case D5:
-                return DieRoll(D5, d5());        
-            case D6:
-                return DieRoll(D6, d6());        
-            case D7:
-                return DieRoll(D7, d7());        
-            case D8:
-                return DieRoll(D8, d8());        
-            case D10:
-                return DieRoll(D10, d10());        
-            case D12:
-                return DieRoll(D12, d12());        
-            case D14:
-                return DieRoll(D14, d14());        
-            case D16:
-                return DieRoll(D16, d16());        
-            case D20:
-                return DieRoll(D20, d20());        
-            case D24:
-                return DieRoll(D24, d24());        
-            case D30:
-                return DieRoll(D30, d30());        
+            case D3: case D4: case D5: case D6: case D7: case D8: case D10:
+            case D12: case D14: case D16: case D20: case D24: case D30:
+                return static_cast<DieType>(die);
             default:
                 // TODO: put proper error handling here
-                return DieRoll(D3, d3());
+                return D3;
         }
     }
 
 
 
+    /*--------------------------------------------------------------------------------
+        Function    : rollDie
+        Description : Rolls one die, made larger or smaller by the modifier.  Dice
+                      draw from the combat stream.
+        Inputs      : die, modifier
+        Outputs     : None
+        Return      : DieRoll
+    --------------------------------------------------------------------------------*/
     DieRoll rollDie(const DieType die, const int mod)
     {
-        return DieRoller::get()->roll(die + mod);
+        DieType d = clampDie(die + mod);
+        return DieRoll(d, static_cast<int>(Random::stream(STREAM_COMBAT).below(d)) + 1);
     }
 
     int rollDice(const int num, const DieType die)
@@ -81,9 +53,78 @@ namespace rlns
         return sum;
     }
 
+    /*--------------------------------------------------------------------------------
+        Function    : rollDice
+        Description : Rolls the same die many times, as rollDie() would with the
+                      same modifier, into an array.  The rolls are drawn a block
+                      at a time, which is much faster than rolling one by one when
+                      there are many, but they are not the rolls rollDie() would
+                      have given.
+        Inputs      : array, number of rolls, die, modifier
+        Outputs     : the rolls
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void rollDice(int* results, const size_t num, const DieType die, const int mod)
+    {
+        // the draws go straight into the results, which are the same size
+        uint32_t* draws = reinterpret_cast<uint32_t*>(results);
+        Random::stream(STREAM_COMBAT).fillBelow(draws, num, clampDie(die + mod));
+        for(size_t i=0; i<num; ++i)
+        {
+            results[i] = static_cast<int>(draws[i]) + 1;
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : rollDice
+        Description : Rolls the same die many times and marks which rolls are
+                      critical successes and failures.
+        Inputs      : number of rolls, die, modifier
+        Outputs     : the rolls
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void rollDice(DieRolls& rolls, const size_t num, const DieType die, const int mod)
+    {
+        rolls.die = clampDie(die + mod);
+        rolls.results.resize(num);
+        rolls.critSuccess.resize(num);
+        rolls.critFail.resize(num);
+        if(num == 0) return;
+
+        rollDice(&rolls.results[0], num, rolls.die);
+        const int top = rolls.die;
+        for(size_t i=0; i<num; ++i)
+        {
+            rolls.critSuccess[i] = static_cast<uint8_t>(rolls.results[i] == top);
+            rolls.critFail[i] = static_cast<uint8_t>(rolls.results[i] == 1);
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : DieRolls::sum
+        Description : Returns the total of the rolls.
+        Inputs      : None
+        Outputs     : None
+        Return      : long
+    --------------------------------------------------------------------------------*/
+    long DieRolls::sum() const
+    {
+        long total = 0;
+        for(size_t i=0; i<results.size(); ++i)
+        {
+            total += results[i];
+        }
+        return total;
+    }
+
+
+
     int randomInt(const int lower, const int upper)
     {
-        SmallIntDistribution dist(lower, upper);
-        return dist(DieRoller::get()->rngType);
+        return Random::stream(STREAM_COMBAT).getInt(lower, upper);
     }
 }
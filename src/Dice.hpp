@@ -1,19 +1,15 @@
 #ifndef RLNS_DICE_HPP
 #define RLNS_DICE_HPP
 
-#include <iostream>
+#include <vector>
 
-#include "boost/random.hpp"
-#include "boost/shared_ptr.hpp"
+#include <stdint.h>
 
+#include "Random.hpp"
 #include "Types.hpp"
 
 namespace rlns
 {
-    typedef boost::random::mt19937 RNGType;
-    typedef boost::random::uniform_smallint<> SmallIntDistribution;
-    typedef boost::variate_generator<RNGType, SmallIntDistribution> GenType;
-
     enum DieType
     {
         D3 = 3,
@@ -49,55 +45,44 @@ namespace rlns
             DieRoll();
     };
 
-    class DieRoller
+    // Many rolls of one die, with their crit flags kept in arrays of their own
+    class DieRolls
     {
         public:
-            friend DieRoll rollDie(const DieType, const int);
-            friend int randomInt(const int, const int);
+            DieRolls()
+            : die(D3) {}
+
+            size_t size() const { return results.size(); }
+
+            DieType getDie() const { return die; }
+
+            int result(const size_t i) const { return results[i]; }
+
+            bool isCritSuccess(const size_t i) const { return critSuccess[i] != 0; }
 
+            bool isCritFail(const size_t i) const { return critFail[i] != 0; }
+
+            const std::vector<int>& getResults() const { return results; }
+
+            long sum() const;
 
         private:
-            RNGType rngType;
-            DieRoll roll(int);
-            static DieRollerPtr get();
-
-            DieRoller(RNGType rng)
-            : rngType(rng),
-              d3(rng, SmallIntDistribution(1,3)),
-              d4(rng, SmallIntDistribution(1,4)),
-              d5(rng, SmallIntDistribution(1,5)),
-              d6(rng, SmallIntDistribution(1,6)),
-              d7(rng, SmallIntDistribution(1,7)),
-              d8(rng, SmallIntDistribution(1,8)),
-              d10(rng, SmallIntDistribution(1,10)),
-              d12(rng, SmallIntDistribution(1,12)),
-              d14(rng, SmallIntDistribution(1,14)),
-              d16(rng, SmallIntDistribution(1,16)),
-              d20(rng, SmallIntDistribution(1,20)),
-              d24(rng, SmallIntDistribution(1,24)),
-              d30(rng, SmallIntDistribution(1,30)) {}
-
-            static DieRollerPtr instance;
-
-            GenType d3;
-            GenType d4;
-            GenType d5;
-            GenType d6;
-            GenType d7;
-            GenType d8;
-            GenType d10;
-            GenType d12;
-            GenType d14;
-            GenType d16;
-            GenType d20;
-            GenType d24;
-            GenType d30;
+            friend void rollDice(DieRolls&, const size_t, const DieType, const int);
+
+            DieType die;
+            std::vector<int> results;
+            std::vector<uint8_t> critSuccess;
+            std::vector<uint8_t> critFail;
     };
 
     DieRoll rollDie(const DieType, const int mod=0);
 
     int rollDice(const int, const DieType);
 
+    void rollDice(int*, const size_t, const DieType, const int mod=0);
+
+    void rollDice(DieRolls&, const size_t, const DieType, const int mod=0);
+
     int randomInt(const int, const int);
 }
 
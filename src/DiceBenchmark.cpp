@@ -0,0 +1,151 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Dice.hpp"
+#include "Random.hpp"
+
+using namespace std;
+using namespace rlns;
+
+typedef chrono::steady_clock Clock;
+
+/*--------------------------------------------------------------------------------
+    Function    : millisecondsSince
+    Description : Returns the time elapsed since the given point.
+    Inputs      : start time
+    Outputs     : None
+    Return      : double (milliseconds)
+--------------------------------------------------------------------------------*/
+static double millisecondsSince(const Clock::time_point start)
+{
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : isFair
+    Description : Checks that every face came up about as often as it should:
+                  within five standard deviations of the expected count, which
+                  a fair die misses about once in two million faces.
+    Inputs      : rolls, die
+    Outputs     : None
+    Return      : bool
+--------------------------------------------------------------------------------*/
+static bool isFair(const vector<int>& rolls, const int die)
+{
+    vector<size_t> counts(die + 1, 0);
+    for(size_t i=0; i<rolls.size(); ++i)
+    {
+        if(rolls[i] < 1 || rolls[i] > die) return false;
+        ++counts[rolls[i]];
+    }
+
+    double expected = static_cast<double>(rolls.size()) / die;
+    double deviation = sqrt(expected * (1.0 - 1.0 / die));
+    for(int face=1; face<=die; ++face)
+    {
+        if(fabs(counts[face] - expected) > 5 * deviation) return false;
+    }
+    return true;
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : printRow
+    Description : Prints one line of the table.
+    Inputs      : name of the path, milliseconds taken, number of rolls, sum
+                  of the rolls, whether they look fair
+    Outputs     : None
+    Return      : void
+--------------------------------------------------------------------------------*/
+static void printRow(const string& name, const double ms, const size_t numRolls, const long sum,
+                     const bool fair)
+{
+    cout << left << setw(10) << name << right << setw(12) << ms
+         << setw(16) << numRolls / ms / 1000.0 << setw(10) << static_cast<double>(sum) / numRolls
+         << setw(8) << (fair ? "yes" : "NO") << endl;
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : main
+    Description : Compares rolling one die at a time through rollDie() with the
+                  batch rollDice() calls, with and without the crit flags, on
+                  the same number of rolls of one die.  Each path's rolls are
+                  checked for fairness and their mean printed, which should be
+                  near (die + 1) / 2.
+    Inputs      : optional number of rolls (default 10000000), die (default 20)
+                  and seed (default 1)
+    Outputs     : a table on stdout
+    Return      : int (0 if every path looks fair)
+--------------------------------------------------------------------------------*/
+int main(int argc, char* argv[])
+{
+    size_t numRolls = (argc > 1) ? strtoul(argv[1], NULL, 10) : 10000000;
+    DieType die = static_cast<DieType>((argc > 2) ? atoi(argv[2]) : D20);
+    uint32_t seed = (argc > 3) ? strtoul(argv[3], NULL, 10) : 1;
+    if(numRolls == 0) numRolls = 1;
+
+    Random::seedStreams(seed);
+
+    // the per-roll path: one call, one draw and one DieRoll per die
+    vector<int> single(numRolls);
+    long singleSum = 0;
+    size_t singleCrits = 0;
+    Clock::time_point start = Clock::now();
+    for(size_t i=0; i<numRolls; ++i)
+    {
+        DieRoll roll = rollDie(die);
+        single[i] = roll.result();
+        singleSum += roll.result();
+        singleCrits += roll.isCritSuccess();
+    }
+    double singleTime = millisecondsSince(start);
+
+    vector<int> batch(numRolls);
+    long batchSum = 0;
+    start = Clock::now();
+    rollDice(&batch[0], numRolls, die);
+    for(size_t i=0; i<numRolls; ++i)
+    {
+        batchSum += batch[i];
+    }
+    double batchTime = millisecondsSince(start);
+
+    // rolled once first so that, like the others, it writes to memory already in use
+    DieRolls flagged;
+    rollDice(flagged, numRolls, die);
+    size_t flaggedCrits = 0;
+    start = Clock::now();
+    rollDice(flagged, numRolls, die);
+    long flaggedSum = flagged.sum();
+    for(size_t i=0; i<numRolls; ++i)
+    {
+        flaggedCrits += flagged.isCritSuccess(i);
+    }
+    double flaggedTime = millisecondsSince(start);
+
+    bool singleFair = isFair(single, flagged.getDie());
+    bool batchFair = isFair(batch, flagged.getDie());
+    bool flaggedFair = isFair(flagged.getResults(), flagged.getDie());
+
+    cout << numRolls << " rolls of a d" << flagged.getDie() << endl;
+    cout << left << setw(10) << "path" << right << setw(12) << "ms"
+         << setw(16) << "million/sec" << setw(10) << "mean" << setw(8) << "fair" << endl;
+    cout << fixed << setprecision(2);
+    printRow("single", singleTime, numRolls, singleSum, singleFair);
+    printRow("batch", batchTime, numRolls, batchSum, batchFair);
+    printRow("flagged", flaggedTime, numRolls, flaggedSum, flaggedFair);
+    cout << "criticals: " << singleCrits << " single, " << flaggedCrits << " flagged" << endl;
+    cout << "batch is " << singleTime / batchTime << "x the single path" << endl;
+
+    return (singleFair && batchFair && flaggedFair) ? 0 : 1;
+}
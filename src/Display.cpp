@@ -27,6 +27,35 @@ namespace rlns
 
 
 
+    /*--------------------------------------------------------------------------------
+        Function    : Display::drawLevelEntities
+        Description : Draws every entity of the level that has a look and a position
+                      and is in view.  The looks are walked in the order they are
+                      stored, each finding its position in constant time.
+        Inputs      : Level object
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Display::drawLevelEntities(const LevelPtr level)
+    {
+        const EntityStore& entities = level->getEntities();
+        Point adjustedCamBR = camBR - Point(1,1);
+
+        for(size_t i=0; i<entities.glyphs.size(); ++i)
+        {
+            const Point* position = entities.positions.find(entities.glyphs.ownerAt(i));
+            if(position == NULL || !position->withinBounds(camTL, adjustedCamBR)) continue;
+
+            const Glyph& glyph = entities.glyphs.at(i);
+            Point relativePosition = *position - camTL;
+            int x = relativePosition.X(), y = relativePosition.Y();
+            TCODColor backgroundColor = _playfield->getCharBackground(x,y);
+            _playfield->putCharEx(x, y, glyph.ch, glyph.fg, backgroundColor);
+        }
+    }
+
+
+
     /*--------------------------------------------------------------------------------
         Function    : Display::drawLevelOccupants
         Description : Draws all of the characters and monsters in the level, including
@@ -81,6 +110,20 @@ namespace rlns
 
 
 
+    /*--------------------------------------------------------------------------------
+        Function    : Display::Display(int)
+        Description : Makes a display with no consoles, for running without a
+                      window.  Messages are still kept, but refresh() draws nothing.
+        Inputs      : number of messages to keep
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    Display::Display(const int logSize)
+    : focalPt(0,0), _playfieldTL(0,0), _partyBarTL(0,0), _consoleTL(0,0),
+      messageTracker(new MessageTracker(logSize)) {}
+
+
+
     /*--------------------------------------------------------------------------------
         Function    : Display::shiftFocalPoint
         Description : Moves the focal point one tile in the given direction
@@ -217,6 +260,7 @@ namespace rlns
         }
 
         drawLevelItems(level);
+        drawLevelEntities(level);
         drawLevelOccupants(level);
     }
 
@@ -321,13 +365,15 @@ namespace rlns
         Function    : Display::refresh
         Description : Calls all of the various console drawing functions and then the
                       Display blit function which puts each console onto the root
-                      console.
+                      console.  A display without consoles draws nothing.
         Inputs      : None
         Outputs     : None
         Return      : void
     --------------------------------------------------------------------------------*/
     void Display::refresh()
     {
+        if(!_playfield) return; // headless
+
         setDisplayValues();
         drawPlayfield();
         //drawPartyBar();
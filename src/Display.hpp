@@ -51,10 +51,12 @@ namespace rlns
         // Member Functions
         private:
             void drawLevelItems(const LevelPtr);
+            void drawLevelEntities(const LevelPtr);
             void drawLevelOccupants(const LevelPtr);
 
         public:
             Display(const InitData&);
+            explicit Display(const int);
 
             void setFocalPoint(const Point& pt) { focalPt = pt; }
             void shiftFocalPoint(const DirectionType);
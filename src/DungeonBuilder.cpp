@@ -1,122 +1,62 @@
 #include "DungeonBuilder.hpp"
+#include "GeneratorRegistry.hpp"
+#include "Pool.hpp"
 
 using namespace std;
 
 namespace rlns
 {
-    /*--------------------------------------------------------------------------------
-        Function    : DungeonBuilder::DungeonCallback::visitNode
-        Description : callback function for the DungeonCallback class.  This function
-                      is called during BSP traversals.
-        Inputs      : TCODBsp pointer, void pointer (for user supplied data)
-        Outputs     : None
-        Return      : bool
-    --------------------------------------------------------------------------------*/
-    bool DungeonBuilder::DungeonCallback::visitNode(TCODBsp* node, void* userData)
-    {
-        if(node->isLeaf())
-        {
-            // convert the void pointer userData to the parent class
-            DungeonBuilder* parent = static_cast<DungeonBuilder*>(userData);
-            parent->buildRoomType(*node);
-        }
-        return true;
-    }
-
-
-
-    /*--------------------------------------------------------------------------------
-        Function    : DungeonBuilder::addLights
-        Description : Places a light in each room.
-        Inputs      : None
-        Outputs     : None
-        Return      : void
-    --------------------------------------------------------------------------------*/
-    void DungeonBuilder::addLights()
-    {/*
-        Point pt;
-
-        size_t numAreas = areas.size();
-        for(size_t i=0; i<numAreas; ++i)
-        {
-            do { pt = areas.at(i)->getRandomPoint(rand); }
-            while(map->at(pt) != map->tileset->getFloorTileID());
-
-            map->addFeature(pt, 500); // adds a brazier
-
-            //LightPtr light(new Light(*Light::findLight("Lantern")));
-            //GameData::get()->getCurrentLevel()->addLight(pt, light);
-        }
-        */
-    }
+    // the Dungeon tileset is built by DungeonBuilder
+    static const bool registered = GeneratorRegistry::registerBuilder(DUNGEON, &makeBuilder<DungeonBuilder>);
 
 
 
     /*--------------------------------------------------------------------------------
-        Function    : DungeonBuilder::buildRoomType
+        Function    : buildDungeonRoom
         Description : Randomly chooses a room creation algorithm to apply to a given
                       BSP node.
-        Inputs      : BSP node
+        Inputs      : tile buffer covering the node, random number generator, BSP
+                      node
         Outputs     : None
-        Return      : void
+        Return      : AreaPtr
     --------------------------------------------------------------------------------*/
-    void DungeonBuilder::buildRoomType(const TCODBsp& node)
+    AreaPtr buildDungeonRoom(TileBuffer& tiles, Random& rand, const BSPNode& node)
     {
         Area newArea;
         switch(rand.getInt(0,3))
         {
             case 0:
-                newArea = squareRoom(map, node, rand, 10);
-                addColumnsToSquareRoom(map, rand, newArea);
+                newArea = squareRoom(tiles, node, rand, 10);
+                addColumnsToSquareRoom(tiles, rand, newArea);
                 break;
             case 1:
-                newArea =  squareHall(map, node);
-                addColumnsToSquareRoom(map, rand, newArea);
+                newArea =  squareHall(tiles, node);
+                addColumnsToSquareRoom(tiles, rand, newArea);
                 break;
             case 2:
-                newArea =  circularHall(map, node);
+                newArea =  circularHall(tiles, node);
                 break;
             case 3:
-                newArea =  crossHall(map, node, rand, 10);
+                newArea =  crossHall(tiles, node, rand, 10);
                 break;
             default:
-                newArea =  squareHall(map, node);
+                newArea =  squareHall(tiles, node);
                 break;
         }
 
-        // add the new Area to the areas vector
-        AreaPtr newAreaPtr(new Area(newArea));
-        areas.push_back(newAreaPtr);
+        return allocatePooled<Area>(Arena::global(), "Area", newArea);
     }
 
 
 
     /*--------------------------------------------------------------------------------
-        Function    : MapBuilder::createRooms
-        Description : iterates through the BSP tree and calls chooseRoom for each
-                      node.  chooseRoom is responsible for choosing which room type
-                      will be constructed in each node and calling the appropriate
-                      function.
-        Inputs      : None
-        Outputs     : None
-        Return      : void
-    --------------------------------------------------------------------------------*/
-    void DungeonBuilder::createRooms()
-    {
-        DungeonCallback c;
-        bsp->traverseInvertedLevelOrder(&c, this);
-    }
-
-
-
-    /*--------------------------------------------------------------------------------
-        Function    : DungeonBuilder::connectPoints
+        Function    : digCorridor
         Description : digs a corridor between two Points on the map
-        Inputs      : two Points
+        Inputs      : map, two Points, whether to dig vertically first
         Outputs     : None
         Return      : void
     --------------------------------------------------------------------------------*/
-    void DungeonBuilder::connectPoints(Point& p1, const Point& p2, bool vertfirst)
+    void digCorridor(const MapPtr map, Point& p1, const Point& p2, const bool vertfirst)
     {
         if(vertfirst)
         {
@@ -165,83 +105,17 @@ namespace rlns
 
 
     /*--------------------------------------------------------------------------------
-        Function    : DungeonBuilder::connectRooms
-        Description : connects two rooms to each other
-        Inputs      : two room objects
-        Outputs     : None
-        Return      : void
-    --------------------------------------------------------------------------------*/
-    void DungeonBuilder::connectRooms(const AreaPtr r1, const AreaPtr r2)
-    {
-        // get a random floor tile in each room
-        Point r1point;
-        Point r2point;
-
-        do { r1point = r1->getRandomPoint(rand); }
-        while(map->bottomMostAt(r1point) != map->tileset->getFloorTileID());
-
-        do { r2point = r2->getRandomPoint(rand); }
-        while(map->bottomMostAt(r2point) != map->tileset->getFloorTileID());
-
-        bool vertfirst = rand.getInt(0,1) != 0;
-        connectPoints(r1point, r2point, vertfirst);
-    }
-
-
-
-    /*--------------------------------------------------------------------------------
-        Function    : DungeonBuilder::finishMap()
-        Description : iterates through every tile in the dungeon and checks each wall
-                      tile it finds to see if it should change to a double-barred wall
-                      character, and each floor tile to see if it should be a door.  
-                      For each tile it finds, this function and its children assemble 
-                      a code that deterimines which tiles around it are not also 
-                      walls.  The code is similar to Unix file permission codes, in 
-                      that the code, in binary, is a series of flags.  The code 
-                      variable is essentially a four-bit binary number where each bit
-                      refers to a cardinal direction.  If the given direction is a 
-                      wall tile, then that bit is 1.  In decimal form, these codes 
-                      form a unique decimal number useful in a switch statement.
-        Inputs      : None
-        Outputs     : None
-        Return      : void
-    --------------------------------------------------------------------------------*/
-    void DungeonBuilder::finishMap()
-    {
-        int width = map->getWidth();
-        int height = map->getHeight();
-
-        for(int x=0; x<width; x++)
-        {
-            for(int y=0; y<height; y++)
-            {
-                if(map->bottomMostAt(x,y) == map->tileset->getFillerTileID())
-                {
-                    setWall(Point(x,y));
-                }
-                else if(map->bottomMostAt(x,y) == map->tileset->getFloorTileID())
-                {
-                    checkForDoor(Point(x,y));
-                }
-            }
-        }
-
-        placeStairs();
-    }
-
-
-
-    /*--------------------------------------------------------------------------------
-        Function    : DungeonBuilder::setWall
+        Function    : setDungeonWall
         Description : Checks if the given coordinate needs a double-barred wall
-                      character or not.
-        Inputs      : point to check
+                      character or not.  The border code flags which tiles around
+                      the point are floor, from North (1) clockwise to NorthWest
+                      (128).  See getBorderCode().
+        Inputs      : map, point to check, border code of surrounding floor tiles
         Outputs     : None
         Return      : void
     --------------------------------------------------------------------------------*/
-    void DungeonBuilder::setWall(const Point& pt)
+    void setDungeonWall(const MapPtr map, const Point& pt, const int code)
     {
-        int code = getBorderCode(map, pt, map->tileset->getFloorTileID());
         switch(code)
         {
             case 1:
@@ -443,26 +317,14 @@ namespace rlns
 
 
     /*--------------------------------------------------------------------------------
-        Function    : DungeonBuilder::checkForDoor
+        Function    : checkForDungeonDoor
         Description : Checks if the given floor tile should have a door in it or not.
-        Inputs      : point to check
+        Inputs      : map, point to check, border code of surrounding wall tiles
         Outputs     : None
         Return      : void
     --------------------------------------------------------------------------------*/
-    void DungeonBuilder::checkForDoor(const Point& pt)
+    void checkForDungeonDoor(const MapPtr map, const Point& pt, const int code)
     {
-        // Create a vector of all the possible wall tile IDs EXCEPT for the first
-        // one, as that is the pillar tile, and doors should not be attached to
-        // pillars.  Since the tiles after the current one won't be finished, the
-        // filler tile should be included as well. There are eleven wall tiles in total.
-        vector<int> tileIDs;
-        tileIDs.push_back(map->tileset->getFillerTileID());
-        for(int i=1; i<12; ++i)
-        {
-            tileIDs.push_back(map->tileset->getWallTileID()+i);
-        }
-
-        int code = getBorderCode(map, pt, tileIDs);
         switch(code)
         {
             case 17:
@@ -499,64 +361,4 @@ namespace rlns
             }
         }
     }
-
-
-
-    /*--------------------------------------------------------------------------------
-        Function    : DungeonBuilder::buildBSPTree
-        Description : Creates and recursively splits the libtcod BSP tree.  The root 
-                      node covers all of the internal tiles of the map.  All of the
-                      edge tiles are not considered, since we must make sure that no 
-                      room opens onto the edge of the map.
-        Inputs      : None
-        Outputs     : None
-        Return      : void
-    --------------------------------------------------------------------------------*/
-    void DungeonBuilder::buildBSPTree()
-    {
-        // topleft corner of the root node
-        int x = 1, y = 1;
-        // bottomright corner of the root node              
-        // 
-        // For some reason, w needs to be set to Width-2, otherwise rooms can run
-        // a tile over the eastern edge of the map. h is fine to be set at Height-1.
-        int w = map->getWidth()-2, h = map->getHeight()-1; 
-        bsp.reset(new TCODBsp(x,y,w,h));
-        bsp->splitRecursive(NULL, 6, 15, 15, 1.5, 1.5);
-    }
-
-
-
-    /*--------------------------------------------------------------------------------
-        Function    : DungeonBuilder::constructAreas
-        Description : Takes the BSP tree made in MapBuilder::buildBSPTree and digs 
-                      rooms in the areas it defined.
-        Inputs      : None
-        Outputs     : None
-        Return      : void
-    --------------------------------------------------------------------------------*/
-    void DungeonBuilder::constructAreas()
-    {
-        createRooms();
-    }
-
-
-
-    /*--------------------------------------------------------------------------------
-        Function    : DungeonBuilder::connectAreas
-        Description : Digs corridors between the rooms built in constructAreas().
-        Inputs      : None
-        Outputs     : None
-        Return      : void
-    --------------------------------------------------------------------------------*/
-    void DungeonBuilder::connectAreas()
-    {
-        vector<AreaPtr>::const_iterator it, end;
-        it = areas.begin() + 1; end = areas.end();
-
-        for(; it!=end; ++it)
-        {
-            connectRooms(*(it-1), *it);
-        }
-    }
 }
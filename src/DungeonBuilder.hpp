@@ -2,65 +2,183 @@
 #define RLNS_DUNGEONBUILDER_HPP
 
 #include <iostream>
+#include <vector>
 
 #include "Area.hpp"
+#include "BSPTree.hpp"
 #include "MapBuilder.hpp"
+#include "PhasedBuilder.hpp"
 #include "Point.hpp"
+#include "Random.hpp"
+#include "Utility.hpp"
+#include "Vault.hpp"
 
 #include "libtcod.hpp"
 
 namespace rlns
 {
+    // Non-member Functions
+
+    AreaPtr buildDungeonRoom(TileBuffer&, Random&, const BSPNode&);
+    void digCorridor(const MapPtr, Point&, const Point&, const bool);
+    void setDungeonWall(const MapPtr, const Point&, const int);
+    void checkForDungeonDoor(const MapPtr, const Point&, const int);
+
+
+
     /*--------------------------------------------------------------------------------
-        Class       : DungeonBuilder
-        Description : Constructs a Dungeon tileset map.  Features large square,
-                      circular, and cross-shaped rooms occasionally filled by pillars.
-                      Rooms are connected by one tile wide corridors.
-        Parents     : MapBuilder
+        Class       : RoomCarver
+        Description : Carving policy that digs a randomly chosen room type into each
+                      leaf of the BSP tree.  Leaves that are no longer solid filler,
+                      because a vault was cut into them, are left alone.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    struct RoomCarver
+    {
+        template<class Builder>
+        static void run(Builder& b)
+        {
+            std::vector<const BSPNode*> leaves;
+            b.bsp->getLeaves(leaves);
+
+            // Leaves never overlap, so the rooms can be dug in parallel, each
+            // into a buffer of its own; the map is not thread safe, so the
+            // buffers are then written to it on this thread in leaf order.
+            // Every room gets its own random number generator, forked up front
+            // so the result does not depend on thread timing.
+            std::vector<Random> forks;
+            std::vector<TileBuffer> buffers;
+            forks.reserve(leaves.size());
+            buffers.reserve(leaves.size());
+            for(size_t i=0; i<leaves.size(); ++i)
+            {
+                const BSPNode& leaf = *leaves[i];
+                forks.push_back(b.rand.fork());
+                buffers.push_back(TileBuffer(*b.map, leaf.x, leaf.y, leaf.w, leaf.h));
+            }
+
+            const SummedAreaTable untouched = fillerTable(*b.map);
+
+            std::vector<AreaPtr> rooms(leaves.size());
+            parallelFor(leaves.size(), [&](const size_t i)
+            {
+                const BSPNode& leaf = *leaves[i];
+                if(!untouched.all(leaf.x, leaf.y, leaf.w, leaf.h)) return;
+
+                rooms[i] = buildDungeonRoom(buffers[i], forks[i], leaf);
+            });
+
+            for(size_t i=0; i<rooms.size(); ++i)
+            {
+                if(!rooms[i]) continue;
+                buffers[i].applyTo(*b.map);
+                b.addArea(rooms[i]);
+            }
+        }
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : CorridorConnector
+        Description : Connection policy that digs a one tile wide corridor between
+                      each room and the one carved before it.
+        Parents     : None
         Children    : None
         Friends     : None
     --------------------------------------------------------------------------------*/
-    class DungeonBuilder: public MapBuilder
+    struct CorridorConnector
     {
-        // Member Variables
-        private:
-            /*------------------------------------------------------------------------
-                Class       : DungeonCallback
-                Description : This class is passed to the libtcod BSP traversal 
-                              functions, where its visitNode function will be called
-                              on each node in that tree.
-                Parents     : TCODBspCallback
-                Children    : None
-                Friends     : None
-            ------------------------------------------------------------------------*/
-            class DungeonCallback: public ITCODBspCallback
+        template<class Builder>
+        static void run(Builder& b)
+        {
+            for(size_t i=1; i<b.areas.size(); ++i)
             {
-                public:
-                    bool visitNode(TCODBsp*, void*);
-            };
-
-
-        // Member Functions
-        private:
-            void buildRoomType(const TCODBsp&); 
-            void createRooms();
-            void connectPoints(Point&, const Point&, bool);
-            void connectRooms(const AreaPtr, const AreaPtr);
-            void setWall(const Point&);
-            void checkForDoor(const Point&);
-
-        protected:
-            void buildBSPTree();
-            void constructAreas();
-            void connectAreas();
-            void addLights();
-            void finishMap();
-
-        public:
-            DungeonBuilder(const MapPtr m)
-            : MapBuilder(m) {}
+                // Before finishing, the only walkable tiles in a room are its
+                // floor tiles.
+                Point origin = b.areas[i-1]->getRandomOpenPoint(b.rand);
+                Point dest = b.areas[i]->getRandomOpenPoint(b.rand);
 
+                bool vertfirst = b.rand.getInt(0,1) != 0;
+                digCorridor(b.map, origin, dest, vertfirst);
+            }
+        }
     };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : DungeonFinisher
+        Description : Finishing policy that turns filler tiles into the proper
+                      double-barred wall characters, hangs doors in corridor mouths
+                      and places the stairs.  See setDungeonWall() for how the border
+                      codes are read.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    struct DungeonFinisher
+    {
+        template<class Builder>
+        static void run(Builder& b)
+        {
+            const Map& map = *b.map;
+            int width = map.getWidth();
+            int height = map.getHeight();
+            int fillerID = map.tileset->getFillerTileID();
+            int floorID = map.tileset->getFloorTileID();
+
+            // Doors attach to any wall tile except the first, which is the pillar.
+            // Since the tiles after the current one won't be finished yet, the
+            // filler tile is included as well.  There are eleven wall tiles.
+            std::vector<int> doorFrameIDs;
+            doorFrameIDs.push_back(fillerID);
+            for(int i=1; i<12; ++i)
+            {
+                doorFrameIDs.push_back(map.tileset->getWallTileID()+i);
+            }
+
+            TileEquals isFloor(floorID);
+            TileIn isDoorFrame(doorFrameIDs);
+
+            for(int x=0; x<width; x++)
+            {
+                for(int y=0; y<height; y++)
+                {
+                    int tile = map.bottomMostAt(x,y);
+                    if(tile == fillerID)
+                    {
+                        setDungeonWall(b.map, Point(x,y), borderCode(map, x, y, isFloor));
+                    }
+                    else if(tile == floorID)
+                    {
+                        checkForDungeonDoor(b.map, Point(x,y), borderCode(map, x, y, isDoorFrame));
+                    }
+                }
+            }
+
+            b.placeStairs();
+        }
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : DungeonBuilder
+        Description : Constructs a Dungeon tileset map.  Features large square,
+                      circular, and cross-shaped rooms occasionally filled by pillars,
+                      and up to two prefab vaults.  Rooms are connected by one tile
+                      wide corridors.
+        Parents     : PhasedBuilder
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    typedef PhasedBuilder< BSPPartition,
+                           VaultCarver<RoomCarver, 2>,
+                           CorridorConnector,
+                           DungeonFinisher > DungeonBuilder;
 }
 
 #endif
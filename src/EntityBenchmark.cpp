@@ -0,0 +1,237 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Actor.hpp"
+#include "EntityStore.hpp"
+#include "Level.hpp"
+#include "Pool.hpp"
+#include "Tile.hpp"
+#include "Tileset.hpp"
+#include "Types.hpp"
+#include "Vault.hpp"
+
+using namespace std;
+using namespace rlns;
+
+typedef chrono::steady_clock Clock;
+
+/*--------------------------------------------------------------------------------
+    Function    : millisecondsSince
+    Description : Returns the time elapsed since the given point.
+    Inputs      : start time
+    Outputs     : None
+    Return      : double (milliseconds)
+--------------------------------------------------------------------------------*/
+static double millisecondsSince(const Clock::time_point start)
+{
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : inView
+    Description : Stands in for drawing: counts what falls inside an 80 by 50
+                  camera in the middle of the map and sums the characters, so the
+                  work can't be optimized away.
+    Inputs      : position, character, map width and height, running sum
+    Outputs     : the sum
+    Return      : bool (whether the position is in view)
+--------------------------------------------------------------------------------*/
+static bool inView(const Point& pt, const int ch, const int width, const int height, long& sum)
+{
+    Point camTL((width - 80) / 2, (height - 50) / 2);
+    Point camBR(camTL.X() + 79, camTL.Y() + 49);
+    if(!pt.withinBounds(camTL, camBR)) return false;
+    sum += ch;
+    return true;
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : runActors
+    Description : Runs the turns of the object model: each actor steps if the
+                  level allows it, then every actor is walked as drawing would.
+    Inputs      : level, actors, every turn's steps, number of turns, running sum
+    Outputs     : the sum
+    Return      : double (milliseconds taken)
+--------------------------------------------------------------------------------*/
+static double runActors(const Level& level, const vector<ActorPtr>& actors,
+                        const vector<DirectionType>& steps, const int numTurns, long& sum)
+{
+    int width = level.getMapWidth(), height = level.getMapHeight();
+    size_t numActors = actors.size();
+
+    Clock::time_point start = Clock::now();
+    for(int turn=0; turn<numTurns; ++turn)
+    {
+        const DirectionType* turnSteps = &steps[turn * numActors];
+        for(size_t i=0; i<numActors; ++i)
+        {
+            Actor& actor = *actors[i];
+            Point destination = actor.getPosition();
+            destination.shift(turnSteps[i]);
+            if(destination.X() < 0 || destination.Y() < 0 ||
+               destination.X() >= width || destination.Y() >= height) continue;
+            if(level.moveLegal(destination, actor.getMovementType())) actor.setPosition(destination);
+        }
+        for(size_t i=0; i<numActors; ++i)
+        {
+            inView(actors[i]->getPosition(), actors[i]->getChar(), width, height, sum);
+        }
+    }
+    return millisecondsSince(start);
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : main
+    Description : Compares the object model (Actors behind shared pointers, each
+                  allocated on its own or drawn from a pool) with the entity
+                  store on the same work: spawning many actors on the
+                  open cells of a generated level, moving each a random step
+                  every turn, and walking them all once per turn as drawing
+                  would.  All get the same steps in the same order, so they end
+                  in the same places, which is checked.  Run from the directory
+                  that holds datafiles/.
+    Inputs      : optional number of actors (default 100000), turns (default 100)
+                  and seed (default 1)
+    Outputs     : a table on stdout
+    Return      : int (0 if all models agree)
+--------------------------------------------------------------------------------*/
+int main(int argc, char* argv[])
+{
+    int numActors = (argc > 1) ? atoi(argv[1]) : 100000;
+    int numTurns = (argc > 2) ? atoi(argv[2]) : 100;
+    uint32_t seed = (argc > 3) ? strtoul(argv[3], NULL, 10) : 1;
+    if(numActors < 1) numActors = 1;
+    if(numTurns < 1) numTurns = 1;
+
+    TileParser("./datafiles/tiles.txt").run();
+    TilesetParser("./datafiles/tileset.txt").run();
+    VaultParser("./datafiles/vaults.txt").run();
+
+    Level level("Castle", seed);
+    int width = level.getMapWidth(), height = level.getMapHeight();
+
+    vector<Point> open;
+    for(int x=0; x<width; ++x)
+    {
+        for(int y=0; y<height; ++y)
+        {
+            if(level.moveLegal(Point(x,y), WALKING)) open.push_back(Point(x,y));
+        }
+    }
+    if(open.empty())
+    {
+        cerr << "The level has no open cells" << endl;
+        return 1;
+    }
+
+    // every turn's steps, drawn up front so both models get the same ones
+    Random rand(seed);
+    vector<DirectionType> steps(static_cast<size_t>(numActors) * numTurns);
+    for(size_t i=0; i<steps.size(); ++i)
+    {
+        steps[i] = static_cast<DirectionType>(rand.getInt(0, 7));
+    }
+
+    // the object model
+    Clock::time_point start = Clock::now();
+    vector<ActorPtr> actors;
+    actors.reserve(numActors);
+    for(int i=0; i<numActors; ++i)
+    {
+        actors.push_back(ActorPtr(new Actor(open[i % open.size()], 'g', TCODColor::green)));
+    }
+    double objectSpawn = millisecondsSince(start);
+
+    long objectSum = 0;
+    double objectTurns = runActors(level, actors, steps, numTurns, objectSum);
+
+    // the object model, drawn from a pool
+    ArenaPtr arena(new Arena);
+    start = Clock::now();
+    vector<ActorPtr> pooled;
+    pooled.reserve(numActors);
+    for(int i=0; i<numActors; ++i)
+    {
+        pooled.push_back(allocatePooled<Actor>(arena, "Actor", open[i % open.size()], 'g', TCODColor::green));
+    }
+    double pooledSpawn = millisecondsSince(start);
+
+    long pooledSum = 0;
+    double pooledTurns = runActors(level, pooled, steps, numTurns, pooledSum);
+
+    // the entity store
+    EntityStore& entities = level.getEntities();
+    start = Clock::now();
+    vector<Entity> spawned;
+    spawned.reserve(numActors);
+    entities.positions.reserve(numActors);
+    entities.glyphs.reserve(numActors);
+    entities.movement.reserve(numActors);
+    entities.steps.reserve(numActors);
+    for(int i=0; i<numActors; ++i)
+    {
+        Entity e = entities.create();
+        Glyph glyph = { 'g', TCODColor::green, TCODColor::fuchsia };
+        entities.positions.set(e.index, open[i % open.size()]);
+        entities.glyphs.set(e.index, glyph);
+        entities.movement.set(e.index, WALKING);
+        spawned.push_back(e);
+    }
+    double entitySpawn = millisecondsSince(start);
+
+    start = Clock::now();
+    long entitySum = 0;
+    for(int turn=0; turn<numTurns; ++turn)
+    {
+        const DirectionType* turnSteps = &steps[static_cast<size_t>(turn) * numActors];
+        for(int i=0; i<numActors; ++i)
+        {
+            entities.steps.set(spawned[i].index, turnSteps[i]);
+        }
+        level.moveEntities();
+        for(size_t i=0; i<entities.glyphs.size(); ++i)
+        {
+            const Point& position = entities.positions.get(entities.glyphs.ownerAt(i));
+            inView(position, entities.glyphs.at(i).ch, width, height, entitySum);
+        }
+    }
+    double entityTurns = millisecondsSince(start);
+
+    bool agree = (objectSum == entitySum && pooledSum == entitySum);
+    for(int i=0; i<numActors && agree; ++i)
+    {
+        agree = actors[i]->getPosition() == entities.positions.get(spawned[i].index) &&
+                pooled[i]->getPosition() == actors[i]->getPosition();
+    }
+
+    // a shared_ptr to a separately allocated object also costs a control block
+    size_t objectBytes = numActors * (sizeof(ActorPtr) + sizeof(Actor) + 2*sizeof(long) + sizeof(void*));
+
+    cout << numActors << " actors, " << numTurns << " turns on a "
+         << width << "x" << height << " level" << endl;
+    cout << left << setw(10) << "model" << right << setw(12) << "spawn ms"
+         << setw(12) << "turns ms" << setw(14) << "ms per turn" << setw(12) << "KB" << endl;
+    cout << fixed << setprecision(2);
+    cout << left << setw(10) << "objects" << right << setw(12) << objectSpawn
+         << setw(12) << objectTurns << setw(14) << objectTurns / numTurns
+         << setw(12) << objectBytes / 1024 << endl;
+    cout << left << setw(10) << "pooled" << right << setw(12) << pooledSpawn
+         << setw(12) << pooledTurns << setw(14) << pooledTurns / numTurns
+         << setw(12) << (arena->memoryUsage() + numActors * sizeof(ActorPtr)) / 1024 << endl;
+    cout << left << setw(10) << "entities" << right << setw(12) << entitySpawn
+         << setw(12) << entityTurns << setw(14) << entityTurns / numTurns
+         << setw(12) << entities.memoryUsage() / 1024 << endl;
+    cout << (agree ? "All models agree." : "The models disagree!") << endl;
+
+    return agree ? 0 : 1;
+}
@@ -0,0 +1,409 @@
+#include "EntityStore.hpp"
+#include "Item.hpp"
+#include "Map.hpp"
+#include "Pool.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Function    : checkOwners
+        Description : Checks that saved component owners name live entities, each
+                      at most once.
+        Inputs      : owners read from the save, generations of the store's slots
+        Outputs     : throws runtime_error if they don't
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    static void checkOwners(const vector<uint32_t>& owners, const vector<uint32_t>& generations)
+    {
+        vector<bool> seen(generations.size(), false);
+        for(size_t i=0; i<owners.size(); ++i)
+        {
+            uint32_t slot = owners[i];
+            if(slot >= generations.size() || generations[slot] % 2 == 0 || seen[slot])
+            {
+                throw runtime_error("save file is damaged");
+            }
+            seen[slot] = true;
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : EntityStore::EntityStore(SaveReader&)
+        Description : Loads a store written by saveToDisk.  Entities keep their
+                      slots and generations, so handles taken before the save still
+                      name the same entities.
+        Inputs      : save file
+        Outputs     : throws runtime_error if the section is damaged
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    EntityStore::EntityStore(SaveReader& save)
+    {
+        save.beginSection(SAVE_ENTITIES);
+        save.getBlock(generations);
+        for(size_t i=0; i<generations.size(); ++i)
+        {
+            if(generations[i] % 2 == 0) freeSlots.push_back(i);
+        }
+
+        vector<uint32_t> owners;
+        vector<int32_t> xs, ys, chars;
+        vector<uint8_t> colors, types;
+
+        save.getBlock(owners);
+        save.getBlock(xs);
+        save.getBlock(ys);
+        checkOwners(owners, generations);
+        if(xs.size() != owners.size() || ys.size() != owners.size())
+        {
+            throw runtime_error("save file is damaged");
+        }
+        positions.reserve(owners.size());
+        for(size_t i=0; i<owners.size(); ++i)
+        {
+            positions.set(owners[i], Point(xs[i], ys[i]));
+        }
+
+        save.getBlock(owners);
+        save.getBlock(chars);
+        save.getBlock(colors);
+        checkOwners(owners, generations);
+        if(chars.size() != owners.size() || colors.size() != 6*owners.size())
+        {
+            throw runtime_error("save file is damaged");
+        }
+        glyphs.reserve(owners.size());
+        for(size_t i=0; i<owners.size(); ++i)
+        {
+            const uint8_t* c = &colors[6*i];
+            Glyph glyph = { chars[i], TCODColor(c[0], c[1], c[2]), TCODColor(c[3], c[4], c[5]) };
+            glyphs.set(owners[i], glyph);
+        }
+
+        save.getBlock(owners);
+        save.getBlock(types);
+        checkOwners(owners, generations);
+        if(types.size() != owners.size())
+        {
+            throw runtime_error("save file is damaged");
+        }
+        for(size_t i=0; i<owners.size(); ++i)
+        {
+            movement.set(owners[i], static_cast<MovementType>(types[i]));
+        }
+
+        save.getBlock(owners);
+        checkOwners(owners, generations);
+        for(size_t i=0; i<owners.size(); ++i)
+        {
+            vector<ItemPtr> items;
+            Item::loadList(save, items);
+
+            Inventory inventory;
+            for(size_t j=0; j<items.size(); ++j)
+            {
+                inventory.addItem(items[j]);
+            }
+            inventories.set(owners[i], inventory);
+        }
+
+        vector<uint32_t> values;
+        save.getBlock(owners);
+        save.getBlock(values);
+        checkOwners(owners, generations);
+        if(values.size() != owners.size())
+        {
+            throw runtime_error("save file is damaged");
+        }
+        for(size_t i=0; i<owners.size(); ++i)
+        {
+            speeds.set(owners[i], values[i]);
+        }
+
+        save.endSection();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : EntityStore::create
+        Description : Makes a new entity with no components, reusing a free slot if
+                      there is one.
+        Inputs      : None
+        Outputs     : None
+        Return      : Entity
+    --------------------------------------------------------------------------------*/
+    Entity EntityStore::create()
+    {
+        uint32_t slot;
+        if(!freeSlots.empty())
+        {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+            ++generations[slot];
+        }
+        else
+        {
+            slot = generations.size();
+            generations.push_back(1);
+        }
+
+        Entity entity = { slot, generations[slot] };
+        return entity;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : EntityStore::destroy
+        Description : Removes an entity and all of its components.  Does nothing if
+                      the entity is already gone.
+        Inputs      : entity
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void EntityStore::destroy(const Entity entity)
+    {
+        if(!isAlive(entity)) return;
+
+        uint32_t slot = entity.index;
+        positions.remove(slot);
+        glyphs.remove(slot);
+        movement.remove(slot);
+        steps.remove(slot);
+        stats.remove(slot);
+        inventories.remove(slot);
+        speeds.remove(slot);
+
+        ++generations[slot];
+        freeSlots.push_back(slot);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : EntityStore::isAlive
+        Description : Returns whether the entity still exists.
+        Inputs      : entity
+        Outputs     : None
+        Return      : bool
+    --------------------------------------------------------------------------------*/
+    bool EntityStore::isAlive(const Entity entity) const
+    {
+        return entity.index < generations.size() &&
+               generations[entity.index] == entity.generation &&
+               entity.generation % 2 == 1;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : EntityStore::entityAt
+        Description : Returns the entity living in a slot, such as the owner of a
+                      component found while walking a ComponentArray.
+        Inputs      : slot
+        Outputs     : None
+        Return      : Entity
+    --------------------------------------------------------------------------------*/
+    Entity EntityStore::entityAt(const uint32_t slot) const
+    {
+        Entity entity = { slot, generations.at(slot) };
+        return entity;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : EntityStore::clear
+        Description : Removes every entity.
+        Inputs      : None
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void EntityStore::clear()
+    {
+        positions.clear();
+        glyphs.clear();
+        movement.clear();
+        steps.clear();
+        stats.clear();
+        inventories.clear();
+        speeds.clear();
+        generations.clear();
+        freeSlots.clear();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : EntityStore::step
+        Description : Moves one entity a step if it has a position and the map
+                      allows its kind of movement there; entities without a
+                      movement type walk.
+        Inputs      : entity slot, direction, the level's map
+        Outputs     : None
+        Return      : bool (whether it moved)
+    --------------------------------------------------------------------------------*/
+    bool EntityStore::step(const uint32_t slot, const DirectionType direction, const Map& map)
+    {
+        Point* position = positions.find(slot);
+        if(position == NULL) return false;
+
+        int width = map.getWidth(), height = map.getHeight();
+        Point destination = *position;
+        destination.shift(direction);
+        if(destination.X() < 0 || destination.Y() < 0 ||
+           destination.X() >= width || destination.Y() >= height)
+        {
+            return false;
+        }
+
+        const MovementType* type = movement.find(slot);
+        if(!map.moveLegal(destination, type ? *type : WALKING)) return false;
+
+        *position = destination;
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : EntityStore::move
+        Description : The movement system.  Every entity that wants to step takes
+                      the step if it can, then the wanted steps are cleared.
+        Inputs      : the level's map
+        Outputs     : None
+        Return      : size_t (number of entities that moved)
+    --------------------------------------------------------------------------------*/
+    size_t EntityStore::move(const Map& map)
+    {
+        size_t moved = 0;
+        for(size_t i=0; i<steps.size(); ++i)
+        {
+            if(step(steps.ownerAt(i), steps.at(i), map)) ++moved;
+        }
+
+        steps.clear();
+        return moved;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : EntityStore::takeSnapshot
+        Description : Copies the store for saving on another thread.  The component
+                      arrays are copied whole; the items carried are copied one by
+                      one, since items are shared.
+        Inputs      : None
+        Outputs     : None
+        Return      : EntityStorePtr
+    --------------------------------------------------------------------------------*/
+    EntityStorePtr EntityStore::takeSnapshot() const
+    {
+        EntityStorePtr copy(new EntityStore(*this));
+        for(size_t i=0; i<copy->inventories.size(); ++i)
+        {
+            Inventory carried;
+            vector<ItemPtr> items = inventories.at(i).getMiscItems();
+            for(size_t j=0; j<items.size(); ++j)
+            {
+                carried.addItem(allocatePooled<Item>(Arena::global(), "Item", *items[j]));
+            }
+            copy->inventories.at(i) = carried;
+        }
+        return copy;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : EntityStore::saveToDisk
+        Description : Saves the entities in a section of their own: the generation
+                      of every slot, then each saved component as its owners
+                      followed by its values, a block per field.  Speeds come
+                      last, so stores saved without them still load.
+        Inputs      : save file
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void EntityStore::saveToDisk(SaveWriter& save) const
+    {
+        save.beginSection(SAVE_ENTITIES);
+        save.putBlock(generations);
+
+        vector<int32_t> xs, ys;
+        xs.reserve(positions.size());
+        ys.reserve(positions.size());
+        for(size_t i=0; i<positions.size(); ++i)
+        {
+            xs.push_back(positions.at(i).X());
+            ys.push_back(positions.at(i).Y());
+        }
+        save.putBlock(positions.getOwners());
+        save.putBlock(xs);
+        save.putBlock(ys);
+
+        vector<int32_t> chars;
+        vector<uint8_t> colors;
+        chars.reserve(glyphs.size());
+        colors.reserve(6*glyphs.size());
+        for(size_t i=0; i<glyphs.size(); ++i)
+        {
+            const Glyph& glyph = glyphs.at(i);
+            chars.push_back(glyph.ch);
+            uint8_t c[6] = { glyph.fg.r, glyph.fg.g, glyph.fg.b, glyph.bg.r, glyph.bg.g, glyph.bg.b };
+            colors.insert(colors.end(), c, c + 6);
+        }
+        save.putBlock(glyphs.getOwners());
+        save.putBlock(chars);
+        save.putBlock(colors);
+
+        vector<uint8_t> types;
+        types.reserve(movement.size());
+        for(size_t i=0; i<movement.size(); ++i)
+        {
+            types.push_back(movement.at(i));
+        }
+        save.putBlock(movement.getOwners());
+        save.putBlock(types);
+
+        save.putBlock(inventories.getOwners());
+        for(size_t i=0; i<inventories.size(); ++i)
+        {
+            Item::saveList(save, inventories.at(i).getMiscItems());
+        }
+
+        vector<uint32_t> values;
+        values.reserve(speeds.size());
+        for(size_t i=0; i<speeds.size(); ++i)
+        {
+            values.push_back(speeds.at(i));
+        }
+        save.putBlock(speeds.getOwners());
+        save.putBlock(values);
+
+        save.endSection();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : EntityStore::memoryUsage
+        Description : Estimates the bytes the store holds on to.  Items carried
+                      and the strings in stats aren't counted.
+        Inputs      : None
+        Outputs     : None
+        Return      : size_t
+    --------------------------------------------------------------------------------*/
+    size_t EntityStore::memoryUsage() const
+    {
+        return sizeof(*this)
+             + positions.memoryUsage() + glyphs.memoryUsage() + movement.memoryUsage()
+             + steps.memoryUsage() + stats.memoryUsage() + inventories.memoryUsage()
+             + speeds.memoryUsage()
+             + (generations.capacity() + freeSlots.capacity()) * sizeof(uint32_t);
+    }
+}
@@ -0,0 +1,197 @@
+#ifndef RLNS_ENTITYSTORE_HPP
+#define RLNS_ENTITYSTORE_HPP
+
+#include <vector>
+
+#include <stdint.h>
+
+#include "Inventory.hpp"
+#include "Point.hpp"
+#include "SaveFile.hpp"
+#include "Types.hpp"
+#include "VitalStats.hpp"
+
+#include "libtcod.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Struct      : Entity
+        Description : Names an entity in an EntityStore: the slot it lives in and the
+                      generation of that slot.  A slot is reused once its entity is
+                      destroyed, with the next generation, so a handle to the old
+                      entity is never mistaken for the new one.
+    --------------------------------------------------------------------------------*/
+    struct Entity
+    {
+        uint32_t index;
+        uint32_t generation;
+
+        bool operator==(const Entity& e) const
+        { return index == e.index && generation == e.generation; }
+        bool operator!=(const Entity& e) const
+        { return !(*this == e); }
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Struct      : Glyph
+        Description : How an entity is drawn: its character and colors, as for a
+                      MapObject.
+    --------------------------------------------------------------------------------*/
+    struct Glyph
+    {
+        int ch;
+        TCODColor fg, bg;
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : ComponentArray
+        Description : One component of every entity that has it, packed into a
+                      single array in no particular order, so a system can walk
+                      them without gaps.  A second array, indexed by entity slot,
+                      finds an entity's component in constant time; removing one
+                      moves the last component into its place.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    template<typename T>
+    class ComponentArray
+    {
+        // Member Variables
+        public:
+            static const uint32_t NONE = 0xFFFFFFFF;
+
+        private:
+            std::vector<T> values;
+            std::vector<uint32_t> owners; // entity slot of each value
+            std::vector<uint32_t> where;  // position in values of each slot, or NONE
+
+        // Member Functions
+        public:
+            size_t size() const  { return values.size(); }
+            bool empty() const   { return values.empty(); }
+            void reserve(const size_t n) { values.reserve(n); owners.reserve(n); }
+
+            bool has(const uint32_t slot) const
+            { return slot < where.size() && where[slot] != NONE; }
+
+            T& get(const uint32_t slot)             { return values[where[slot]]; }
+            const T& get(const uint32_t slot) const { return values[where[slot]]; }
+
+            T* find(const uint32_t slot)
+            { return has(slot) ? &values[where[slot]] : NULL; }
+            const T* find(const uint32_t slot) const
+            { return has(slot) ? &values[where[slot]] : NULL; }
+
+            // dense access, for systems walking every component
+            T& at(const size_t i)                   { return values[i]; }
+            const T& at(const size_t i) const       { return values[i]; }
+            uint32_t ownerAt(const size_t i) const  { return owners[i]; }
+            const std::vector<uint32_t>& getOwners() const { return owners; }
+
+            void set(const uint32_t slot, const T& value)
+            {
+                if(has(slot))
+                {
+                    values[where[slot]] = value;
+                    return;
+                }
+                if(slot >= where.size()) where.resize(slot + 1, NONE);
+                where[slot] = values.size();
+                values.push_back(value);
+                owners.push_back(slot);
+            }
+
+            void remove(const uint32_t slot)
+            {
+                if(!has(slot)) return;
+                uint32_t i = where[slot];
+                uint32_t last = owners.back();
+                if(i != values.size() - 1)
+                {
+                    values[i] = values.back();
+                    owners[i] = last;
+                    where[last] = i;
+                }
+                values.pop_back();
+                owners.pop_back();
+                where[slot] = NONE;
+            }
+
+            void clear()
+            {
+                values.clear();
+                owners.clear();
+                where.clear();
+            }
+
+            size_t memoryUsage() const
+            {
+                return values.capacity() * sizeof(T)
+                     + (owners.capacity() + where.capacity()) * sizeof(uint32_t);
+            }
+    };
+
+    template<typename T>
+    const uint32_t ComponentArray<T>::NONE;
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : EntityStore
+        Description : The actors and objects of a level, stored as components
+                      rather than as objects.  An entity is only a slot number;
+                      its position, look, movement type, stats, inventory and
+                      speed each live in a ComponentArray of their own, and an
+                      entity has only the components it was given.  Systems such
+                      as drawing and movement walk one array from start to end
+                      instead of chasing a pointer per object.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class EntityStore
+    {
+        // Member Variables
+        public:
+            ComponentArray<Point> positions;
+            ComponentArray<Glyph> glyphs;
+            ComponentArray<MovementType> movement;
+            ComponentArray<DirectionType> steps; // moves wanted this turn, not saved
+            ComponentArray<VitalStats> stats;    // not saved, like party members' stats
+            ComponentArray<Inventory> inventories;
+            ComponentArray<unsigned int> speeds; // entities with a speed act on their own
+
+        private:
+            std::vector<uint32_t> generations; // of each slot; odd while in use
+            std::vector<uint32_t> freeSlots;
+
+        // Member Functions
+        public:
+            EntityStore() {}
+            EntityStore(SaveReader&);
+
+            size_t size() const     { return generations.size() - freeSlots.size(); }
+            size_t capacity() const { return generations.size(); }
+
+            Entity create();
+            void destroy(const Entity);
+            bool isAlive(const Entity) const;
+            Entity entityAt(const uint32_t) const;
+            void clear();
+
+            bool step(const uint32_t, const DirectionType, const Map&);
+            size_t move(const Map&);
+
+            EntityStorePtr takeSnapshot() const;
+            void saveToDisk(SaveWriter&) const;
+            size_t memoryUsage() const;
+    };
+}
+
+#endif
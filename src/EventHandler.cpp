@@ -155,6 +155,9 @@ namespace rlns
                     return ITEM;
                 case 'e':
                     return EQUIPMENT;
+            // System Commands
+                case 'S':
+                    return SAVE;
                 default:
                     return NO_EVENT;
             // Command Prompt
@@ -30,7 +30,7 @@ namespace rlns
         Outputs     : command prompt
         Return      : string
     --------------------------------------------------------------------------------*/
-    static string getTextInput(const DisplayPtr display)
+    string getTextInput(const DisplayPtr display)
     {
         TCOD_key_t key;
         string prompt(":");
@@ -137,15 +137,15 @@ namespace rlns
     /*--------------------------------------------------------------------------------
         Function    : showInventory
         Description : Creates an InventoryScreen object and starts its event loop.
-        Inputs      : DisplayPtr
+        Inputs      : DisplayPtr, source of the screen's events, whether to draw it
         Outputs     : inventory screen
         Return      : bool (whether the action performed in the inventory screen costs
                       a turn)
     --------------------------------------------------------------------------------*/
-    bool showInventory(const DisplayPtr display)
+    bool showInventory(const DisplayPtr display, const EventSource& input, const bool drawn)
     {
         InventoryScreen invScreen(display, Party::getPlayerParty()->getLeader());
-        return invScreen.eventLoop();
+        return invScreen.eventLoop(input, drawn);
     }
 
 
@@ -153,12 +153,33 @@ namespace rlns
     /*--------------------------------------------------------------------------------
         Function    : mainEventContext
         Description : Handles events for the main mode of the game: moving the party
-                      around the playfield.
+                      around the playfield.  A command is typed at the prompt.
         Inputs      : EventType
         Outputs     : Changes to the game state
         Return      : bool (whether the action costs a turn)
     --------------------------------------------------------------------------------*/
     bool mainEventContext(const EventType event, const DisplayPtr display)
+    {
+        if(event == COMMAND) return mainEventContext(event, display, getTextInput(display));
+        return mainEventContext(event, display, "");
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : mainEventContext(EventType, DisplayPtr, string)
+        Description : As above, but a command is the one given rather than one
+                      typed, as when it was typed earlier and is being played back.
+                      The events given inside a screen this opens, like the
+                      inventory, come from the source given, or the keyboard if
+                      it is empty, and the screen is drawn only if asked to be.
+        Inputs      : EventType, DisplayPtr, command (for a COMMAND event), source
+                      of screen events, whether to draw screens
+        Outputs     : Changes to the game state
+        Return      : bool (whether the action costs a turn)
+    --------------------------------------------------------------------------------*/
+    bool mainEventContext(const EventType event, const DisplayPtr display, const string& command,
+                          const EventSource& screenInput, const bool drawn)
     {
         // clear the command prompt, since it should only display during the turn
         // it is activated
@@ -168,7 +189,6 @@ namespace rlns
         {
             case COMMAND:
             {
-                string command = getTextInput(display);
                 interpretCommandString(command, display);
                 return false;
             }
@@ -215,7 +235,7 @@ namespace rlns
             }
             case EQUIPMENT:
             {
-                return showInventory(display);
+                return showInventory(display, screenInput, drawn);
             }
             default: return false;
         }
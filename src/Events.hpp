@@ -15,7 +15,7 @@
 namespace rlns
 {
     // Event Functions
-    //std::string getTextInput(const DisplayPtr);
+    std::string getTextInput(const DisplayPtr);
     //bool movePlayer(const model::DirectionType, const DisplayPtr);
     //bool pickUpItem(const DisplayPtr);
     //bool showInventory(const DisplayPtr);
@@ -23,6 +23,8 @@ namespace rlns
 
     // Event Context Functions
     bool mainEventContext(const EventType, const DisplayPtr);
+    bool mainEventContext(const EventType, const DisplayPtr, const std::string&,
+                          const EventSource& = EventSource(), const bool = true);
 }
 
 #endif
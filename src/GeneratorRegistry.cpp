@@ -0,0 +1,137 @@
+#include "GeneratorRegistry.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Function    : GeneratorRegistry::factories
+        Description : Returns the factory table.  The table is a function-local
+                      static so that builders can register during static
+                      initialization regardless of file order.
+        Inputs      : None
+        Outputs     : None
+        Return      : map<MapType, BuilderFactory>
+    --------------------------------------------------------------------------------*/
+    map<MapType, BuilderFactory>& GeneratorRegistry::factories()
+    {
+        static map<MapType, BuilderFactory> table;
+        return table;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : GeneratorRegistry::sourceFactories
+        Description : Returns the chunk source factory table, a function-local
+                      static like the builder table.
+        Inputs      : None
+        Outputs     : None
+        Return      : map<MapType, ChunkSourceFactory>
+    --------------------------------------------------------------------------------*/
+    map<MapType, ChunkSourceFactory>& GeneratorRegistry::sourceFactories()
+    {
+        static map<MapType, ChunkSourceFactory> table;
+        return table;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : GeneratorRegistry::registerBuilder
+        Description : Registers the builder factory for a map type, replacing any
+                      factory previously registered for it.
+        Inputs      : map type, builder factory
+        Outputs     : None
+        Return      : bool (always true, so it can initialize a static variable)
+    --------------------------------------------------------------------------------*/
+    bool GeneratorRegistry::registerBuilder(const MapType type, const BuilderFactory factory)
+    {
+        factories()[type] = factory;
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : GeneratorRegistry::isRegistered
+        Description : Checks whether a builder exists for the given map type.
+        Inputs      : map type
+        Outputs     : None
+        Return      : bool
+    --------------------------------------------------------------------------------*/
+    bool GeneratorRegistry::isRegistered(const MapType type)
+    {
+        return factories().find(type) != factories().end();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : GeneratorRegistry::createBuilder
+        Description : Creates the builder registered for the map's tileset type.
+        Inputs      : Map object to build
+        Outputs     : possible error message and abort
+        Return      : MapBuilderPtr
+    --------------------------------------------------------------------------------*/
+    MapBuilderPtr GeneratorRegistry::createBuilder(const MapPtr m)
+    {
+        map<MapType, BuilderFactory>::const_iterator it;
+        it = factories().find(m->tileset->getType());
+        if(it == factories().end())
+        {
+            fatalError("No map builder registered for tileset '" + m->tileset->getName() + "'");
+        }
+        return it->second(m);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : GeneratorRegistry::registerChunkSource
+        Description : Registers the chunk source factory for a map type, which makes
+                      maps of that type streamed.
+        Inputs      : map type, chunk source factory
+        Outputs     : None
+        Return      : bool (always true, so it can initialize a static variable)
+    --------------------------------------------------------------------------------*/
+    bool GeneratorRegistry::registerChunkSource(const MapType type, const ChunkSourceFactory factory)
+    {
+        sourceFactories()[type] = factory;
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : GeneratorRegistry::isStreamed
+        Description : Checks whether maps of the given type are streamed.
+        Inputs      : map type
+        Outputs     : None
+        Return      : bool
+    --------------------------------------------------------------------------------*/
+    bool GeneratorRegistry::isStreamed(const MapType type)
+    {
+        return sourceFactories().find(type) != sourceFactories().end();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : GeneratorRegistry::createChunkSource
+        Description : Creates the chunk source registered for the tileset's type.
+        Inputs      : tileset, seed
+        Outputs     : possible error message and abort
+        Return      : ChunkSourcePtr
+    --------------------------------------------------------------------------------*/
+    ChunkSourcePtr GeneratorRegistry::createChunkSource(const Tileset& tileset, const uint32_t seed)
+    {
+        map<MapType, ChunkSourceFactory>::const_iterator it;
+        it = sourceFactories().find(tileset.getType());
+        if(it == sourceFactories().end())
+        {
+            fatalError("No chunk source registered for tileset '" + tileset.getName() + "'");
+        }
+        return it->second(tileset, seed);
+    }
+}
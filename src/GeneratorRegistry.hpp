@@ -0,0 +1,62 @@
+#ifndef RLNS_GENERATORREGISTRY_HPP
+#define RLNS_GENERATORREGISTRY_HPP
+
+#include <map>
+
+#include "Map.hpp"
+#include "MapBuilder.hpp"
+#include "Types.hpp"
+#include "Utility.hpp"
+
+namespace rlns
+{
+    typedef MapBuilderPtr (*BuilderFactory)(const MapPtr);
+    typedef ChunkSourcePtr (*ChunkSourceFactory)(const Tileset&, const uint32_t);
+
+    // default factory for builders that only need the map to construct
+    template<class Builder>
+    MapBuilderPtr makeBuilder(const MapPtr map)
+    {
+        return MapBuilderPtr(new Builder(map));
+    }
+
+    // default factory for chunk sources made from the tileset and a seed
+    template<class Source>
+    ChunkSourcePtr makeChunkSource(const Tileset& tileset, const uint32_t seed)
+    {
+        return ChunkSourcePtr(new Source(tileset, seed));
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : GeneratorRegistry
+        Description : Maps each MapType read from tileset.txt to the factory for its
+                      builder.  Builders register themselves from their own source
+                      file, so new tileset styles can be added without touching
+                      Level.  A map type that also registers a chunk source is
+                      streamed: its maps are generated a chunk at a time as they
+                      are used, and only some of the chunks stay in memory.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class GeneratorRegistry
+    {
+        // Static Functions
+        private:
+            static std::map<MapType, BuilderFactory>& factories();
+            static std::map<MapType, ChunkSourceFactory>& sourceFactories();
+
+        public:
+            static bool registerBuilder(const MapType, const BuilderFactory);
+            static bool isRegistered(const MapType);
+            static MapBuilderPtr createBuilder(const MapPtr);
+
+            static bool registerChunkSource(const MapType, const ChunkSourceFactory);
+            static bool isStreamed(const MapType);
+            static ChunkSourcePtr createChunkSource(const Tileset&, const uint32_t);
+    };
+}
+
+#endif
@@ -0,0 +1,192 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Actor.hpp"
+#include "Autopilot.hpp"
+#include "Display.hpp"
+#include "EntityStore.hpp"
+#include "Events.hpp"
+#include "Level.hpp"
+#include "Party.hpp"
+#include "Pool.hpp"
+#include "Profiler.hpp"
+#include "Scheduler.hpp"
+#include "Tile.hpp"
+#include "Tileset.hpp"
+#include "Types.hpp"
+#include "Vault.hpp"
+
+using namespace std;
+using namespace rlns;
+
+typedef chrono::steady_clock Clock;
+
+/*--------------------------------------------------------------------------------
+    Struct      : SystemTime
+    Description : The time spent in one part of the game loop, and how often it
+                  ran.
+--------------------------------------------------------------------------------*/
+struct SystemTime
+{
+    const char* name;
+    double ms;
+    size_t calls;
+};
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : timed
+    Description : Calls f, adding the time it takes to the given system.
+    Inputs      : system, function to call
+    Outputs     : the system's time
+    Return      : what f returns
+--------------------------------------------------------------------------------*/
+template<typename Function>
+static auto timed(SystemTime& system, Function f) -> decltype(f())
+{
+    struct Stopwatch
+    {
+        SystemTime& system;
+        Clock::time_point start;
+        ~Stopwatch()
+        {
+            system.ms += chrono::duration<double, milli>(Clock::now() - start).count();
+            ++system.calls;
+        }
+    } stopwatch = { system, Clock::now() };
+    return f();
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : spawnMonsters
+    Description : Puts wandering entities on the open cells of the current level,
+                  with speeds from half to one and a half times normal, and
+                  schedules them.
+    Inputs      : number of entities
+    Outputs     : None
+    Return      : size_t (number spawned, 0 if the level has no open cells)
+--------------------------------------------------------------------------------*/
+static size_t spawnMonsters(const int numMonsters)
+{
+    LevelPtr level = Level::getCurrentLevel();
+    vector<Point> open;
+    for(int x=0; x<level->getMapWidth(); ++x)
+    {
+        for(int y=0; y<level->getMapHeight(); ++y)
+        {
+            if(level->moveLegal(Point(x,y), WALKING)) open.push_back(Point(x,y));
+        }
+    }
+    if(open.empty()) return 0;
+
+    EntityStore& entities = level->getEntities();
+    for(int i=0; i<numMonsters; ++i)
+    {
+        Entity e = entities.create();
+        Glyph glyph = { 'g', TCODColor::green, TCODColor::fuchsia };
+        entities.positions.set(e.index, open[(static_cast<size_t>(i) * 7919) % open.size()]);
+        entities.glyphs.set(e.index, glyph);
+        entities.movement.set(e.index, WALKING);
+        entities.speeds.set(e.index, Scheduler::NORMAL_SPEED / 2 + i % (Scheduler::NORMAL_SPEED + 1));
+        level->scheduleEntity(e);
+    }
+    return numMonsters;
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : main
+    Description : Plays the game without a window, for soak tests on machines
+                  with no display.  An Autopilot stands in for the player and
+                  its events go through mainEventContext as keypresses would;
+                  the display has no consoles, so nothing is drawn.  Each event
+                  runs the same systems as the game loop, each timed on its own.
+                  At the end it prints the turns per second, the time per
+                  system and the pool allocation counts.  Run from the
+                  directory that holds datafiles/.
+    Inputs      : optional number of events (default 10000), monsters (default
+                  1000), seed (default 1) and script of keys to press (default
+                  a random walk)
+    Outputs     : a report on stdout
+    Return      : int (0 unless the level couldn't be set up)
+--------------------------------------------------------------------------------*/
+int main(int argc, char* argv[])
+{
+    int numEvents = (argc > 1) ? atoi(argv[1]) : 10000;
+    int numMonsters = (argc > 2) ? atoi(argv[2]) : 1000;
+    uint32_t seed = (argc > 3) ? strtoul(argv[3], NULL, 10) : 1;
+    string script = (argc > 4) ? argv[4] : "";
+    if(numEvents < 1) numEvents = 1;
+    if(numMonsters < 0) numMonsters = 0;
+
+    TileParser("./datafiles/tiles.txt").run();
+    TilesetParser("./datafiles/tileset.txt").run();
+    VaultParser("./datafiles/vaults.txt").run();
+
+    Level::addLevel("Castle", seed);
+    Point pos = Level::getCurrentLevel()->getUpStairLocation();
+    ActorPtr player = allocatePooled<Actor>(Arena::global(), "Actor", pos, '@', TCODColor::white);
+    Party::getPlayerParty()->addMember(player);
+    Level::getCurrentLevel()->addParty(Party::getPlayerParty());
+
+    if(numMonsters > 0 && spawnMonsters(numMonsters) == 0)
+    {
+        cerr << "The level has no open cells" << endl;
+        return 1;
+    }
+
+    DisplayPtr display(new Display(100));
+    display->setFocalPoint(pos);
+    AutopilotPtr autopilot(script.empty() ? new Autopilot(seed) : new Autopilot(script));
+
+    SystemTime renderTime     = { "render",     0.0, 0 };
+    SystemTime playerTime     = { "player",     0.0, 0 };
+    SystemTime monsterTime    = { "monsters",   0.0, 0 };
+    SystemTime backgroundTime = { "background", 0.0, 0 };
+
+    size_t playerTurns = 0, monsterTurns = 0;
+    Clock::time_point start = Clock::now();
+    for(int i=0; i<numEvents && IS_RUNNING; ++i)
+    {
+        timed(renderTime, [&]() { display->refresh(); });
+
+        EventType event = autopilot->nextEvent();
+        if(!timed(playerTime, [&]() { return mainEventContext(event, display); })) continue;
+
+        ++playerTurns;
+        monsterTurns += timed(monsterTime, [&]()
+        {
+            return Level::getCurrentLevel()->runUntilPlayer(Scheduler::NORMAL_COST);
+        });
+        timed(backgroundTime, [&]() { Level::simulateInactive(); });
+    }
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    cout << numEvents << " events, " << numMonsters << " monsters, seed " << seed
+         << (script.empty() ? ", random walk" : ", scripted") << endl;
+    cout << fixed << setprecision(1);
+    cout << playerTurns << " player turns and " << monsterTurns << " monster turns in "
+         << seconds * 1000.0 << " ms: " << playerTurns / seconds << " turns per second" << endl;
+
+    cout << left << setw(12) << "system" << right << setw(12) << "calls"
+         << setw(12) << "ms" << setw(14) << "us per call" << endl;
+    const SystemTime* systems[] = { &renderTime, &playerTime, &monsterTime, &backgroundTime };
+    for(size_t i=0; i<sizeof(systems)/sizeof(systems[0]); ++i)
+    {
+        const SystemTime& system = *systems[i];
+        cout << left << setw(12) << system.name << right << setw(12) << system.calls
+             << setw(12) << system.ms
+             << setw(14) << (system.calls ? system.ms * 1000.0 / system.calls : 0.0) << endl;
+    }
+
+    StartupProfiler::reportPools(cout);
+    return 0;
+}
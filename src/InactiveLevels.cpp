@@ -0,0 +1,382 @@
+#include "InactiveLevels.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Function    : unpackLevel
+        Description : Loads the level held in a one-level save.
+        Inputs      : the save's bytes
+        Outputs     : throws runtime_error if the level is damaged
+        Return      : LevelPtr
+    --------------------------------------------------------------------------------*/
+    static LevelPtr unpackLevel(const vector<char>& packed)
+    {
+        SaveReader save(&packed[0], packed.size());
+        save.beginSection(SAVE_LEVEL);
+        LevelPtr level(new Level(save));
+        save.endSection();
+        return level;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : InactiveLevels::InactiveLevels
+        Description : Starts with no levels and the default budget of 32 MB.
+        Inputs      : None
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    InactiveLevels::InactiveLevels()
+    : budget(32 * 1024 * 1024), clock(0) {}
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : InactiveLevels::grow
+        Description : Adds resident slots until there is one for every level.
+        Inputs      : number of levels
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void InactiveLevels::grow(const size_t numLevels)
+    {
+        while(slots.size() < numLevels)
+        {
+            Slot slot = { RESIDENT, PackedLevelPtr(), SwapExtentPtr(), 0, false, 0, clock };
+            slots.push_back(slot);
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : InactiveLevels::clear
+        Description : Forgets every level, as when a whole game has been loaded.
+                      The swap file is kept for the levels to come; a save still
+                      reading from it holds on to it either way.
+        Inputs      : None
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void InactiveLevels::clear()
+    {
+        slots.clear();
+        savedLevels.reset();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : InactiveLevels::resume
+        Description : Starts over with the levels of a resumed game, all still in
+                      its save but the current one.  They are as up to date as
+                      the game was when it was resumed.
+        Inputs      : the save
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void InactiveLevels::resume(const SavedLevelsPtr saved)
+    {
+        clear();
+        grow(saved->size());
+        for(size_t i=0; i<slots.size(); ++i)
+        {
+            if(i == saved->getCurrentLevel()) continue;
+            slots[i].place = IN_SAVE;
+            slots[i].simulatedUntil = Level::getWorldTime();
+        }
+        if(saved->size() > 1) savedLevels = saved;
+        touch(saved->getCurrentLevel());
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : InactiveLevels::touch
+        Description : Marks a level as just used.
+        Inputs      : level number
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void InactiveLevels::touch(const size_t i)
+    {
+        grow(i + 1);
+        slots[i].lastUsed = ++clock;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : InactiveLevels::park
+        Description : Saves a level into a deflated one-level save kept in memory
+                      and lets go of the live level.  The level holding the
+                      player's party is never parked.
+        Inputs      : level number, the live level
+        Outputs     : the live level is reset if it was parked
+        Return      : bool (whether it was parked)
+    --------------------------------------------------------------------------------*/
+    bool InactiveLevels::park(const size_t i, LevelPtr& level)
+    {
+        if(!level) return false;
+
+        vector<PartyPtr> parties = level->getParties();
+        if(find(parties.begin(), parties.end(), Party::getPlayerParty()) != parties.end())
+        {
+            return false;
+        }
+
+        SaveWriter save;
+        save.beginSection(SAVE_LEVEL);
+        level->saveToDisk(save);
+        save.endSection();
+
+        vector<char>* packed = new vector<char>;
+        PackedLevelPtr owner(packed);
+        save.packSections(*packed, true);
+
+        grow(i + 1);
+        Slot& slot = slots[i];
+        slot.place = IN_MEMORY;
+        slot.packed = owner;
+        slot.size = packed->size();
+        slot.checked = save.isChecked();
+        slot.simulatedUntil = level->simulatedUntil;
+        level.reset();
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : InactiveLevels::evict
+        Description : Moves a parked level from memory to the swap file.
+        Inputs      : level number
+        Outputs     : None
+        Return      : bool (whether it was moved)
+    --------------------------------------------------------------------------------*/
+    bool InactiveLevels::evict(const size_t i)
+    {
+        Slot& slot = slots[i];
+        if(slot.place != IN_MEMORY) return false;
+
+        if(!swapFile) swapFile.reset(new SwapFile);
+        SwapExtentPtr extent = swapFile->write(*slot.packed);
+        if(!extent) return false;
+
+        slot.place = IN_SWAP_FILE;
+        slot.extent = extent;
+        slot.packed.reset();
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : InactiveLevels::restore
+        Description : Loads a level that isn't resident, from memory, the swap file
+                      or the save it was resumed from, and marks it used.  Once no
+                      level is left in that save, the save is let go.
+        Inputs      : level number
+        Outputs     : throws runtime_error if the level is damaged
+        Return      : LevelPtr
+    --------------------------------------------------------------------------------*/
+    LevelPtr InactiveLevels::restore(const size_t i)
+    {
+        Slot& slot = slots.at(i);
+        LevelPtr level;
+
+        switch(slot.place)
+        {
+            case IN_SAVE:
+                level = savedLevels->loadLevel(i);
+                break;
+
+            case IN_MEMORY:
+                level = unpackLevel(*slot.packed);
+                break;
+
+            case IN_SWAP_FILE:
+            {
+                vector<char> packed;
+                swapFile->read(*slot.extent, packed);
+                level = unpackLevel(packed);
+                break;
+            }
+
+            default:
+                throw runtime_error("level is already resident");
+        }
+
+        level->simulatedUntil = slot.simulatedUntil;
+
+        slot.place = RESIDENT;
+        slot.packed.reset();
+        slot.extent.reset();
+        slot.size = 0;
+        touch(i);
+
+        bool inSave = false;
+        for(size_t s=0; s<slots.size(); ++s)
+        {
+            inSave = inSave || slots[s].place == IN_SAVE;
+        }
+        if(!inSave) savedLevels.reset();
+
+        return level;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : InactiveLevels::takeSnapshot
+        Description : Returns a snapshot of a level that isn't resident.  Nothing is
+                      read until the snapshot is saved, which copies the level's
+                      section from wherever it is.
+        Inputs      : level number
+        Outputs     : None
+        Return      : LevelSnapshotPtr
+    --------------------------------------------------------------------------------*/
+    LevelSnapshotPtr InactiveLevels::takeSnapshot(const size_t i) const
+    {
+        const Slot& slot = slots.at(i);
+        function<void(vector<char>&)> copy;
+
+        switch(slot.place)
+        {
+            case IN_SAVE:
+            {
+                SavedLevelsPtr saved = savedLevels;
+                copy = [saved, i](vector<char>& contents) { saved->copyLevel(i, contents); };
+                return LevelSnapshotPtr(new LevelSnapshot(copy, saved->isChecked()));
+            }
+
+            case IN_MEMORY:
+            {
+                PackedLevelPtr packed = slot.packed;
+                copy = [packed](vector<char>& contents)
+                {
+                    SaveReader save(&(*packed)[0], packed->size());
+                    save.copySection(SAVE_LEVEL, contents);
+                };
+                break;
+            }
+
+            case IN_SWAP_FILE:
+            {
+                // holding the extent keeps it from being reused before the copy
+                SwapFilePtr swap = swapFile;
+                SwapExtentPtr extent = slot.extent;
+                copy = [swap, extent](vector<char>& contents)
+                {
+                    vector<char> packed;
+                    swap->read(*extent, packed);
+                    SaveReader save(&packed[0], packed.size());
+                    save.copySection(SAVE_LEVEL, contents);
+                };
+                break;
+            }
+
+            default:
+                throw runtime_error("level is resident");
+        }
+
+        return LevelSnapshotPtr(new LevelSnapshot(copy, slot.checked));
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : InactiveLevels::isChecked
+        Description : Returns whether a level that isn't resident is kept as a
+                      checked save.
+        Inputs      : level number
+        Outputs     : throws runtime_error if the level is resident
+        Return      : bool
+    --------------------------------------------------------------------------------*/
+    bool InactiveLevels::isChecked(const size_t i) const
+    {
+        const Slot& slot = slots.at(i);
+        switch(slot.place)
+        {
+            case IN_SAVE:
+                return savedLevels->isChecked();
+
+            case IN_MEMORY:
+            case IN_SWAP_FILE:
+                return slot.checked;
+
+            default:
+                throw runtime_error("level is resident");
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : InactiveLevels::memoryUsage
+        Description : Estimates the bytes held by the resident levels and by the
+                      levels parked in memory.
+        Inputs      : the level list
+        Outputs     : None
+        Return      : size_t
+    --------------------------------------------------------------------------------*/
+    size_t InactiveLevels::memoryUsage(const vector<LevelPtr>& levels) const
+    {
+        size_t bytes = 0;
+        for(size_t i=0; i<levels.size(); ++i)
+        {
+            if(levels[i]) bytes += levels[i]->memoryUsage();
+        }
+        for(size_t i=0; i<slots.size(); ++i)
+        {
+            if(slots[i].place == IN_MEMORY) bytes += slots[i].size;
+        }
+        return bytes;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : InactiveLevels::enforceBudget
+        Description : Brings the memory the levels hold under the budget, if it can.
+                      Resident levels other than the current one are parked first,
+                      least recently used first, then parked levels are moved to
+                      the swap file in the same order.  The current level always
+                      stays.
+        Inputs      : the level list, current level number
+        Outputs     : parked levels are reset in the list
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void InactiveLevels::enforceBudget(vector<LevelPtr>& levels, const size_t current)
+    {
+        grow(levels.size());
+        size_t used = memoryUsage(levels);
+        if(used <= budget) return;
+
+        vector< pair<unsigned long, size_t> > byAge;
+        for(size_t i=0; i<levels.size(); ++i)
+        {
+            if(i != current) byAge.push_back(make_pair(slots[i].lastUsed, i));
+        }
+        sort(byAge.begin(), byAge.end());
+
+        for(size_t k=0; k<byAge.size() && used > budget; ++k)
+        {
+            size_t i = byAge[k].second;
+            if(!levels[i]) continue;
+
+            size_t resident = levels[i]->memoryUsage();
+            if(park(i, levels[i])) used = used - resident + slots[i].size;
+        }
+
+        for(size_t k=0; k<byAge.size() && used > budget; ++k)
+        {
+            size_t i = byAge[k].second;
+            size_t packed = slots[i].size;
+            if(evict(i)) used -= packed;
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef RLNS_INACTIVELEVELS_HPP
+#define RLNS_INACTIVELEVELS_HPP
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "Level.hpp"
+#include "SaveFile.hpp"
+#include "SwapFile.hpp"
+#include "Types.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : InactiveLevels
+        Description : Keeps the memory held by levels the player isn't on within a
+                      budget.  A level the player leaves is parked: it is saved,
+                      deflated, into a one-level save held in memory, and the live
+                      level, with its light and pathing maps, is let go.  While the
+                      levels in memory take more than the budget, the ones used
+                      longest ago are parked, then written out to a swap file.  A
+                      parked level is loaded again when it is next needed.
+
+                      Levels of a resumed game that haven't been loaded yet stay in
+                      the save they came from, which counts for nothing.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class InactiveLevels
+    {
+        // Member Variables
+        public:
+            enum Place
+            {
+                RESIDENT,    // the level is live in Level::levels
+                IN_SAVE,     // not loaded yet from the save the game was resumed from
+                IN_MEMORY,   // parked
+                IN_SWAP_FILE // parked, then evicted
+            };
+
+        private:
+            typedef boost::shared_ptr<const std::vector<char> > PackedLevelPtr;
+
+            struct Slot
+            {
+                Place place;
+                PackedLevelPtr packed;        // IN_MEMORY
+                SwapExtentPtr extent;         // IN_SWAP_FILE
+                size_t size;                  // bytes packed, wherever they are
+                bool checked;                 // whether packed as a checked save
+                uint64_t simulatedUntil;      // the level's time isn't saved
+                unsigned long lastUsed;
+            };
+
+            std::vector<Slot> slots;
+            SavedLevelsPtr savedLevels;
+            SwapFilePtr swapFile;
+            size_t budget;
+            unsigned long clock;
+
+        // Member Functions
+        private:
+            void grow(const size_t);
+            bool evict(const size_t);
+
+        public:
+            InactiveLevels();
+
+            size_t getBudget() const         { return budget; }
+            void setBudget(const size_t b)   { budget = b; }
+
+            void clear();
+            void resume(const SavedLevelsPtr);
+            void touch(const size_t);
+
+            bool park(const size_t, LevelPtr&);
+            LevelPtr restore(const size_t);
+            LevelSnapshotPtr takeSnapshot(const size_t) const;
+            bool isChecked(const size_t) const;
+            Place getPlace(const size_t i) const
+            { return (i < slots.size()) ? slots[i].place : RESIDENT; }
+            long getSwapFileSize() const { return swapFile ? swapFile->getSize() : 0; }
+
+            size_t memoryUsage(const std::vector<LevelPtr>&) const;
+            void enforceBudget(std::vector<LevelPtr>&, const size_t);
+    };
+}
+
+#endif
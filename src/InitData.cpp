@@ -74,7 +74,7 @@ namespace rlns
     : rootWidth(0), rootHeight(0), rootTileWidth(0), rootTileHeight(0),
       gwWidth(0), gwHeight(0), gwTileWidth(0), gwTileHeight(0),
       commandLineHeight(0), font(""), fontWidth(0), fontHeight(0), fontgs(false),
-      fontLayout(""), mlgwRatio(0.0f), logSize(0) {}
+      fontLayout(""), mlgwRatio(0.0f), logSize(0), levelMemory(0) {}
 
 
 
@@ -174,6 +174,10 @@ namespace rlns
         if(value == "NOVALUE") error("LIGHTFLICKER");
         LIGHT_FLICKER_ENABLED = (value == "true") ? true : false;
 
+    // read LEVELMEMORY, which older init files don't have
+        value = readNextValue();
+        levelMemory = (value == "NOVALUE") ? 32768 : atoi(value.c_str());
+
         input.close();
 
         // now that FONTSIZE has been read, we can set the window tile lengths
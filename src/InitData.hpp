@@ -53,6 +53,7 @@ namespace rlns
             TCODColor UIBackColor;
 
             int logSize;        // how big the game's message log is
+            int levelMemory;    // how many KB the levels may hold in memory
 
             TCOD_renderer_t renderer; // which of the three libtcod renderers are used.
 
@@ -87,6 +88,7 @@ namespace rlns
             float getPWGWRatio()        const   { return pwgwRatio;      }
 
             int getLogSize()            const   { return logSize;        }
+            int getLevelMemory()        const   { return levelMemory;    }
 
             void readInitFile(const char*);
             void initRoot();
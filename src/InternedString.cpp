@@ -0,0 +1,52 @@
+#include "InternedString.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    // The pool is created on first use rather than as a global, since tiles and
+    // items may be built during static initialization of other files.  The set
+    // is node based, so pooled strings never move.
+    static unordered_set<string>& pool()
+    {
+        static unordered_set<string> strings;
+        return strings;
+    }
+
+    static mutex& poolLock()
+    {
+        static mutex lock;
+        return lock;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : InternedString::intern
+        Description : Returns the pooled copy of a string, adding it to the pool if
+                      it isn't there yet.
+        Inputs      : string
+        Outputs     : None
+        Return      : const string*
+    --------------------------------------------------------------------------------*/
+    const string* InternedString::intern(const string& s)
+    {
+        lock_guard<mutex> guard(poolLock());
+        return &*pool().insert(s).first;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : InternedString::poolSize
+        Description : Returns the number of distinct strings in the pool.
+        Inputs      : None
+        Outputs     : None
+        Return      : size_t
+    --------------------------------------------------------------------------------*/
+    size_t InternedString::poolSize()
+    {
+        lock_guard<mutex> guard(poolLock());
+        return pool().size();
+    }
+}
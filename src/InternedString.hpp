@@ -0,0 +1,50 @@
+#ifndef RLNS_INTERNEDSTRING_HPP
+#define RLNS_INTERNEDSTRING_HPP
+
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : InternedString
+        Description : An immutable string kept in a pool shared by the whole game.
+                      Equal strings are stored once, and an InternedString is only a
+                      pointer to the pooled copy, so the descriptions repeated across
+                      thousands of tiles and items cost one pointer each.  Interning
+                      takes a lock, so strings can be made from any thread; reading
+                      one needs none.  Pooled strings live until the program exits.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class InternedString
+    {
+        // Member Variables
+        private:
+            const std::string* str;
+
+        // Member Functions
+        private:
+            static const std::string* intern(const std::string&);
+
+        public:
+            InternedString(): str(intern(std::string())) {}
+            InternedString(const std::string& s): str(intern(s)) {}
+            InternedString(const char* s): str(intern(std::string(s))) {}
+
+            const std::string& get() const { return *str; }
+            operator const std::string&() const { return *str; }
+            const char* c_str() const { return str->c_str(); }
+            bool empty() const { return str->empty(); }
+
+            // pooled strings are unique, so comparing the pointers is enough
+            bool operator==(const InternedString& other) const { return str == other.str; }
+            bool operator!=(const InternedString& other) const { return str != other.str; }
+
+            static size_t poolSize();
+    };
+}
+
+#endif
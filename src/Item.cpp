@@ -0,0 +1,154 @@
+#include "Item.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    vector<ItemTypePtr> ItemType::list;
+
+    /*--------------------------------------------------------------------------------
+        Function    : ItemType::findType
+        Description : Finds the item type with the given name.
+        Inputs      : name of the item type
+        Outputs     : possible error message and abort
+        Return      : ItemTypePtr
+    --------------------------------------------------------------------------------*/
+    ItemTypePtr ItemType::findType(const string& typeName)
+    {
+        getDefault(); // make sure the built in types are listed
+
+        InternedString name(typeName);
+        for(size_t i=0; i<list.size(); ++i)
+        {
+            if(list[i]->name == name) return list[i];
+        }
+
+        fatalError("Item type '" + typeName + "' not found!");
+        return ItemTypePtr();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : ItemType::getDefault
+        Description : Returns the placeholder item type used until items are read
+                      from a datafile, adding it to the list the first time.
+        Inputs      : None
+        Outputs     : None
+        Return      : ItemTypePtr
+    --------------------------------------------------------------------------------*/
+    ItemTypePtr ItemType::getDefault()
+    {
+        // a local static is created exactly once, even if the first items are
+        // made on several threads at the same time
+        static ItemTypePtr macguffin = addType(ItemTypePtr(
+            new ItemType("Macguffin", '*', TCODColor::white, TCODColor::fuchsia,
+                         "a macguffin", "a valuable macguffin")));
+        return macguffin;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : ItemType::addType
+        Description : Adds an item type to the list.
+        Inputs      : ItemTypePtr
+        Outputs     : None
+        Return      : ItemTypePtr (the type added)
+    --------------------------------------------------------------------------------*/
+    ItemTypePtr ItemType::addType(const ItemTypePtr type)
+    {
+        list.push_back(type);
+        return type;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Item::saveList
+        Description : Saves a list of items.  The names of the item types used are
+                      written once, then the items as four blocks: type, count, x
+                      and y.
+        Inputs      : save file, items
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Item::saveList(SaveWriter& save, const vector<ItemPtr>& items)
+    {
+        map<const ItemType*, uint16_t> typeIndex;
+        vector<const ItemType*> types;
+        vector<uint16_t> itemTypes;
+        vector<uint32_t> counts;
+        vector<int32_t> xs, ys;
+
+        for(size_t i=0; i<items.size(); ++i)
+        {
+            const Item& item = *items[i];
+            map<const ItemType*, uint16_t>::iterator it = typeIndex.find(item.type);
+            if(it == typeIndex.end())
+            {
+                it = typeIndex.insert(make_pair(item.type, types.size())).first;
+                types.push_back(item.type);
+            }
+
+            itemTypes.push_back(it->second);
+            counts.push_back(item.count);
+            xs.push_back(item.getPosition().X());
+            ys.push_back(item.getPosition().Y());
+        }
+
+        save.put<uint32_t>(types.size());
+        for(size_t i=0; i<types.size(); ++i)
+        {
+            save.putString(types[i]->getName());
+        }
+        save.putBlock(itemTypes);
+        save.putBlock(counts);
+        save.putBlock(xs);
+        save.putBlock(ys);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Item::loadList
+        Description : Loads a list of items written by saveList.
+        Inputs      : save file, vector to fill, arena to allocate the items from
+        Outputs     : the items are appended; throws runtime_error if the list is
+                      damaged
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Item::loadList(SaveReader& save, vector<ItemPtr>& items, const ArenaPtr& arena)
+    {
+        vector<ItemTypePtr> types(save.get<uint32_t>());
+        for(size_t i=0; i<types.size(); ++i)
+        {
+            types[i] = ItemType::findType(save.getString());
+        }
+
+        vector<uint16_t> itemTypes;
+        vector<uint32_t> counts;
+        vector<int32_t> xs, ys;
+        save.getBlock(itemTypes);
+        save.getBlock(counts);
+        save.getBlock(xs);
+        save.getBlock(ys);
+
+        size_t n = itemTypes.size();
+        if(counts.size() != n || xs.size() != n || ys.size() != n)
+        {
+            throw runtime_error("save file is damaged");
+        }
+
+        items.reserve(items.size() + n);
+        for(size_t i=0; i<n; ++i)
+        {
+            if(itemTypes[i] >= types.size())
+            {
+                throw runtime_error("save file is damaged");
+            }
+            items.push_back(allocatePooled<Item>(arena, "Item", types[itemTypes[i]],
+                                                Point(xs[i], ys[i]), counts[i]));
+        }
+    }
+}
@@ -1,17 +1,82 @@
 #ifndef RLNS_ITEM_HPP
 #define RLNS_ITEM_HPP
 
+#include <map>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
+#include "InternedString.hpp"
 #include "MapObject.hpp"
 #include "Point.hpp"
+#include "Pool.hpp"
+#include "SaveFile.hpp"
+#include "Types.hpp"
+#include "Utility.hpp"
+
+#include "libtcod.hpp"
 
 namespace rlns
 {
+        /*--------------------------------------------------------------------------------
+            Class       : ItemType
+            Description : The data shared by every item of one kind: its name, how it
+                          looks and how it is described.  Items point to their type
+                          instead of carrying copies, so a level full of items only
+                          pays for positions and counts.  Types are kept in the list
+                          for the whole game, so items may hold plain pointers to
+                          them.
+            Parents     : None
+            Children    : None
+            Friends     : None
+        --------------------------------------------------------------------------------*/
+        class ItemType
+        {
+            // Member Variables
+            public:
+                static std::vector<ItemTypePtr> list;
+
+            private:
+                InternedString name;
+                int character;
+                TCODColor fgColor;
+                TCODColor bgColor;
+                InternedString shortdesc;
+                InternedString longdesc;
+
+            // Member Functions
+            private:
+                static ItemTypePtr addType(const ItemTypePtr);
+
+            public:
+                ItemType(const InternedString& n,
+                         const int c,
+                         const TCODColor& fg,
+                         const TCODColor& bg,
+                         const InternedString& sd,
+                         const InternedString& ld)
+                : name(n), character(c), fgColor(fg), bgColor(bg),
+                  shortdesc(sd), longdesc(ld) {}
+
+                const InternedString& getName() const      { return name;      }
+                int getChar() const                        { return character; }
+                TCODColor getFgColor() const               { return fgColor;   }
+                TCODColor getBgColor() const               { return bgColor;   }
+                const InternedString& getShortDesc() const { return shortdesc; }
+                const InternedString& getLongDesc() const  { return longdesc;  }
+
+                static ItemTypePtr findType(const std::string&);
+                static ItemTypePtr getDefault();
+        };
+
+
+
         /*--------------------------------------------------------------------------------
             Class       : Item
             Description : Base class for all of the various items in the game.  Defines
-                          all of the common item functionality.
+                          all of the common item functionality.  What every item of a
+                          kind has in common lives in its ItemType; an Item only adds
+                          its position and how many there are.
             Parents     : MapObject
             Children    : Weapon, Armor, etc.
             Friends     : None
@@ -20,22 +85,32 @@ namespace rlns
         {
             // Member Variables
             private:
-                std::string name;
+                const ItemType* type;
                 unsigned int count;
 
             // Member Functions
             public:
+                Item(const ItemTypePtr& t, const Point& pos, const unsigned int n = 1)
+                : MapObject(t->getChar(), t->getFgColor(), t->getBgColor(),
+                            t->getShortDesc(), t->getLongDesc(), pos),
+                  type(t.get()), count(n) {}
+
                 // temporary constructor
                 Item(const Point& pos)
-                : MapObject('*', TCODColor::white, TCODColor::fuchsia,
-                               "a macguffin", "a valuable macguffin", pos),
-                  name("Macguffin"), count(1) {}
+                : Item(ItemType::getDefault(), pos) {}
 
-                std::string getName() const 
-                { return name; }
+                const ItemType& getType() const
+                { return *type; }
+
+                const std::string& getName() const 
+                { return type->getName(); }
 
                 unsigned int getCount() const
                 { return count; }
+
+                static void saveList(SaveWriter&, const std::vector<ItemPtr>&);
+                static void loadList(SaveReader&, std::vector<ItemPtr>&,
+                                     const ArenaPtr& = Arena::global());
         };
 }
 
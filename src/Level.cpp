@@ -1,4 +1,7 @@
 #include "Level.hpp"
+#include "InactiveLevels.hpp"
+#include "LevelSimulator.hpp"
+#include "TurnPipeline.hpp"
 
 using namespace std;
 
@@ -6,6 +9,14 @@ namespace rlns
 {
     vector<LevelPtr> Level::levels;
     unsigned int Level::currentLevel = 0;
+    InactiveLevels Level::inactive;
+    uint64_t Level::worldTime = 0;
+    size_t Level::nextSimulated = 0;
+    uint32_t Level::gameSeed = 0;
+
+    // tiles around the player's party kept in memory on a streamed map, more
+    // than half the playfield, so the view never waits on a chunk
+    static const int FOCUS_RADIUS = 48;
 
     /*--------------------------------------------------------------------------------
         Function    : Level::Level
@@ -16,29 +27,35 @@ namespace rlns
         Return      : None (constructor)
     --------------------------------------------------------------------------------*/
     Level::Level(const string& tilesetName)
-    : map(new Map(Tileset::findTileset(tilesetName)))
+    : Level(tilesetName, Random::stream(STREAM_GENERATION).getInt(0, 0x7FFFFFFF)) {}
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::Level(string, uint32_t)
+        Description : Generates a level from the given seed.  The same tileset and
+                      seed always give the same map and items.
+        Inputs      : Name of a tileset, seed
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    Level::Level(const string& tilesetName, const uint32_t seed)
+    : map(new Map(Tileset::findTileset(tilesetName))), arena(new Arena), simulatedUntil(worldTime)
     {
-        if(tilesetName == "Castle")
-        {
-            DungeonBuilder dungeonBuilder(map);
-            dungeonBuilder.buildMap();
-            areas = dungeonBuilder.getAreas();
-        }
-        else if(tilesetName == "Cavern")
-        {
-            CaveBuilder caveBuilder(map);
-            caveBuilder.buildMap();
-            areas = caveBuilder.getAreas();
-        }
+        MapBuilderPtr builder = GeneratorRegistry::createBuilder(map);
+        builder->setSeed(seed);
+        builder->buildMap();
+        areas = builder->getAreas();
 
         // add items
-        RoomFiller roomFiller(map, 1);
+        RoomFiller roomFiller(map, 1, seed, arena);
         vector<AreaPtr>::const_iterator it, end;
         it = areas.begin(); end = areas.end();
         for(; it!=end; ++it)
         {
             items.push_back(roomFiller.genItem(*it));
         }
+        map->trim();
     }
 
 
@@ -51,7 +68,97 @@ namespace rlns
         Return      : None (constructor)
     --------------------------------------------------------------------------------*/
     Level::Level(RLNSZip& zip)
-    : map(new Map(zip)) {}
+    : map(new Map(zip)), arena(new Arena), simulatedUntil(worldTime) {}
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::Level(SaveReader&)
+        Description : Loads a level written by saveToDisk(SaveWriter&).  The player's
+                      party becomes the player party again, and the open cells of
+                      the areas are found on the map as loaded.
+        Inputs      : save file
+        Outputs     : throws runtime_error if the level is damaged
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    Level::Level(SaveReader& save)
+    : map(new Map(save)), arena(new Arena), simulatedUntil(worldTime)
+    {
+        save.beginSection(SAVE_ITEMS);
+        Item::loadList(save, items, arena);
+        save.endSection();
+
+        save.beginSection(SAVE_PARTIES);
+        size_t numParties = save.get<uint32_t>();
+        for(size_t i=0; i<numParties; ++i)
+        {
+            bool isPlayerParty = save.get<uint8_t>() != 0;
+            PartyPtr party(new Party(save));
+            if(isPlayerParty) Party::setPlayerParty(party);
+            parties.push_back(party);
+        }
+        save.endSection();
+
+        save.beginSection(SAVE_AREAS);
+        vector<int32_t> lefts, tops, rights, bottoms;
+        save.getBlock(lefts);
+        save.getBlock(tops);
+        save.getBlock(rights);
+        save.getBlock(bottoms);
+        if(tops.size() != lefts.size() || rights.size() != lefts.size() || bottoms.size() != lefts.size())
+        {
+            throw runtime_error("save file is damaged");
+        }
+        int width = map->getWidth(), height = map->getHeight();
+        for(size_t i=0; i<lefts.size(); ++i)
+        {
+            // an area may overhang the map by its wall ring, but no further
+            Point tl(lefts[i], tops[i]), br(rights[i], bottoms[i]);
+            if(tl.X() < -1 || tl.Y() < -1 || br.X() < tl.X() || br.Y() < tl.Y() ||
+               br.X() > width || br.Y() > height)
+            {
+                throw runtime_error("save file is damaged");
+            }
+
+            AreaPtr area = allocatePooled<Area>(Arena::global(), "Area", tl, br);
+            area->findOpenCells(map);
+            map->trim();
+            areas.push_back(area);
+        }
+        save.endSection();
+
+        // levels without entities have no entity section
+        if(!save.atSectionEnd() && save.peekSection() == SAVE_ENTITIES)
+        {
+            entities = EntityStore(save);
+        }
+
+        // the schedule isn't saved; everyone with a speed acts on the first tick
+        for(size_t i=0; i<entities.speeds.size(); ++i)
+        {
+            scheduler.schedule(entities.entityAt(entities.speeds.ownerAt(i)), 0);
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::updateOpenCells
+        Description : Tells every area containing the given point that the map has
+                      changed there, so their open cell lists stay current.
+        Inputs      : Point where the map was edited
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Level::updateOpenCells(const Point& pt)
+    {
+        vector<AreaPtr>::const_iterator it, end;
+        it = areas.begin(); end = areas.end();
+        for(; it!=end; ++it)
+        {
+            (*it)->updateOpenCell(map, pt);
+        }
+    }
 
 
 
@@ -204,16 +311,472 @@ namespace rlns
 
 
 
+    /*--------------------------------------------------------------------------------
+        Function    : Level::saveToDisk(SaveWriter&)
+        Description : Saves the level's map, items, parties, areas and entities,
+                      each in its own section.
+        Inputs      : save file
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Level::saveToDisk(SaveWriter& save) const
+    {
+        takeSnapshot()->saveToDisk(save);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::takeSnapshot
+        Description : Returns a snapshot of the level that can be saved later, from
+                      any thread.
+        Inputs      : None
+        Outputs     : None
+        Return      : LevelSnapshotPtr
+    --------------------------------------------------------------------------------*/
+    LevelSnapshotPtr Level::takeSnapshot() const
+    {
+        return LevelSnapshotPtr(new LevelSnapshot(map->takeSnapshot(), areas, items, parties, entities));
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::runUntilPlayer
+        Description : The player's party has just taken an action of the given
+                      cost.  Every entity due to act before the party's next turn
+                      takes its turn, a tick at a time through the TurnPipeline,
+                      and is scheduled again by its speed.  Entities destroyed
+                      while waiting are dropped.  World time moves on by the
+                      party's delay, and the level is up to date with it.  The
+                      map is trimmed after every tick and, at the end, focused on
+                      the party.
+        Inputs      : cost of the party's action
+        Outputs     : None
+        Return      : size_t (number of turns taken)
+    --------------------------------------------------------------------------------*/
+    size_t Level::runUntilPlayer(const unsigned int cost)
+    {
+        unsigned int ticks = Scheduler::delay(cost, Scheduler::NORMAL_SPEED);
+        scheduler.schedule(Scheduler::PLAYER, ticks);
+        worldTime += ticks;
+        simulatedUntil = worldTime;
+
+        size_t turns = 0;
+        bool playerDue = false;
+        vector<Entity> due, batch;
+        vector<Intent> intents;
+        TurnPipeline::Occupancy occupied;
+        TurnPipeline::findOccupied(*this, occupied);
+        while(!playerDue && scheduler.popTick(due) > 0)
+        {
+            batch.clear();
+            for(size_t i=0; i<due.size(); ++i)
+            {
+                if(due[i] == Scheduler::PLAYER) playerDue = true;
+                else if(entities.isAlive(due[i]) && entities.speeds.has(due[i].index)) batch.push_back(due[i]);
+            }
+
+            TurnPipeline::decide(*this, batch, scheduler.getTime(), intents);
+            TurnPipeline::commit(*this, intents, occupied);
+            map->trim();
+
+            for(size_t i=0; i<batch.size(); ++i)
+            {
+                unsigned int speed = entities.speeds.get(batch[i].index);
+                scheduler.schedule(batch[i], Scheduler::delay(Scheduler::NORMAL_COST, speed));
+            }
+            turns += batch.size();
+        }
+
+        focusOnParty();
+        return turns;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::focusOnParty
+        Description : Keeps the part of a streamed map around the player's party,
+                      which the camera follows, in memory, and lets the rest go
+                      back to the swap file or be generated again later.
+        Inputs      : None
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Level::focusOnParty()
+    {
+        vector<Point> points;
+        PartyPtr party = Party::getPlayerParty();
+        if(party && find(parties.begin(), parties.end(), party) != parties.end())
+        {
+            vector<ActorPtr> members = party->getMembers();
+            for(size_t m=0; m<members.size(); ++m)
+            {
+                points.push_back(members[m]->getPosition());
+            }
+        }
+        map->focusOn(points, FOCUS_RADIUS);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::memoryUsage
+        Description : Estimates the bytes the level holds on to.  The map is nearly
+                      all of it; items are counted by the slabs of the level's
+                      arena, areas and parties by their number.
+        Inputs      : None
+        Outputs     : None
+        Return      : size_t
+    --------------------------------------------------------------------------------*/
+    size_t Level::memoryUsage() const
+    {
+        return sizeof(*this) + map->memoryUsage()
+             + areas.size() * sizeof(Area)
+             + arena->memoryUsage()
+             + parties.size() * sizeof(Party)
+             + entities.memoryUsage();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : LevelSnapshot::LevelSnapshot
+        Description : Copies a level's items, parties and entities, noting which
+                      party is the player's.
+        Inputs      : map snapshot, areas, items, parties, entities
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    LevelSnapshot::LevelSnapshot(const MapSnapshotPtr m, const vector<AreaPtr>& a,
+                                 const vector<ItemPtr>& i, const vector<PartyPtr>& p,
+                                 const EntityStore& e)
+    : map(m), areas(a), sourceChecked(false)
+    {
+        if(e.capacity() > 0) entities = e.takeSnapshot();
+
+        for(size_t j=0; j<i.size(); ++j)
+        {
+            items.push_back(allocatePooled<Item>(Arena::global(), "Item", *i[j]));
+        }
+
+        for(size_t j=0; j<p.size(); ++j)
+        {
+            parties.push_back(p[j]->takeSnapshot());
+            isPlayerParty.push_back(p[j] == Party::getPlayerParty());
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : LevelSnapshot::LevelSnapshot(function, bool)
+        Description : Stands for a level that isn't resident.  Nothing is read until
+                      the snapshot is saved, when the given function copies the
+                      level's section contents.
+        Inputs      : function copying the level's contents, whether they come from
+                      a checked save
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    LevelSnapshot::LevelSnapshot(const function<void(vector<char>&)>& copy, const bool checked)
+    : copyContents(copy), sourceChecked(checked) {}
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : LevelSnapshot::saveToDisk
+        Description : Saves the level's map, items, parties, areas and entities,
+                      each in its own section.  A level that isn't resident is copied from
+                      wherever it is.  Reads nothing but the snapshot, so it may
+                      run on any thread.
+        Inputs      : save file
+        Outputs     : throws runtime_error if a level to copy is damaged or kept
+                      in the other kind of save
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void LevelSnapshot::saveToDisk(SaveWriter& save) const
+    {
+        if(copyContents)
+        {
+            vector<char> contents;
+            copyContents(contents);
+
+            // takeSnapshots() loads levels of the other kind, so this only
+            // ever copies
+            if(sourceChecked != save.isChecked())
+            {
+                throw runtime_error("level snapshot doesn't match the kind of save");
+            }
+            save.putContents(contents);
+            return;
+        }
+
+        map->saveToDisk(save);
+
+        save.beginSection(SAVE_ITEMS);
+        Item::saveList(save, items);
+        save.endSection();
+
+        save.beginSection(SAVE_PARTIES);
+        save.put<uint32_t>(parties.size());
+        for(size_t i=0; i<parties.size(); ++i)
+        {
+            save.put<uint8_t>(isPlayerParty[i]);
+            parties[i]->saveToDisk(save);
+        }
+        save.endSection();
+
+        save.beginSection(SAVE_AREAS);
+        vector<int32_t> lefts, tops, rights, bottoms;
+        for(size_t i=0; i<areas.size(); ++i)
+        {
+            lefts.push_back(areas[i]->getTL().X());
+            tops.push_back(areas[i]->getTL().Y());
+            rights.push_back(areas[i]->getBR().X());
+            bottoms.push_back(areas[i]->getBR().Y());
+        }
+        save.putBlock(lefts);
+        save.putBlock(tops);
+        save.putBlock(rights);
+        save.putBlock(bottoms);
+        save.endSection();
+
+        if(entities) entities->saveToDisk(save);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SavedLevels::SavedLevels
+        Description : Opens a save and finds its levels.  No level is read yet.
+        Inputs      : file name
+        Outputs     : throws runtime_error if the file can't be read or is damaged
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    SavedLevels::SavedLevels(const string& filename)
+    : file(filename)
+    {
+        if(!file.isOpen())
+        {
+            throw runtime_error("can't open " + filename);
+        }
+
+        SaveReader save(file.begin(), file.size());
+        checked = save.isChecked();
+
+        save.beginSection(SAVE_GAME);
+        currentLevel = save.get<uint32_t>();
+        size_t numLevels = save.get<uint32_t>();
+        save.endSection();
+
+        save.findSections(SAVE_LEVEL, offsets);
+        if(offsets.size() != numLevels || currentLevel >= numLevels)
+        {
+            throw runtime_error("save file is damaged");
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SavedLevels::loadLevel
+        Description : Reads one level from the save.
+        Inputs      : level number
+        Outputs     : throws runtime_error if the level is damaged
+        Return      : LevelPtr
+    --------------------------------------------------------------------------------*/
+    LevelPtr SavedLevels::loadLevel(const size_t i) const
+    {
+        SaveReader save(file.begin(), file.size());
+        save.seek(offsets.at(i));
+        save.beginSection(SAVE_LEVEL);
+        LevelPtr level(new Level(save));
+        save.endSection();
+        return level;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SavedLevels::copyLevel
+        Description : Copies one level's section, inflated but not interpreted.
+        Inputs      : level number, vector to fill
+        Outputs     : the level's section contents; throws runtime_error if the
+                      level is damaged
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void SavedLevels::copyLevel(const size_t i, vector<char>& contents) const
+    {
+        SaveReader save(file.begin(), file.size());
+        save.seek(offsets.at(i));
+        save.copySection(SAVE_LEVEL, contents);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::getLevel
+        Description : Returns the given level, bringing it back from wherever it was
+                      put if it isn't resident.
+        Inputs      : level number
+        Outputs     : throws runtime_error if the level is damaged
+        Return      : LevelPtr
+    --------------------------------------------------------------------------------*/
+    LevelPtr Level::getLevel(const size_t i)
+    {
+        LevelPtr& level = levels.at(i);
+        if(!level) level = inactive.restore(i);
+        return level;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::leaveLevel
+        Description : Called once the player has moved to another level.  The level
+                      left is parked, and the levels are brought back under the
+                      memory budget.
+        Inputs      : number of the level left
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Level::leaveLevel(const size_t left)
+    {
+        inactive.touch(currentLevel);
+        if(left != currentLevel) inactive.park(left, levels.at(left));
+        inactive.enforceBudget(levels, currentLevel);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::gotoLevel
+        Description : Makes the given level current, loading it if needed and
+                      catching it up with the time spent away from it.  The
+                      player's party goes with it, arriving on the up stair of a
+                      deeper level or the down stair of a shallower one.  The
+                      current level only changes once the new one is loaded, so
+                      if loading throws, the game stays where it was.
+        Inputs      : number of an existing level
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Level::gotoLevel(const size_t i)
+    {
+        LevelPtr level = getLevel(i);
+        LevelSimulator::catchUp(*level, worldTime, LevelSimulator::MAX_STEPS);
+
+        PartyPtr party = Party::getPlayerParty();
+        if(party)
+        {
+            if(levels.at(currentLevel)) levels[currentLevel]->removeParty(party);
+
+            Point arrival = (i > currentLevel) ? level->getUpStairLocation()
+                                               : level->getDownStairLocation();
+            vector<ActorPtr> members = party->getMembers();
+            for(size_t m=0; m<members.size(); ++m)
+            {
+                members[m]->setPosition(arrival);
+            }
+            level->addParty(party);
+        }
+        level->focusOnParty();
+
+        size_t left = currentLevel;
+        currentLevel = i;
+        leaveLevel(left);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::gotoNextLevel
+        Description : Makes the next level current, if there is one.
+        Inputs      : None
+        Outputs     : None
+        Return      : bool (false if this is the last level)
+    --------------------------------------------------------------------------------*/
+    bool Level::gotoNextLevel()
+    {
+        if(currentLevel + 1 >= levels.size()) return false;
+        gotoLevel(currentLevel + 1);
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::gotoPreviousLevel
+        Description : Makes the previous level current, if there is one.
+        Inputs      : None
+        Outputs     : None
+        Return      : bool (false if this is the first level)
+    --------------------------------------------------------------------------------*/
+    bool Level::gotoPreviousLevel()
+    {
+        if(currentLevel == 0) return false;
+        gotoLevel(currentLevel - 1);
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::simulateInactive
+        Description : The background tick, for after the player's turn.  The next
+                      resident level other than the current one that is at least
+                      a coarse step behind is brought up to date in one step.
+                      Parked levels are left alone; time only adds up for them
+                      until the player arrives.
+        Inputs      : None
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Level::simulateInactive()
+    {
+        for(size_t n=0; n<levels.size(); ++n)
+        {
+            size_t i = nextSimulated++ % levels.size();
+            const LevelPtr& level = levels[i];
+            if(i == currentLevel || !level) continue;
+            if(worldTime - level->simulatedUntil < LevelSimulator::COARSE_STEP) continue;
+
+            LevelSimulator::catchUp(*level, worldTime, 1);
+            return;
+        }
+    }
+
+
+
     /*--------------------------------------------------------------------------------
         Function    : Level::addLevel
-        Description : Adds a new level of the given tileset to the level list.
+        Description : Adds a new level of the given tileset to the level list.  Its
+                      seed comes from the game seed and the level's number, so a
+                      game started from the same seed has the same levels.
         Inputs      : Name of a tileset
         Outputs     : None
         Return      : void
     --------------------------------------------------------------------------------*/
     void Level::addLevel(const string& tilesetName)
     {
-        LevelPtr newLevel(new Level(tilesetName));
+        addLevel(tilesetName, gameSeed + static_cast<uint32_t>(levels.size()) * 0x9E3779B9u);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::addLevel(string, uint32_t)
+        Description : Adds a new level of the given tileset, generated from the
+                      given seed, to the level list.
+        Inputs      : Name of a tileset, seed
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Level::addLevel(const string& tilesetName, const uint32_t seed)
+    {
+        LevelPtr newLevel(new Level(tilesetName, seed));
         Level::levels.push_back(newLevel);
     }
 
@@ -230,13 +793,10 @@ namespace rlns
     {
         zip.putInt(Level::currentLevel);
 
-        vector<LevelPtr>::const_iterator it, end;
-        it = Level::levels.begin(); end = Level::levels.end();
-
         zip.putInt(Level::levels.size());
-        for(; it!=end; ++it)
+        for(size_t i=0; i<levels.size(); ++i)
         {
-            (*it)->saveToDisk(zip);
+            getLevel(i)->saveToDisk(zip);
         }
     }
 
@@ -260,4 +820,229 @@ namespace rlns
             levels.push_back(level);
         }
     }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::saveLevelsToDisk(SaveWriter&)
+        Description : Saves the current level number and every level, each level in
+                      a section of its own.
+        Inputs      : save file
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Level::saveLevelsToDisk(SaveWriter& save)
+    {
+        vector<LevelSnapshotPtr> snapshots;
+        takeSnapshots(snapshots, save.isChecked());
+        saveSnapshots(save, currentLevel, snapshots);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::takeSnapshots
+        Description : Takes a snapshot of every level, in order, for a save of the
+                      given kind.  Levels that aren't resident aren't loaded for
+                      it, unless they are kept in the other kind of save: those
+                      are loaded here, on the game thread, so that saving the
+                      snapshots never has to build a level, and parked again
+                      afterwards if they are over the budget.
+        Inputs      : vector to fill, whether the save will be checked
+        Outputs     : the snapshots
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Level::takeSnapshots(vector<LevelSnapshotPtr>& snapshots, const bool checked)
+    {
+        snapshots.reserve(snapshots.size() + levels.size());
+        bool loaded = false;
+        for(size_t i=0; i<levels.size(); ++i)
+        {
+            if(!levels[i] && inactive.isChecked(i) != checked)
+            {
+                getLevel(i);
+                loaded = true;
+            }
+
+            if(levels[i]) snapshots.push_back(levels[i]->takeSnapshot());
+            else snapshots.push_back(inactive.takeSnapshot(i));
+        }
+
+        if(loaded) inactive.enforceBudget(levels, currentLevel);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::saveSnapshots
+        Description : Saves the current level number and the level snapshots, each
+                      in a section of its own.  Only reads the snapshots, so it may
+                      run on any thread.
+        Inputs      : save file, current level number, level snapshots
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Level::saveSnapshots(SaveWriter& save, const unsigned int current,
+                              const vector<LevelSnapshotPtr>& snapshots)
+    {
+        save.beginSection(SAVE_GAME);
+        save.put<uint32_t>(current);
+        save.put<uint32_t>(snapshots.size());
+        save.endSection();
+
+        for(size_t i=0; i<snapshots.size(); ++i)
+        {
+            save.beginSection(SAVE_LEVEL);
+            snapshots[i]->saveToDisk(save);
+            save.endSection();
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::loadLevelsFromDisk(SaveReader&)
+        Description : Replaces the level list with the levels in the save.  Nothing
+                      is replaced unless the whole save loads.
+        Inputs      : save file
+        Outputs     : throws runtime_error if the save is damaged
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Level::loadLevelsFromDisk(SaveReader& save)
+    {
+        save.beginSection(SAVE_GAME);
+        unsigned int current = save.get<uint32_t>();
+        size_t numLevels = save.get<uint32_t>();
+        save.endSection();
+
+        if(current >= numLevels)
+        {
+            throw runtime_error("save file is damaged");
+        }
+
+        vector<LevelPtr> loaded;
+        for(size_t i=0; i<numLevels; ++i)
+        {
+            save.beginSection(SAVE_LEVEL);
+            loaded.push_back(LevelPtr(new Level(save)));
+            save.endSection();
+        }
+
+        levels.swap(loaded);
+        currentLevel = current;
+        inactive.clear();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::saveLevelsToFile
+        Description : Saves every level to the given file.
+        Inputs      : file name
+        Outputs     : None
+        Return      : bool (whether the file was written)
+    --------------------------------------------------------------------------------*/
+    bool Level::saveLevelsToFile(const string& filename)
+    {
+        SaveWriter save;
+        saveLevelsToDisk(save);
+        return save.saveToFile(filename);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::loadLevelsFromFile
+        Description : Resumes the levels saved in the given file.  Only the current
+                      level is loaded; the others are loaded when the player first
+                      reaches them, so resuming takes as long however deep the
+                      dungeon is.
+        Inputs      : file name
+        Outputs     : throws runtime_error if the file can't be read or is damaged
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Level::loadLevelsFromFile(const string& filename)
+    {
+        SavedLevelsPtr saved(new SavedLevels(filename));
+        LevelPtr current = saved->loadLevel(saved->getCurrentLevel());
+
+        levels.assign(saved->size(), LevelPtr());
+        levels[saved->getCurrentLevel()] = current;
+        currentLevel = saved->getCurrentLevel();
+        inactive.resume(saved);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::refreshTiles
+        Description : Brings every level up to date after the given tiles were
+                      reloaded.  Only the cells holding those tiles are recomputed,
+                      in the map and in the open cell lists of the areas; the maps
+                      themselves are left as they are.
+        Inputs      : IDs of the tiles whose blocking flags changed
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Level::refreshTiles(const vector<int>& ids)
+    {
+        if(ids.empty()) return;
+
+        vector<bool> changed(*max_element(ids.begin(), ids.end()) + 1, false);
+        for(size_t i=0; i<ids.size(); ++i)
+        {
+            changed[ids[i]] = true;
+        }
+
+        // levels that aren't resident pick up the new tiles when they are loaded
+        for(size_t i=0; i<levels.size(); ++i)
+        {
+            if(!levels[i]) continue;
+
+            vector<Point> refreshed;
+            levels[i]->map->refreshTiles(changed, refreshed);
+            for(size_t p=0; p<refreshed.size(); ++p)
+            {
+                levels[i]->updateOpenCells(refreshed[p]);
+            }
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::refreshLighting
+        Description : Resets the light maps of the levels built from the given
+                      tilesets, after their ambient light was reloaded.
+        Inputs      : tilesets whose ambient light changed
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Level::refreshLighting(const vector<TilesetPtr>& tilesets)
+    {
+        for(size_t i=0; i<levels.size(); ++i)
+        {
+            if(!levels[i]) continue;
+            if(find(tilesets.begin(), tilesets.end(), levels[i]->map->tileset) != tilesets.end())
+            {
+                levels[i]->map->refreshLighting();
+            }
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Level::setMemoryBudget
+        Description : Sets how many bytes the levels may hold in memory, and parks
+                      or evicts levels at once if they hold more.
+        Inputs      : budget in bytes
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Level::setMemoryBudget(const size_t bytes)
+    {
+        inactive.setBudget(bytes);
+        if(!levels.empty()) inactive.enforceBudget(levels, currentLevel);
+    }
 }
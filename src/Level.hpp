@@ -2,18 +2,25 @@
 #define RLNS_LEVEL_HPP
 
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include <iterator>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "Area.hpp"
 #include "CheckedSave.hpp"
-#include "CaveBuilder.hpp"
-#include "DungeonBuilder.hpp"
+#include "EntityStore.hpp"
+#include "GeneratorRegistry.hpp"
 #include "Item.hpp"
 #include "Map.hpp"
+#include "MappedFile.hpp"
+#include "Party.hpp"
+#include "Pool.hpp"
 #include "RoomFiller.hpp"
+#include "SaveFile.hpp"
+#include "Scheduler.hpp"
 #include "Tile.hpp"
 #include "Types.hpp"
 
@@ -34,13 +41,87 @@ namespace rlns
 
 
 
+    /*--------------------------------------------------------------------------------
+        Class       : LevelSnapshot
+        Description : A level as it was when the snapshot was taken, ready to be
+                      saved from another thread.  The map snapshot is shared with
+                      the live map until it changes, and the areas, whose bounds
+                      never change, with the live level; items, parties and
+                      entities are copied, since they change every turn.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class LevelSnapshot
+    {
+        // Member Variables
+        private:
+            MapSnapshotPtr map;
+            std::vector<AreaPtr> areas;
+            std::vector<ItemPtr> items;
+            std::vector<PartyPtr> parties;
+            std::vector<bool> isPlayerParty;
+            EntityStorePtr entities;
+
+            // a level that isn't resident is copied from wherever it was put,
+            // a save of the given kind
+            std::function<void(std::vector<char>&)> copyContents;
+            bool sourceChecked;
+
+        // Member Functions
+        public:
+            LevelSnapshot(const MapSnapshotPtr, const std::vector<AreaPtr>&,
+                          const std::vector<ItemPtr>&, const std::vector<PartyPtr>&,
+                          const EntityStore&);
+            LevelSnapshot(const std::function<void(std::vector<char>&)>&, const bool);
+
+            void saveToDisk(SaveWriter&) const;
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : SavedLevels
+        Description : A save file the levels were resumed from.  It stays open, with
+                      the offset of each level taken from the file's index, so that
+                      a level is only read when the player first reaches it.  It is
+                      only ever read, so levels may be loaded or copied from it on
+                      any thread.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class SavedLevels
+    {
+        // Member Variables
+        private:
+            MappedFile file;
+            std::vector<size_t> offsets;
+            unsigned int currentLevel;
+            bool checked;
+
+        // Member Functions
+        public:
+            SavedLevels(const std::string&);
+
+            size_t size() const { return offsets.size(); }
+            unsigned int getCurrentLevel() const { return currentLevel; }
+            bool isChecked() const { return checked; }
+
+            LevelPtr loadLevel(const size_t) const;
+            void copyLevel(const size_t, std::vector<char>&) const;
+    };
+
+
+
     /*--------------------------------------------------------------------------------
         Class       : Level
         Description : Contains a map, items, monsters, etc.  Also has a static vector
-                      containing all of the game's levels.
+                      containing all of the game's levels, of which only the ones
+                      in use are resident; the others are kept by InactiveLevels.
         Parents     : None
         Children    : None
-        Friends     : None
+        Friends     : InactiveLevels, LevelSimulator
     --------------------------------------------------------------------------------*/
     class Level
     {
@@ -52,32 +133,69 @@ namespace rlns
             // groups of players or monsters in the level
             std::vector<PartyPtr> parties; 
 
+            // the level's own items are allocated here and freed together
+            ArenaPtr arena;
+
             // items present
             std::vector<ItemPtr> items;
 
+            // actors and objects kept as components
+            EntityStore entities;
+
+            // who acts when, among the entities with a speed and the player's party
+            Scheduler scheduler;
+
+            // the world time this level has been brought up to
+            uint64_t simulatedUntil;
+
         // Static Variables
         private:
+            // levels that aren't resident are null, and kept by inactive
             static std::vector<LevelPtr> levels;
             static unsigned int currentLevel;
+            static InactiveLevels inactive;
+
+            // ticks passed on the levels the player has been on, not saved
+            static uint64_t worldTime;
+            static size_t nextSimulated; // the next level for simulateInactive()
+
+            // new levels are generated from seeds drawn from this
+            static uint32_t gameSeed;
 
         // Member Functions
         private:
-            Level() {}
+            Level() : simulatedUntil(worldTime) {}
+
+            void updateOpenCells(const Point&);
+            void focusOnParty();
+
+            static LevelPtr getLevel(const size_t);
+            static void leaveLevel(const size_t);
+            static void gotoLevel(const size_t);
 
         public:
             Level(const std::string&);
+            Level(const std::string&, const uint32_t);
             Level(RLNSZip&);
+            Level(SaveReader&);
 
             // Map Functions
             int getMapWidth()  const { return map->getWidth(); }
             int getMapHeight() const { return map->getHeight(); }
             TileInfo getTileInfo(const int, const int) const;
+            TilesetPtr getTileset() const { return map->getTileset(); }
+            const std::vector<int>& getTiles(const int x, const int y) const
+            { return map->at(x,y); }
             Point getUpStairLocation() const;
+            Point getDownStairLocation() const
+            { return map->getDownStairLocation(); }
             bool moveLegal(const Point&, const MovementType) const;
             int  signalTile(const Point&, const TileActionType);
+            const std::vector<AreaPtr>& getAreas() const { return areas; }
 
             // Party Functions
             void addParty(const PartyPtr);
+            void removeParty(const PartyPtr);
             std::vector<PartyPtr> getParties() const
             { return parties; }
 
@@ -89,17 +207,49 @@ namespace rlns
             std::vector<ItemPtr> fetchItemsAtLocation(const Point&);
             void inspectTileContents(std::string&, const Point&) const;
 
+            // Entity Functions
+            EntityStore& getEntities()             { return entities; }
+            const EntityStore& getEntities() const { return entities; }
+            size_t moveEntities() { return entities.move(*map); }
+            void scheduleEntity(const Entity e) { scheduler.schedule(e, 0); }
+            size_t runUntilPlayer(const unsigned int);
+
 
             void saveToDisk(RLNSZip&) const;
+            void saveToDisk(SaveWriter&) const;
+            LevelSnapshotPtr takeSnapshot() const;
+            size_t memoryUsage() const;
 
         // Static Functions
         public:
             static void addLevel(const std::string&);
-            static LevelPtr getCurrentLevel() { return levels.at(currentLevel); }
-            static void gotoNextLevel() { ++currentLevel; }
-            static void gotoPreviousLevel() { if(currentLevel > 0) --currentLevel; }
+            static void addLevel(const std::string&, const uint32_t);
+            static LevelPtr getCurrentLevel() { return getLevel(currentLevel); }
+            static unsigned int getCurrentLevelIndex() { return currentLevel; }
+            static size_t getNumLevels() { return levels.size(); }
+            static const InactiveLevels& getInactiveLevels() { return inactive; }
+            static bool gotoNextLevel();
+            static bool gotoPreviousLevel();
             static void saveLevelsToDisk(RLNSZip&);
             static void loadLevelsFromDisk(RLNSZip&);
+            static void saveLevelsToDisk(SaveWriter&);
+            static void takeSnapshots(std::vector<LevelSnapshotPtr>&,
+                                      const bool checked = SaveWriter::CHECKED_BY_DEFAULT);
+            static void saveSnapshots(SaveWriter&, const unsigned int,
+                                      const std::vector<LevelSnapshotPtr>&);
+            static void loadLevelsFromDisk(SaveReader&);
+            static bool saveLevelsToFile(const std::string&);
+            static void loadLevelsFromFile(const std::string&);
+            static void refreshTiles(const std::vector<int>&);
+            static void refreshLighting(const std::vector<TilesetPtr>&);
+            static void setMemoryBudget(const size_t);
+            static uint64_t getWorldTime() { return worldTime; }
+            static uint32_t getGameSeed() { return gameSeed; }
+            static void setGameSeed(const uint32_t s) { gameSeed = s; }
+            static void simulateInactive();
+
+            friend class InactiveLevels;
+            friend class LevelSimulator;
 
     };
 
@@ -116,6 +266,11 @@ namespace rlns
         parties.push_back(party);
     }
 
+    inline void Level::removeParty(const PartyPtr party)
+    {
+        parties.erase(std::remove(parties.begin(), parties.end(), party), parties.end());
+    }
+
     inline void Level::addItem(const ItemPtr item)
     {
         items.push_back(item);
@@ -128,7 +283,9 @@ namespace rlns
 
     inline int Level::signalTile(const Point& pt, const TileActionType signal)
     {
-        return map->signalTile(pt, signal);
+        bool changed = map->signalTile(pt, signal);
+        if(changed) updateOpenCells(pt);
+        return changed;
     }
 }
 
@@ -0,0 +1,203 @@
+#include <algorithm>
+
+#include "LevelSimulator.hpp"
+#include "Area.hpp"
+#include "Level.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    const unsigned int LevelSimulator::COARSE_STEP;
+    const size_t LevelSimulator::MAX_STEPS;
+    const unsigned int LevelSimulator::WANDER_TIME;
+    const size_t LevelSimulator::LINKS;
+
+    /*--------------------------------------------------------------------------------
+        Function    : distance2
+        Description : Returns the square of the distance between the centres of two
+                      areas, doubled so it stays whole.
+        Inputs      : two areas
+        Outputs     : None
+        Return      : long
+    --------------------------------------------------------------------------------*/
+    static long distance2(const Area& a, const Area& b)
+    {
+        long dx = (a.getTL().X() + a.getBR().X()) - (b.getTL().X() + b.getBR().X());
+        long dy = (a.getTL().Y() + a.getBR().Y()) - (b.getTL().Y() + b.getBR().Y());
+        return dx * dx + dy * dy;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : findArea
+        Description : Returns the first area containing the point, or if none does,
+                      the one whose centre is nearest to it.
+        Inputs      : areas (not empty), point
+        Outputs     : None
+        Return      : size_t
+    --------------------------------------------------------------------------------*/
+    static size_t findArea(const vector<AreaPtr>& areas, const Point& pt)
+    {
+        Area spot(pt, pt);
+        size_t nearest = 0;
+        long best = -1;
+        for(size_t a=0; a<areas.size(); ++a)
+        {
+            if(areas[a]->contains(pt)) return a;
+
+            long d = distance2(*areas[a], spot);
+            if(best < 0 || d < best)
+            {
+                best = d;
+                nearest = a;
+            }
+        }
+        return nearest;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : LevelSimulator::linkAreas
+        Description : Builds the area graph: each area leads to the few whose
+                      centres are nearest, and back.  The level keeps no record of
+                      which rooms its corridors join, so nearness stands in for it.
+        Inputs      : areas
+        Outputs     : the areas each area leads to, by index
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void LevelSimulator::linkAreas(const vector<AreaPtr>& areas, vector< vector<size_t> >& links)
+    {
+        links.assign(areas.size(), vector<size_t>());
+
+        vector< pair<long, size_t> > byDistance;
+        for(size_t a=0; a<areas.size(); ++a)
+        {
+            byDistance.clear();
+            for(size_t b=0; b<areas.size(); ++b)
+            {
+                if(b != a) byDistance.push_back(make_pair(distance2(*areas[a], *areas[b]), b));
+            }
+
+            size_t n = min(LINKS, byDistance.size());
+            partial_sort(byDistance.begin(), byDistance.begin() + n, byDistance.end());
+            for(size_t i=0; i<n; ++i)
+            {
+                size_t b = byDistance[i].second;
+                if(find(links[a].begin(), links[a].end(), b) == links[a].end()) links[a].push_back(b);
+                if(find(links[b].begin(), links[b].end(), a) == links[b].end()) links[b].push_back(a);
+            }
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : LevelSimulator::step
+        Description : Takes one coarse step covering the given ticks.  Entities with
+                      a speed and a position are grouped by area; each group may
+                      wander to a linked area, where its members are put in open
+                      cells.  Members of a group that stays keep their places unless
+                      they are outside the area.
+        Inputs      : level, area graph, ticks covered, random number generator
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void LevelSimulator::step(Level& level, const vector< vector<size_t> >& links, const uint64_t ticks,
+                              Random& rand)
+    {
+        const vector<AreaPtr>& areas = level.areas;
+        EntityStore& entities = level.entities;
+
+        vector< vector<uint32_t> > groups(areas.size());
+        vector<uint64_t> speeds(areas.size(), 0);
+        for(size_t i=0; i<entities.speeds.size(); ++i)
+        {
+            uint32_t slot = entities.speeds.ownerAt(i);
+            const Point* position = entities.positions.find(slot);
+            if(position == NULL) continue;
+
+            size_t a = findArea(areas, *position);
+            groups[a].push_back(slot);
+            speeds[a] += entities.speeds.at(i);
+        }
+
+        // a group at normal speed wanders once in WANDER_TIME ticks
+        const uint64_t wander = static_cast<uint64_t>(WANDER_TIME) * Scheduler::NORMAL_SPEED;
+        vector<uint32_t> placing;
+        vector<Point> points;
+        for(size_t a=0; a<areas.size(); ++a)
+        {
+            if(groups[a].empty()) continue;
+
+            size_t to = a;
+            uint64_t weight = ticks * (speeds[a] / groups[a].size());
+            if(!links[a].empty() &&
+               (weight >= wander || static_cast<uint64_t>(rand.getInt(0, wander - 1)) < weight))
+            {
+                to = links[a][rand.getInt(0, links[a].size() - 1)];
+            }
+
+            placing.clear();
+            for(size_t i=0; i<groups[a].size(); ++i)
+            {
+                uint32_t slot = groups[a][i];
+                if(to != a || !areas[a]->contains(entities.positions.get(slot))) placing.push_back(slot);
+            }
+            if(placing.empty()) continue;
+
+            areas[to]->getRandomOpenPoints(points, rand, placing.size());
+            if(points.empty()) continue;
+            for(size_t i=0; i<placing.size(); ++i)
+            {
+                entities.positions.get(placing[i]) = points[i % points.size()];
+            }
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : LevelSimulator::catchUp
+        Description : Brings a level up to the given time in at most the given
+                      number of steps, each covering at least COARSE_STEP ticks
+                      unless less time than that has passed.  The steps depend only
+                      on the level and the times, so catching up is repeatable.
+        Inputs      : level, time to bring it to, most steps to take
+        Outputs     : None
+        Return      : size_t (number of steps taken)
+    --------------------------------------------------------------------------------*/
+    size_t LevelSimulator::catchUp(Level& level, const uint64_t until, const size_t maxSteps)
+    {
+        if(until <= level.simulatedUntil || maxSteps == 0) return 0;
+
+        uint64_t elapsed = until - level.simulatedUntil;
+        if(level.areas.empty() || level.entities.speeds.empty())
+        {
+            level.simulatedUntil = until;
+            return 0;
+        }
+
+        vector< vector<size_t> > links;
+        linkAreas(level.areas, links);
+
+        uint32_t seed = static_cast<uint32_t>(level.simulatedUntil * 2654435761u) ^
+                        static_cast<uint32_t>(until) ^
+                        static_cast<uint32_t>(level.entities.capacity() * 40503u + level.areas.size());
+        Random rand(seed);
+
+        size_t steps = static_cast<size_t>(min<uint64_t>(maxSteps, max<uint64_t>(elapsed / COARSE_STEP, 1)));
+        for(size_t i=0; i<steps; ++i)
+        {
+            // the last step takes what doesn't divide evenly
+            uint64_t ticks = elapsed / steps;
+            if(i == steps - 1) ticks += elapsed % steps;
+            step(level, links, ticks, rand);
+        }
+
+        level.simulatedUntil = until;
+        return steps;
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef RLNS_LEVELSIMULATOR_HPP
+#define RLNS_LEVELSIMULATOR_HPP
+
+#include <vector>
+
+#include <stdint.h>
+
+#include "Random.hpp"
+#include "Scheduler.hpp"
+#include "Types.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : LevelSimulator
+        Description : Moves time on for a level the player isn't on.  Instead of
+                      taking every entity's turns, it takes a few coarse steps over
+                      the graph of the level's areas: the entities in an area move
+                      as a group, and a group may wander to a neighbouring area,
+                      more often the longer the step and the faster its members.
+                      Entities caught outside every area join the nearest one.  A
+                      catch-up takes at most a given number of steps however long
+                      the level was left, so arriving on it costs bounded time.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class LevelSimulator
+    {
+        // Member Variables
+        public:
+            static const unsigned int COARSE_STEP = 10 * Scheduler::NORMAL_COST; // fewest ticks a step covers
+            static const size_t MAX_STEPS = 8; // most steps a catch-up takes
+
+        private:
+            // ticks a group at normal speed stays in an area, on average
+            static const unsigned int WANDER_TIME = 20 * Scheduler::NORMAL_COST;
+            static const size_t LINKS = 3; // nearest areas each area leads to
+
+        // Member Functions
+        private:
+            static void linkAreas(const std::vector<AreaPtr>&, std::vector< std::vector<size_t> >&);
+            static void step(Level&, const std::vector< std::vector<size_t> >&, const uint64_t,
+                             Random&);
+
+        public:
+            static size_t catchUp(Level&, const uint64_t, const size_t);
+    };
+}
+
+#endif
@@ -1,3 +1,4 @@
+#include "GeneratorRegistry.hpp"
 #include "Map.hpp"
 
 using namespace std;
@@ -5,30 +6,36 @@ using namespace std;
 namespace rlns
 {
     /*--------------------------------------------------------------------------------
-        Function    : Map::updateTileCoordinate
-        Description : Updates the pathing and lighting information at the given
-                      coordinate
-        Inputs      : coordinate to update
+        Function    : Map::setUpChunks
+        Description : Sizes the chunk table for the tileset.  A map that isn't
+                      streamed holds every chunk, filled with the filler tile, from
+                      the start; a streamed one makes them as they are used.
+        Inputs      : None
         Outputs     : None
         Return      : void
     --------------------------------------------------------------------------------*/
-    void Map::updateTileCoordinate(const int x, const int y)
+    void Map::setUpChunks()
     {
-        bool isTransparent = true;
-        bool isWalkable = true;
-
-        vector<int> tiles = at(x,y);
-        vector<int>::const_iterator it, end;
-        it = tiles.begin(); end = tiles.end();
-
-        for(; it!=end; ++it)
+        width = tileset->getMapWidth();
+        height = tileset->getMapHeight();
+        chunksHigh = (height + MapChunk::SIZE - 1) / MapChunk::SIZE;
+        size_t numChunks = ((width + MapChunk::SIZE - 1) / MapChunk::SIZE) * chunksHigh;
+
+        streamed = GeneratorRegistry::isStreamed(tileset->getType());
+        chunks.assign(numChunks, MapChunkPtr());
+        lastUsed.assign(numChunks, 0);
+        swapped.assign(numChunks, SwapExtentPtr());
+        pinned.assign(numChunks, false);
+        numResident = 0;
+
+        if(!streamed)
         {
-            TilePtr tile = Tile::findTile(*it);
-            isTransparent = isTransparent && !tile->blocksLight();
-            isWalkable = isWalkable && !tile->blocksWalking();
+            for(size_t i=0; i<numChunks; ++i)
+            {
+                chunks[i] = makeChunk(i);
+            }
+            numResident = numChunks;
         }
-
-        pathingMap.setProperties(x,y, isTransparent, isWalkable);
     }
 
 
@@ -41,60 +48,483 @@ namespace rlns
         Return      : None (constructor)
     --------------------------------------------------------------------------------*/
     Map::Map(const TilesetPtr t)
-    : tileset(t),
-      lightMap(tileset->getMapWidth()*2, tileset->getMapHeight()*2),
-      pathingMap(tileset->getMapWidth(), tileset->getMapHeight()),
-      tileMap(tileset->getMapWidth(), 
-              vector< vector<int> >(tileset->getMapHeight(), 
-                                    vector<int>(1, t->getFillerTileID())))
+    : tileset(t), width(0), height(0), chunksHigh(0), streamed(false), seed(0),
+      numResident(0), clock(0), revision(0), snapshotRevision(0)
     {
-        lightMap.clear(tileset->getAmbientLight());
+        setUpChunks();
     }
 
 
 
     /*--------------------------------------------------------------------------------
         Function    : Map::Map(RLNSZip&)
-        Description : Creates a Map object from the given save buffer.
+        Description : Creates a Map object from the given save buffer.  Every cell
+                      is read; on a streamed map the chunks are written out to the
+                      swap file as they fill up.
         Inputs      : RLNSZip save buffer
         Outputs     : None
         Return      : None (constructor)
     --------------------------------------------------------------------------------*/
     Map::Map(RLNSZip& zip)
-    : tileset(Tileset::findTileset(zip.getString())),
-      lightMap(tileset->getMapWidth(), tileset->getMapHeight()),
-      pathingMap(tileset->getMapWidth(), tileset->getMapHeight()),
-      tileMap(tileset->getMapWidth(), 
-              vector< vector<int> >(tileset->getMapHeight(), vector<int>()))
-    {
-        // load tileMap
-        int width = tileset->getMapWidth();
-        int height = tileset->getMapHeight();
+    : tileset(Tileset::findTileset(zip.getString())), width(0), height(0), chunksHigh(0),
+      streamed(false), seed(0), numResident(0), clock(0), revision(0), snapshotRevision(0)
+    {
+        setUpChunks();
+
+        // load the tiles
+        vector<int> tiles;
         for(int x=0; x<width; ++x)
         {
             for(int y=0; y<height; ++y)
             {
                 int numTiles = zip.getInt();
+                tiles.clear();
                 for(int z=0; z<numTiles; ++z)
                 {
-                    addFeature(x,y, zip.getInt());
+                    tiles.push_back(zip.getInt());
                 }
+                if(!tiles.empty()) fetch(x,y).setTiles(x,y, tiles);
             }
+            trim();
         }
+
+        upStairLocation.setX(zip.getInt());
+        upStairLocation.setY(zip.getInt());
+        downStairLocation.setX(zip.getInt());
+        downStairLocation.setY(zip.getInt());
     }
 
 
 
     /*--------------------------------------------------------------------------------
-        Function    : Map::at
-        Description : Returns the tile vector at the given coordinates in the tileMap.
+        Function    : Map::loadTileset
+        Description : Reads the tileset section of a saved map.
+        Inputs      : save file
+        Outputs     : None
+        Return      : TilesetPtr
+    --------------------------------------------------------------------------------*/
+    TilesetPtr Map::loadTileset(SaveReader& save)
+    {
+        save.beginSection(SAVE_TILESET);
+        TilesetPtr tileset = Tileset::findTileset(save.getString());
+        save.endSection();
+        return tileset;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::Map(SaveReader&)
+        Description : Loads a map written by saveToDisk(SaveWriter&), from a grid
+                      section or, for a streamed map, a terrain section.
+        Inputs      : save file
+        Outputs     : throws runtime_error if the saved map is damaged or doesn't
+                      fit its tileset
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    Map::Map(SaveReader& save)
+    : tileset(loadTileset(save)), width(0), height(0), chunksHigh(0), streamed(false), seed(0),
+      numResident(0), clock(0), revision(0), snapshotRevision(0)
+    {
+        setUpChunks();
+
+        if(save.peekSection() == SAVE_TERRAIN)
+        {
+            loadTerrain(save);
+        }
+        else
+        {
+            loadGrid(save);
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::loadGrid
+        Description : Loads every cell of the map, packed column after column,
+                      then the stairs.
+        Inputs      : save file
+        Outputs     : throws runtime_error if the saved map is damaged or doesn't
+                      fit its tileset
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Map::loadGrid(SaveReader& save)
+    {
+        save.beginSection(SAVE_GRID);
+
+        size_t savedWidth = save.get<uint32_t>();
+        size_t savedHeight = save.get<uint32_t>();
+        if(savedWidth != getWidth() || savedHeight != getHeight())
+        {
+            throw runtime_error("saved map doesn't fit its tileset");
+        }
+
+        PackedTiles packed;
+        packed.loadFromDisk(save);
+        if(packed.getNumCells() != getWidth() * getHeight())
+        {
+            throw runtime_error("save file is damaged");
+        }
+
+        upStairLocation.setX(save.get<int32_t>());
+        upStairLocation.setY(save.get<int32_t>());
+        downStairLocation.setX(save.get<int32_t>());
+        downStairLocation.setY(save.get<int32_t>());
+
+        save.endSection();
+
+        packed.unpack([this](const size_t cell, const vector<int>& tiles)
+        {
+            int x = cell / height, y = cell % height;
+            fetch(x,y).setTiles(x,y, tiles);
+            if(y == height-1) trim();
+        });
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::loadTerrain
+        Description : Loads a streamed map: the seed its chunks are generated from,
+                      the chunks that were changed, one after another, and the
+                      stairs.  The changed chunks go to the swap file once more
+                      are loaded than the map keeps in memory.
+        Inputs      : save file
+        Outputs     : throws runtime_error if the saved map is damaged or doesn't
+                      fit its tileset
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Map::loadTerrain(SaveReader& save)
+    {
+        save.beginSection(SAVE_TERRAIN);
+
+        size_t savedWidth = save.get<uint32_t>();
+        size_t savedHeight = save.get<uint32_t>();
+        if(!streamed || savedWidth != getWidth() || savedHeight != getHeight())
+        {
+            throw runtime_error("saved map doesn't fit its tileset");
+        }
+
+        bool generated = save.get<uint8_t>() != 0;
+        uint32_t savedSeed = save.get<uint32_t>();
+
+        vector<uint32_t> changed;
+        save.getBlock(changed);
+        PackedTiles packed;
+        packed.loadFromDisk(save);
+        if(packed.getNumCells() != changed.size() * MapChunk::CELLS)
+        {
+            throw runtime_error("save file is damaged");
+        }
+        for(size_t k=0; k<changed.size(); ++k)
+        {
+            if(changed[k] >= chunks.size() || (k > 0 && changed[k] <= changed[k-1]))
+            {
+                throw runtime_error("save file is damaged");
+            }
+        }
+
+        upStairLocation.setX(save.get<int32_t>());
+        upStairLocation.setY(save.get<int32_t>());
+        downStairLocation.setX(save.get<int32_t>());
+        downStairLocation.setY(save.get<int32_t>());
+
+        save.endSection();
+
+        if(generated)
+        {
+            seed = savedSeed;
+            source = GeneratorRegistry::createChunkSource(*tileset, seed);
+        }
+
+        MapChunkPtr chunk;
+        packed.unpack([this, &changed, &chunk](const size_t cell, const vector<int>& tiles)
+        {
+            size_t i = changed[cell / MapChunk::CELLS];
+            int local = cell % MapChunk::CELLS;
+            if(local == 0) chunk = makeChunk(i);
+
+            Point origin = chunk->getOrigin();
+            chunk->setTiles(origin.X() + local / MapChunk::SIZE, origin.Y() + local % MapChunk::SIZE, tiles);
+            if(local == MapChunk::CELLS - 1) install(i, chunk);
+        });
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::fetch
+        Description : Returns the chunk holding the given tile.  On a streamed map
+                      the chunk is paged in if it isn't in memory, and marked as
+                      the one used most recently.
         Inputs      : x coordinate, y coordinate
+        Outputs     : throws out_of_range for tiles off the map
+        Return      : MapChunk&
+    --------------------------------------------------------------------------------*/
+    MapChunk& Map::fetch(const int x, const int y) const
+    {
+        if(x < 0 || y < 0 || x >= width || y >= height)
+        {
+            throw out_of_range("tile off the map");
+        }
+
+        size_t i = chunkIndex(x,y);
+        if(!streamed) return *chunks[i];
+
+        lock_guard<mutex> guard(lock);
+        lastUsed[i] = ++clock;
+        if(!chunks[i])
+        {
+            chunks[i] = load(i);
+            ++numResident;
+        }
+        return *chunks[i];
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::makeChunk
+        Description : Makes a chunk of filler tiles in ambient light.
+        Inputs      : chunk index
+        Outputs     : None
+        Return      : MapChunkPtr
+    --------------------------------------------------------------------------------*/
+    MapChunkPtr Map::makeChunk(const size_t i) const
+    {
+        return MapChunkPtr(new MapChunk(chunkOrigin(i), tileset->getFillerTileID(),
+                                        tileset->getAmbientLight()));
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::load
+        Description : Reads a chunk back from the swap file if it was let go with
+                      changes, or generates it otherwise.  Either way it comes back
+                      clean, since it can be made again the same way.
+        Inputs      : chunk index
+        Outputs     : throws runtime_error if the swap file can't be read
+        Return      : MapChunkPtr
+    --------------------------------------------------------------------------------*/
+    MapChunkPtr Map::load(const size_t i) const
+    {
+        MapChunkPtr chunk = makeChunk(i);
+        if(swapped[i])
+        {
+            PackedTiles packed;
+            readSwapped(i, packed);
+
+            Point origin = chunk->getOrigin();
+            packed.unpack([&chunk, &origin](const size_t cell, const vector<int>& tiles)
+            {
+                chunk->setTiles(origin.X() + cell / MapChunk::SIZE, origin.Y() + cell % MapChunk::SIZE, tiles);
+            });
+        }
+        else if(source)
+        {
+            source->generateChunk(*chunk);
+        }
+        chunk->setDirty(false);
+        return chunk;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::readSwapped
+        Description : Reads the tiles of a chunk that was swapped out.
+        Inputs      : chunk index, packed tiles to fill
+        Outputs     : the chunk's tiles; throws runtime_error if they can't be read
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Map::readSwapped(const size_t i, PackedTiles& packed) const
+    {
+        vector<char> bytes;
+        swapFile->read(*swapped[i], bytes);
+
+        SaveReader save(&bytes[0], bytes.size());
+        save.beginSection(SAVE_CHUNK);
+        packed.loadFromDisk(save);
+        save.endSection();
+
+        if(packed.getNumCells() != static_cast<size_t>(MapChunk::CELLS))
+        {
+            throw runtime_error("swap file is damaged");
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::swapOut
+        Description : Writes a changed chunk to the swap file, deflated, replacing
+                      any copy written before.
+        Inputs      : chunk index
+        Outputs     : None
+        Return      : bool (false if it couldn't be written)
+    --------------------------------------------------------------------------------*/
+    bool Map::swapOut(const size_t i)
+    {
+        if(!swapFile) swapFile.reset(new SwapFile());
+
+        PackedTiles packed;
+        chunks[i]->pack(packed);
+
+        SaveWriter save;
+        save.beginSection(SAVE_CHUNK);
+        packed.saveToDisk(save);
+        save.endSection();
+
+        vector<char> bytes;
+        save.packSections(bytes, true);
+        SwapExtentPtr extent = swapFile->write(bytes);
+        if(!extent) return false;
+
+        swapped[i] = extent;
+        chunks[i]->setDirty(false);
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::install
+        Description : Puts a loaded chunk in memory as the one used most recently,
+                      then trims the map.
+        Inputs      : chunk index, chunk
         Outputs     : None
-        Return      : vector<int>
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Map::install(const size_t i, const MapChunkPtr chunk)
+    {
+        if(!chunks[i]) ++numResident;
+        chunks[i] = chunk;
+        lastUsed[i] = ++clock;
+        trim();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::getNumResident
+        Description : Returns how many chunks are in memory.
+        Inputs      : None
+        Outputs     : None
+        Return      : size_t
+    --------------------------------------------------------------------------------*/
+    size_t Map::getNumResident() const
+    {
+        lock_guard<mutex> guard(lock);
+        return numResident;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::generateFrom
+        Description : Starts a streamed map over with terrain generated from the
+                      given seed by the chunk source of its type.  Nothing is
+                      generated until it is used.
+        Inputs      : seed
+        Outputs     : possible error message and abort, if the map's type isn't
+                      streamed
+        Return      : void
     --------------------------------------------------------------------------------*/
-    vector<int> Map::at(const int x, const int y) const
+    void Map::generateFrom(const uint32_t s)
     {
-        return tileMap.at(x).at(y);
+        source = GeneratorRegistry::createChunkSource(*tileset, s);
+        seed = s;
+
+        for(size_t i=0; i<chunks.size(); ++i)
+        {
+            chunks[i].reset();
+            swapped[i].reset();
+        }
+        numResident = 0;
+        ++revision;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::focusOn
+        Description : Loads every chunk within the given radius of each point, the
+                      party the camera follows and any other actors that matter,
+                      and pins them so trimming never lets them go, then trims the
+                      map.  The chunks pinned by the last call are let go.  If
+                      more chunks are pinned than the map keeps, it keeps them all.
+        Inputs      : points to keep in memory around, radius in tiles
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Map::focusOn(const vector<Point>& points, const int radius)
+    {
+        if(!streamed) return;
+
+        pinned.assign(chunks.size(), false);
+        for(size_t p=0; p<points.size(); ++p)
+        {
+            int x0 = max(0, points[p].X() - radius), x1 = min(width-1, points[p].X() + radius);
+            int y0 = max(0, points[p].Y() - radius), y1 = min(height-1, points[p].Y() + radius);
+            for(int x = x0 - x0 % MapChunk::SIZE; x<=x1; x+=MapChunk::SIZE)
+            {
+                for(int y = y0 - y0 % MapChunk::SIZE; y<=y1; y+=MapChunk::SIZE)
+                {
+                    pinned[chunkIndex(x,y)] = true;
+                    fetch(x,y);
+                }
+            }
+        }
+        trim();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::trim
+        Description : Lets go of the chunks of a streamed map used longest ago until
+                      no more are in memory than it keeps, skipping pinned ones.
+                      Changed chunks are written to the swap file first; one that
+                      can't be written stays.
+        Inputs      : None
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Map::trim()
+    {
+        if(!streamed || numResident <= STREAMED_CHUNKS) return;
+
+        vector< pair<uint64_t, size_t> > unpinned;
+        for(size_t i=0; i<chunks.size(); ++i)
+        {
+            if(chunks[i] && !pinned[i]) unpinned.push_back(make_pair(lastUsed[i], i));
+        }
+        sort(unpinned.begin(), unpinned.end());
+
+        for(size_t k=0; k<unpinned.size() && numResident > STREAMED_CHUNKS; ++k)
+        {
+            size_t i = unpinned[k].second;
+            if(chunks[i]->isDirty() && !swapOut(i)) continue;
+
+            chunks[i].reset();
+            --numResident;
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::at
+        Description : Returns the tile vector at the given coordinates.
+        Inputs      : x coordinate, y coordinate
+        Outputs     : throws out_of_range for tiles off the map
+        Return      : const reference to vector<int>
+    --------------------------------------------------------------------------------*/
+    const vector<int>& Map::at(const int x, const int y) const
+    {
+        return fetch(x,y).at(x,y);
     }
 
 
@@ -109,8 +539,7 @@ namespace rlns
     --------------------------------------------------------------------------------*/
     int Map::topMostAt(const int x, const int y) const
     {
-        std::vector<int> tiles = tileMap.at(x).at(y);
-        return tiles.at(tiles.size()-1);
+        return fetch(x,y).topMostAt(x,y);
     }
 
 
@@ -125,8 +554,7 @@ namespace rlns
     --------------------------------------------------------------------------------*/
     int Map::bottomMostAt(const int x, const int y) const
     {
-        std::vector<int> tiles = tileMap.at(x).at(y);
-        return tiles.at(0);
+        return fetch(x,y).bottomMostAt(x,y);
     }
 
 
@@ -141,8 +569,8 @@ namespace rlns
     --------------------------------------------------------------------------------*/
     void Map::setBottomMostAt(const int x, const int y, const int id) 
     {
-        tileMap.at(x).at(y).at(0) = id;
-        updateTileCoordinate(x,y);
+        fetch(x,y).setBottomMostAt(x,y, id);
+        ++revision;
     }
 
 
@@ -150,15 +578,15 @@ namespace rlns
     /*--------------------------------------------------------------------------------
         Function    : Map::addFeature
         Description : Adds the given tile id to the top of the tile vector at the 
-                      given position and updates the pathingMap.
+                      given position and updates the pathing information.
         Inputs      : coordinates where the new feature will be added, the feature id
         Outputs     : None
         Return      : void
     --------------------------------------------------------------------------------*/
     void Map::addFeature(const int x, const int y, const int id)
     {
-        tileMap.at(x).at(y).push_back(id);
-        updateTileCoordinate(x,y);
+        fetch(x,y).addFeature(x,y, id);
+        ++revision;
     }
 
 
@@ -173,7 +601,22 @@ namespace rlns
     --------------------------------------------------------------------------------*/
     bool Map::isWalkable(const int x, const int y) const
     {
-        return pathingMap.isWalkable(x,y);
+        return fetch(x,y).isWalkable(x,y);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::isTransparent
+        Description : Returns true if light passes the tile at the given point, for
+                      field of view.
+        Inputs      : coordinates of point to check
+        Outputs     : None
+        Return      : bool
+    --------------------------------------------------------------------------------*/
+    bool Map::isTransparent(const int x, const int y) const
+    {
+        return fetch(x,y).isTransparent(x,y);
     }
 
 
@@ -194,7 +637,7 @@ namespace rlns
             case SWIMMING:
             case FLYING:
             default: // default to walking until more types are implemented
-                return pathingMap.isWalkable(pt.X(), pt.Y());
+                return isWalkable(pt.X(), pt.Y());
         }
     }
 
@@ -209,25 +652,8 @@ namespace rlns
     --------------------------------------------------------------------------------*/
     bool Map::signalTile(const Point& pt, const TileActionType sig)
     {
-        bool result = false;
-        int x = pt.X(), y = pt.Y();
-
-        vector<int>::iterator it, begin, end;
-        begin = tileMap.at(x).at(y).begin(); 
-        end = tileMap.at(x).at(y).end(); 
-
-        for(it=begin; it!=end; ++it)
-        {
-            int i = Tile::findTile(*it)->signal(sig);
-            if(i > 0) // the signaling had an effect
-            {
-                // replace the IDs of the old tile with the new
-                replace(begin, end, *it, i);
-                updateTileCoordinate(x,y);
-                result = true;
-            }
-        }
-
+        bool result = fetch(pt.X(), pt.Y()).signalTile(pt.X(), pt.Y(), sig);
+        if(result) ++revision;
         return result;
     }
 
@@ -260,9 +686,78 @@ namespace rlns
 
 
 
+    /*--------------------------------------------------------------------------------
+        Function    : Map::getLightAt
+        Description : Returns the light of one of the four subcells of a tile.
+        Inputs      : subcell coordinates, twice the tile coordinates
+        Outputs     : throws out_of_range for subcells off the map
+        Return      : TCODColor
+    --------------------------------------------------------------------------------*/
+    TCODColor Map::getLightAt(const int x, const int y) const
+    {
+        if(x < 0 || y < 0)
+        {
+            throw out_of_range("tile off the map");
+        }
+        return fetch(x/2, y/2).getLightAt(x,y);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::refreshTiles
+        Description : Recomputes the pathing information at every cell that holds a
+                      changed tile, after the tiles were reloaded.  Every chunk is
+                      gone through, a streamed map's included.
+        Inputs      : flags indexed by tile ID, true for the changed tiles; vector
+                      to fill
+        Outputs     : the cells that were recomputed
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Map::refreshTiles(const vector<bool>& changed, vector<Point>& refreshed)
+    {
+        vector<Point> cells;
+        for(size_t i=0; i<chunks.size(); ++i)
+        {
+            Point origin = chunkOrigin(i);
+            cells.clear();
+            fetch(origin.X(), origin.Y()).refreshTiles(changed, cells);
+
+            // edge chunks run past the map
+            for(size_t c=0; c<cells.size(); ++c)
+            {
+                if(cells[c].X() < width && cells[c].Y() < height) refreshed.push_back(cells[c]);
+            }
+            trim();
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::refreshLighting
+        Description : Resets the light to the tileset's ambient light, after the
+                      tileset was reloaded.  Chunks that aren't in memory are lit
+                      that way when they come back.
+        Inputs      : None
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Map::refreshLighting()
+    {
+        for(size_t i=0; i<chunks.size(); ++i)
+        {
+            if(chunks[i]) chunks[i]->clearLight(tileset->getAmbientLight());
+        }
+    }
+
+
+
     /*--------------------------------------------------------------------------------
         Function    : Map::saveToDisk
-        Description : Saves the Map to the given save buffer.
+        Description : Saves the Map's tiles and stairs to the given save buffer.
+                      Every cell is written, so a streamed map pages in all of its
+                      chunks until it is next trimmed.
         Inputs      : RLNSZip save buffer
         Outputs     : None
         Return      : void
@@ -271,9 +766,6 @@ namespace rlns
     {
         zip.putString(tileset->getName().c_str());
 
-        int width = getWidth();
-        int height = getHeight();
-
         vector<int> currentTile;
         vector<int>::const_iterator it, end;
 
@@ -291,6 +783,163 @@ namespace rlns
                 }
             }
         }
+
+        zip.putInt(upStairLocation.X());
+        zip.putInt(upStairLocation.Y());
+        zip.putInt(downStairLocation.X());
+        zip.putInt(downStairLocation.Y());
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : MapSnapshot::MapSnapshot
+        Description : Copies the map's tiles into save form.  A map that isn't
+                      streamed is copied cell by cell, column after column.  A
+                      streamed map is copied a chunk at a time, and only the chunks
+                      that differ from the ones its source would generate: those
+                      changed in memory or swapped out.  Swapped out chunks are
+                      read back from the swap file; none are paged in.
+        Inputs      : map
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    MapSnapshot::MapSnapshot(const Map& map)
+    : tilesetName(map.getTileset()->getName()),
+      width(map.getWidth()), height(map.getHeight()),
+      streamed(map.streamed), generated(map.source.get() != NULL), seed(map.seed),
+      upStairLocation(map.getUpStairLocation()),
+      downStairLocation(map.getDownStairLocation())
+    {
+        if(!streamed)
+        {
+            for(size_t x=0; x<width; ++x)
+            {
+                for(size_t y=0; y<height; ++y)
+                {
+                    tiles.add(map.at(x,y));
+                }
+            }
+            return;
+        }
+
+        lock_guard<mutex> guard(map.lock);
+        for(size_t i=0; i<map.chunks.size(); ++i)
+        {
+            const MapChunkPtr& chunk = map.chunks[i];
+            if(chunk && (chunk->isDirty() || map.swapped[i]))
+            {
+                chunks.push_back(i);
+                chunk->pack(tiles);
+            }
+            else if(!chunk && map.swapped[i])
+            {
+                chunks.push_back(i);
+                PackedTiles swappedTiles;
+                map.readSwapped(i, swappedTiles);
+                swappedTiles.unpack([this](const size_t, const vector<int>& stack)
+                {
+                    tiles.add(stack);
+                });
+            }
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : MapSnapshot::saveToDisk
+        Description : Saves the snapshot as a tileset section and a grid section,
+                      or a terrain section for a streamed map.  The tile blocks are
+                      followed by the stairs.
+        Inputs      : save file
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void MapSnapshot::saveToDisk(SaveWriter& save) const
+    {
+        save.beginSection(SAVE_TILESET);
+        save.putString(tilesetName);
+        save.endSection();
+
+        save.beginSection(streamed ? SAVE_TERRAIN : SAVE_GRID);
+        save.put<uint32_t>(width);
+        save.put<uint32_t>(height);
+        if(streamed)
+        {
+            save.put<uint8_t>(generated);
+            save.put<uint32_t>(seed);
+            save.putBlock(chunks);
+        }
+        tiles.saveToDisk(save);
+        save.put<int32_t>(upStairLocation.X());
+        save.put<int32_t>(upStairLocation.Y());
+        save.put<int32_t>(downStairLocation.X());
+        save.put<int32_t>(downStairLocation.Y());
+        save.endSection();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::takeSnapshot
+        Description : Returns a snapshot of the map as it is now.  The snapshot is
+                      kept and handed out again until the map's revision moves on,
+                      so saving a level nobody has touched since the last save
+                      copies nothing.
+        Inputs      : None
+        Outputs     : None
+        Return      : MapSnapshotPtr
+    --------------------------------------------------------------------------------*/
+    MapSnapshotPtr Map::takeSnapshot() const
+    {
+        if(!snapshot || snapshotRevision != revision)
+        {
+            snapshot.reset(new MapSnapshot(*this));
+            snapshotRevision = revision;
+        }
+        return snapshot;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::memoryUsage
+        Description : Estimates the bytes the map holds on to: the chunks in memory,
+                      with their tiles, cell bits and light, the chunk table and
+                      the cached snapshot, if there is one.
+        Inputs      : None
+        Outputs     : None
+        Return      : size_t
+    --------------------------------------------------------------------------------*/
+    size_t Map::memoryUsage() const
+    {
+        lock_guard<mutex> guard(lock);
+        size_t bytes = sizeof(*this) + pinned.capacity() / 8
+                     + chunks.capacity() * (sizeof(MapChunkPtr) + sizeof(uint64_t) + sizeof(SwapExtentPtr));
+
+        for(size_t i=0; i<chunks.size(); ++i)
+        {
+            if(chunks[i]) bytes += chunks[i]->memoryUsage();
+        }
+
+        if(snapshot) bytes += snapshot->memoryUsage();
+        return bytes;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Map::saveToDisk(SaveWriter&)
+        Description : Saves the Map as a tileset section and a grid or terrain
+                      section.
+        Inputs      : save file
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Map::saveToDisk(SaveWriter& save) const
+    {
+        takeSnapshot()->saveToDisk(save);
     }
 
 
@@ -327,4 +976,38 @@ namespace rlns
         // if we get here, check fails for all directions, so return false
         return false;
     }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : TileBuffer::TileBuffer
+        Description : Makes an empty buffer for the given rectangle of a map.
+        Inputs      : map, left and top edges, width and height
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    TileBuffer::TileBuffer(const Map& map, const int x, const int y, const int w, const int h)
+    : tileset(map.tileset), left(x), top(y), width(max(w, 0)), height(max(h, 0)),
+      mapWidth(map.getWidth()), mapHeight(map.getHeight()), ids(width * height, -1) {}
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : TileBuffer::applyTo
+        Description : Writes every tile set in the buffer to the map.
+        Inputs      : map
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void TileBuffer::applyTo(Map& map) const
+    {
+        for(int y=0; y<height; ++y)
+        {
+            for(int x=0; x<width; ++x)
+            {
+                int id = ids[y * width + x];
+                if(id >= 0) map.setBottomMostAt(left + x, top + y, id);
+            }
+        }
+    }
 }
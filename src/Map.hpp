@@ -3,75 +3,178 @@
 
 #include <algorithm>
 #include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "AbstractTile.hpp"
 #include "CheckedSave.hpp"
+#include "MapChunk.hpp"
+#include "SaveFile.hpp"
+#include "SwapFile.hpp"
 #include "Tileset.hpp"
 
 namespace rlns
 {
-    typedef std::vector< std::vector< std::vector<int> > > IntVector3D;
+    /*--------------------------------------------------------------------------------
+        Class       : MapSnapshot
+        Description : A map's tiles and stairs, frozen in the form they are saved
+                      in.  For most maps that is every cell, packed column after
+                      column; for a streamed map it is the seed its chunks are
+                      generated from and the chunks that were changed since, each
+                      packed in turn.  A snapshot never changes once taken, so it
+                      can be written out on another thread while the game goes on.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class MapSnapshot
+    {
+        // Member Variables
+        private:
+            std::string tilesetName;
+            uint32_t width, height;
+            bool streamed, generated;
+            uint32_t seed;
+            std::vector<uint32_t> chunks; // streamed maps: the chunks packed
+            PackedTiles tiles;
+            Point upStairLocation, downStairLocation;
+
+        // Member Functions
+        public:
+            MapSnapshot(const Map&);
+
+            void saveToDisk(SaveWriter&) const;
+            size_t memoryUsage() const
+            {
+                return sizeof(*this) + tilesetName.capacity()
+                     + chunks.capacity() * sizeof(uint32_t) + tiles.memoryUsage();
+            }
+    };
+
+
 
     /*--------------------------------------------------------------------------------
         Class       : Map
-        Description : Contains all the data needed for a level map.  Includes the tile
-                      map, pathing map, and lighting map.
+        Description : Contains all the data needed for a level map: its tiles, with
+                      the pathing and lighting information for each of them.  The
+                      map is stored as MapChunks.  Most maps keep every chunk in
+                      memory.  Maps of a type that registered a chunk source are
+                      streamed: a chunk is generated the first time it is used,
+                      and once trimmed the map keeps only the chunks used most
+                      recently, and those pinned by focusOn(), in memory.  A
+                      changed chunk is written to a swap file when it is let go,
+                      an unchanged one is simply generated again, so memory stays
+                      bounded however large the map is.
+
+                      A map is not thread safe: its mutators must be called from
+                      one thread at a time, with no readers running.  Const
+                      members may be called from several threads at once while
+                      nothing changes the map; on a streamed map they page chunks
+                      in, but only trim() and the other non-const members let
+                      chunks go, so the references at() returns stay good until
+                      the next of those.  Builders that work in parallel compute
+                      into buffers of their own and write them to the map from one
+                      thread.
         Parents     : None
         Children    : None
-        Friends     : None
+        Friends     : MapSnapshot
     --------------------------------------------------------------------------------*/
     class Map
     {
+        friend class MapSnapshot;
+
+        // Static Variables
+        public:
+            static const size_t STREAMED_CHUNKS = 48; // kept in memory by a streamed map
+
         // Member Variables
         public:
             TilesetPtr tileset;
 
-            // This TCODImage will have twice the width and height of the
-            // tileMap in order to have four data entries per tile. This
-            // allows the map to be shaded using subpixels.
-            TCODImage lightMap;
-
-            // This map is the same width and height of the tile map and is
-            // used for pathfinding and field of view.
-            TCODMap pathingMap;
-
         private:
-            // two dimensions for width and height, and the third dimension
-            // for stacking tiles on top of each other, such as a door tile
-            // sitting on top of a floor tile
-            IntVector3D tileMap;
+            int width, height;
+            int chunksHigh; // chunk (x/SIZE, y/SIZE) is chunks[x/SIZE * chunksHigh + y/SIZE]
             Point upStairLocation, downStairLocation;
 
+            bool streamed;
+            ChunkSourcePtr source; // null until generateFrom(): unchanged chunks are filler
+            uint32_t seed;
+
+            // chunks are paged in by const members, so the table is mutable and
+            // guarded by the lock on a streamed map
+            mutable std::vector<MapChunkPtr> chunks; // null if not in memory
+            mutable std::vector<uint64_t> lastUsed;
+            mutable size_t numResident;
+            mutable uint64_t clock;
+            mutable std::mutex lock;
+
+            std::vector<SwapExtentPtr> swapped; // changed chunks that were let go
+            std::vector<bool> pinned;
+            SwapFilePtr swapFile;
+
+            // counts changes to the map, so a snapshot can tell whether it is
+            // still current without every change having to drop it
+            uint64_t revision;
+
+            // the last snapshot taken, shared by every save until the map changes
+            mutable MapSnapshotPtr snapshot;
+            mutable uint64_t snapshotRevision;
+
         // Member Functions
         private:
-            void updateTileCoordinate(const int, const int);
+            void setUpChunks();
+            size_t chunkIndex(const int x, const int y) const
+            { return (x / MapChunk::SIZE) * chunksHigh + (y / MapChunk::SIZE); }
+            Point chunkOrigin(const size_t i) const
+            { return Point((i / chunksHigh) * MapChunk::SIZE, (i % chunksHigh) * MapChunk::SIZE); }
+
+            MapChunk& fetch(const int, const int) const;
+            MapChunkPtr makeChunk(const size_t) const;
+            MapChunkPtr load(const size_t) const;
+            void readSwapped(const size_t, PackedTiles&) const;
+            bool swapOut(const size_t);
+            void install(const size_t, const MapChunkPtr);
+
+            static TilesetPtr loadTileset(SaveReader&);
+            void loadGrid(SaveReader&);
+            void loadTerrain(SaveReader&);
 
         public:
             Map(const TilesetPtr);
             Map(RLNSZip&);
+            Map(SaveReader&);
 
             TilesetPtr getTileset() const 
             { return tileset; }
 
             size_t getWidth() const 
-            { return tileMap.size(); }
+            { return width; }
 
             size_t getHeight() const
-            { return tileMap.at(0).size(); }
+            { return height; }
 
             Point getUpStairLocation() const
             { return upStairLocation; }
             void setUpStairLocation(const Point& up)
-            { upStairLocation = up; }
+            { upStairLocation = up; ++revision; }
 
             Point getDownStairLocation() const
             { return downStairLocation; }
             void setDownStairLocation(const Point& down)
-            { downStairLocation = down; }
+            { downStairLocation = down; ++revision; }
+
+            // Chunk Functions
+            bool isStreamed() const { return streamed; }
+            size_t getNumChunks() const { return chunks.size(); }
+            size_t getNumResident() const;
+            void generateFrom(const uint32_t);
+            void focusOn(const std::vector<Point>&, const int);
+            void trim();
 
-            std::vector<int> at(const int, const int) const;
-            std::vector<int> at(const Point&) const;
+            const std::vector<int>& at(const int, const int) const;
+            const std::vector<int>& at(const Point&) const;
 
             // Returns the tile ID at the end of the vector at
             // the given coordinates. This is the most visible
@@ -96,6 +199,7 @@ namespace rlns
 
             bool isWalkable(const int, const int) const;
             bool isWalkable(const Point&) const;
+            bool isTransparent(const int, const int) const;
 
             bool moveLegal(const Point&, const MovementType) const;
 
@@ -103,13 +207,23 @@ namespace rlns
 
             void listTileFeatures(std::vector<AbstractTilePtr>&, const Point&) const;
 
+            // The light map has twice the width and height of the tile map, four
+            // entries a tile, so the map can be shaded using subpixels.
+            TCODColor getLightAt(const int, const int) const;
+
+            void refreshTiles(const std::vector<bool>&, std::vector<Point>&);
+            void refreshLighting();
+
             void saveToDisk(RLNSZip&) const;
+            void saveToDisk(SaveWriter&) const;
+            MapSnapshotPtr takeSnapshot() const;
+            size_t memoryUsage() const;
     };
 
 
     // Inline Functions
 
-    inline std::vector<int> Map::at(const Point& pt) const
+    inline const std::vector<int>& Map::at(const Point& pt) const
     {
         return at(pt.X(), pt.Y());
     }
@@ -161,6 +275,58 @@ namespace rlns
     }
 
 
+
+    /*--------------------------------------------------------------------------------
+        Class       : TileBuffer
+        Description : Bottom-most tile IDs written for one rectangle of a map, kept
+                      aside until they are applied to it.  A builder working in
+                      parallel gives each worker a buffer for its own part of the
+                      map, then applies them one after another on a single thread,
+                      since the map itself is not thread safe.  Writing outside
+                      the rectangle throws out_of_range.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class TileBuffer
+    {
+        // Member Variables
+        public:
+            TilesetPtr tileset;
+
+        private:
+            int left, top, width, height;
+            size_t mapWidth, mapHeight;
+            std::vector<int> ids; // row by row, -1 where nothing was written
+
+        // Member Functions
+        public:
+            TileBuffer(const Map&, const int, const int, const int, const int);
+
+            size_t getMapWidth() const
+            { return mapWidth; }
+
+            size_t getMapHeight() const
+            { return mapHeight; }
+
+            void setBottomMostAt(const int, const int, const int);
+            void applyTo(Map&) const;
+    };
+
+
+
+    // Inline Functions
+
+    inline void TileBuffer::setBottomMostAt(const int x, const int y, const int id)
+    {
+        if(x < left || y < top || x >= left + width || y >= top + height)
+        {
+            throw std::out_of_range("tile written outside its buffer");
+        }
+        ids[(y - top) * width + (x - left)] = id;
+    }
+
+
     // Non-member Functions
 
     bool hasDoorAdjacentTo(const MapPtr, const Point&);
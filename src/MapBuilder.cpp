@@ -4,6 +4,28 @@ using namespace std;
 
 namespace rlns
 {
+    /*--------------------------------------------------------------------------------
+        Function    : MapBuilder::findOpenCells
+        Description : Rebuilds the walkable cell list of every area, so that random
+                      placement within an area no longer needs a rejection loop.
+                      The map is trimmed after each area.
+        Inputs      : None
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void MapBuilder::findOpenCells()
+    {
+        vector<AreaPtr>::iterator it, end;
+        it = areas.begin(); end = areas.end();
+        for(; it!=end; ++it)
+        {
+            (*it)->findOpenCells(map);
+            map->trim();
+        }
+    }
+
+
+
     /*--------------------------------------------------------------------------------
         Function    : MapBuilder::placeStairs
         Description : Places the up and down staircases on the map.
@@ -17,17 +39,18 @@ namespace rlns
         start = *(areas.begin());
         end = *(areas.end()-1);
 
+        // finishing touches such as doors may have closed off cells since the
+        // open cell lists were built, so refresh the two areas we draw from
+        start->findOpenCells(map);
+        end->findOpenCells(map);
+
         // Place the up stair
-        Point up;
-        do { up = start->getRandomPoint(rand); } 
-        while(!map->isWalkable(up));
+        Point up = start->getRandomOpenPoint(rand);
         map->addFeature(up, map->tileset->getUpStairTileID());
         map->setUpStairLocation(up);
 
-        // Place the up stair
-        Point down;
-        do { down = end->getRandomPoint(rand); } 
-        while(!map->isWalkable(down));
+        // Place the down stair
+        Point down = end->getRandomOpenPoint(rand);
         map->addFeature(down, map->tileset->getDownStairTileID());
         map->setDownStairLocation(down);
     }
@@ -45,9 +68,11 @@ namespace rlns
     {
         buildBSPTree();
         constructAreas();
+        findOpenCells();
         connectAreas();
         addLights();
         finishMap();
+        findOpenCells();
     }
 
 
@@ -64,42 +89,9 @@ namespace rlns
     --------------------------------------------------------------------------------*/
     int getBorderCode(const MapPtr map, const Point& center, const int ch)
     {
-        // get center Point coordinates
-        int x = center.X();
-        int y = center.Y();
-        int code = 0;
-
-        // assemble code.  The try/catch's are in case the Point is at the edge of the
-        // map, in which case, the code is not incremented, since a non-existant tile
-        // is certainly not equal to ch.
-        //
-        // try each compass direction and trip a flag if the character is found
-        // from North -> NorthEast -> ... -> NorthWest
-        try { if(map->bottomMostAt(x,y-1) == ch) code += 1; }
-        catch(out_of_range&) {}
-
-        try { if(map->bottomMostAt(x+1,y-1) == ch) code += 2; }
-        catch(out_of_range&) {}
-
-        try { if(map->bottomMostAt(x+1,y) == ch) code += 4; }
-        catch(out_of_range&) {}
-
-        try { if(map->bottomMostAt(x+1,y+1) == ch) code += 8; }
-        catch(out_of_range&) {}
-
-        try { if(map->bottomMostAt(x,y+1) == ch) code += 16; }
-        catch(out_of_range&) {}
-
-        try { if(map->bottomMostAt(x-1,y+1) == ch) code += 32; }
-        catch(out_of_range&) {}
-
-        try { if(map->bottomMostAt(x-1,y) == ch) code += 64; }
-        catch(out_of_range&) {}
-
-        try { if(map->bottomMostAt(x-1,y-1) == ch) code += 128; }
-        catch(out_of_range&) {}
-
-        return code;
+        // tiles off the edge of the map are certainly not equal to ch, so
+        // borderCode() simply leaves their flags unset
+        return borderCode(*map, center.X(), center.Y(), TileEquals(ch));
     }
 
 
@@ -115,41 +107,7 @@ namespace rlns
     --------------------------------------------------------------------------------*/
     int getBorderCode(const MapPtr map, const Point& center, const vector<int>& ids)
     {
-        // get center Point coordinates
-        int x = center.X();
-        int y = center.Y();
-        int code = 0;
-
-        vector<int>::const_iterator begin, end;
-        begin = ids.begin(); end = ids.end();
-
-        // try each compass direction and trip a flag if the character is found
-        // from North -> NorthEast -> ... -> NorthWest
-        try { if(find(begin, end, map->bottomMostAt(x,y-1)) != end) code += 1; }
-        catch(out_of_range&) {}
-
-        try { if(find(begin, end, map->bottomMostAt(x+1,y-1)) != end) code += 2; }
-        catch(out_of_range&) {}
-
-        try { if(find(begin, end, map->bottomMostAt(x+1,y)) != end) code += 4; }
-        catch(out_of_range&) {}
-
-        try { if(find(begin, end, map->bottomMostAt(x+1,y+1)) != end) code += 8; }
-        catch(out_of_range&) {}
-
-        try { if(find(begin, end, map->bottomMostAt(x,y+1)) != end) code += 16; }
-        catch(out_of_range&) {}
-
-        try { if(find(begin, end, map->bottomMostAt(x-1,y+1)) != end) code += 32; }
-        catch(out_of_range&) {}
-
-        try { if(find(begin, end, map->bottomMostAt(x-1,y)) != end) code += 64; }
-        catch(out_of_range&) {}
-
-        try { if(find(begin, end, map->bottomMostAt(x-1,y-1)) != end) code += 128; }
-        catch(out_of_range&) {}
-
-        return code;
+        return borderCode(*map, center.X(), center.Y(), TileIn(ids));
     }
 
 
@@ -164,38 +122,7 @@ namespace rlns
     --------------------------------------------------------------------------------*/
     int numNeighbors(const MapPtr map, const Point& center, const int ch)
     {
-        // get center Point coordinates
-        int x = center.X();
-        int y = center.Y();
-        int count = 0;
-
-        // try each compass direction and increment the counter if the character is found
-        // from North -> NorthEast -> ... -> NorthWest
-        try { if(map->bottomMostAt(x,y-1) == ch) ++count; }
-        catch(out_of_range&) {}
-
-        try { if(map->bottomMostAt(x+1,y-1) == ch) ++count; }
-        catch(out_of_range&) {}
-
-        try { if(map->bottomMostAt(x+1,y) == ch) ++count; }
-        catch(out_of_range&) {}
-
-        try { if(map->bottomMostAt(x+1,y+1) == ch) ++count; }
-        catch(out_of_range&) {}
-
-        try { if(map->bottomMostAt(x,y+1) == ch) ++count; }
-        catch(out_of_range&) {}
-
-        try { if(map->bottomMostAt(x-1,y+1) == ch) ++count; }
-        catch(out_of_range&) {}
-
-        try { if(map->bottomMostAt(x-1,y) == ch) ++count; }
-        catch(out_of_range&) {}
-
-        try { if(map->bottomMostAt(x-1,y-1) == ch) ++count; }
-        catch(out_of_range&) {}
-
-        return count;
+        return neighborCount(*map, center.X(), center.Y(), TileEquals(ch));
     }
 
 
@@ -203,16 +130,66 @@ namespace rlns
     /*--------------------------------------------------------------------------------
         Function    : isReachable
         Description : Determines if two points on the map can reach each other by 
-                      walking.
+                      walking, diagonals included.  The fill spreads through one
+                      chunk of the map at a time, leaving the cells it reaches in
+                      other chunks for later, and goes on with the chunk with the
+                      most cells waiting, so a streamed map pages in each chunk a
+                      few times at most and is trimmed as it goes.
         Inputs      : Map object and the two Points that need to be tested.
         Outputs     : None
         Return      : bool
     --------------------------------------------------------------------------------*/
     bool isReachable(const MapPtr map, const Point& origin, const Point& dest)
     {
-        TCODPath path(&(map->pathingMap), 100.0f); // we don't want diagonal movements
-        path.compute(origin.X(), origin.Y(), dest.X(), dest.Y());
-        return !path.isEmpty();
+        const int width = map->getWidth();
+        const int height = map->getHeight();
+        const int chunksHigh = (height + MapChunk::SIZE - 1) / MapChunk::SIZE;
+        auto chunkOf = [chunksHigh](const int x, const int y)
+        { return (x / MapChunk::SIZE) * chunksHigh + y / MapChunk::SIZE; };
+
+        // cells are marked when they are queued, and checked when they are filled
+        vector<bool> queued(width * height, false);
+        std::map< int, vector<Point> > waiting;
+        waiting[chunkOf(origin.X(), origin.Y())].push_back(origin);
+        queued[origin.X()*height + origin.Y()] = true;
+
+        vector<Point> cells;
+        while(!waiting.empty())
+        {
+            std::map< int, vector<Point> >::iterator it, most;
+            for(it=most=waiting.begin(); it!=waiting.end(); ++it)
+            {
+                if(it->second.size() > most->second.size()) most = it;
+            }
+            int chunk = most->first;
+            cells.swap(most->second);
+            waiting.erase(most);
+
+            while(!cells.empty())
+            {
+                Point pt = cells.back();
+                cells.pop_back();
+                if(pt == dest) return true;
+                if(!(pt == origin) && !map->isWalkable(pt.X(), pt.Y())) continue;
+
+                for(int dx=-1; dx<=1; ++dx)
+                {
+                    for(int dy=-1; dy<=1; ++dy)
+                    {
+                        int x = pt.X() + dx, y = pt.Y() + dy;
+                        if(x < 0 || y < 0 || x >= width || y >= height) continue;
+                        if(queued[x*height + y]) continue;
+
+                        queued[x*height + y] = true;
+                        if(chunkOf(x,y) == chunk) cells.push_back(Point(x,y));
+                        else waiting[chunkOf(x,y)].push_back(Point(x,y));
+                    }
+                }
+            }
+            map->trim();
+        }
+
+        return false;
     }
 
 
@@ -315,7 +292,7 @@ namespace rlns
         Outputs     : None
         Return      : void
     --------------------------------------------------------------------------------*/
-    static void perturbPath(const MapPtr map, TCODRandom* rand, vector<Point>* wayPoints, const int mindist, const int maxdist, const int pertamt)
+    static void perturbPath(const MapPtr map, Random* rand, vector<Point>* wayPoints, const int mindist, const int maxdist, const int pertamt)
     {
         if(wayPoints->size() < 3)
         {
@@ -384,7 +361,7 @@ namespace rlns
         Outputs     : None
         Return      : void
     --------------------------------------------------------------------------------*/
-    static void windPath(const MapPtr map, TCODRandom* rand, vector<Point>* path, const Point& origin, const Point& dest, const int pertamt)
+    static void windPath(const MapPtr map, Random* rand, vector<Point>* path, const Point& origin, const Point& dest, const int pertamt)
     {
         vector<Point> wayPoints;
 
@@ -473,10 +450,62 @@ namespace rlns
         Outputs     : None
         Return      : void
     --------------------------------------------------------------------------------*/
-    void getCurvyPathBetweenPoints(vector<Point>* path, const MapPtr map, TCODRandom* rand, 
+    void getCurvyPathBetweenPoints(vector<Point>* path, const MapPtr map, Random* rand, 
                                     const Point& origin, const Point& dest)
     {
         int pertamt = 10; // default perturbation amount
         windPath(map, rand, path, origin, dest, pertamt);
     }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : ensureStairsAreReachable
+        Description : Checks that a path exists between the up and down stairs.  If
+                      one does not, it will dig a straight line path between them.
+        Inputs      : map, random number generator
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void ensureStairsAreReachable(const MapPtr map, Random& rand)
+    {
+        Point up = map->getUpStairLocation();
+        Point down = map->getDownStairLocation();
+
+        if(!isReachable(map, up, down))
+        {
+            vector<Point> path;
+            getCurvyPathBetweenPoints(&path, map, &rand, up, down);
+            makePath(map, path, map->tileset->getFloorTileID());
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : replaceBorderWalls
+        Description : Ensures that the borders of the map are solid walls.
+        Inputs      : map
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void replaceBorderWalls(const MapPtr map)
+    {
+        unsigned int width = map->getWidth();
+        unsigned int height = map->getHeight();
+
+        // first, the northern and southern borders
+        for(unsigned int x=0; x<width; ++x)
+        {
+            map->setBottomMostAt(x, 0, map->tileset->getWallTileID());
+            map->setBottomMostAt(x, height-1, map->tileset->getWallTileID());
+        }
+
+        // next, the eastern and western borders
+        for(unsigned int y=0; y<height; ++y)
+        {
+            map->setBottomMostAt(0, y, map->tileset->getWallTileID());
+            map->setBottomMostAt(width-1, y, map->tileset->getWallTileID());
+        }
+    }
 }
@@ -2,12 +2,15 @@
 #define RLNS_MAPBUILDER_HPP
 
 #include <algorithm>
+#include <map>
 #include <stdexcept>
 #include <vector>
 
 #include "Area.hpp"
+#include "BSPTree.hpp"
 #include "Map.hpp"
 #include "Point.hpp"
+#include "Random.hpp"
 #include "Types.hpp"
 #include "Utility.hpp"
 
@@ -16,16 +19,18 @@ namespace rlns
     /*--------------------------------------------------------------------------------
         Class       : MapBuilder
         Description : Abstract class that builds the various map types in the game.
+                      Builders are normally composed from phase policies through
+                      PhasedBuilder and created through the GeneratorRegistry.
         Parents     : None
-        Children    : DungeonBuilder, CaveBuilder
+        Children    : PhasedBuilder
         Friends     : None
     --------------------------------------------------------------------------------*/
     class MapBuilder
     {
         // Member Variables
         protected:
-            TCODBspPtr bsp; // libtcod BSP tree
-            TCODRandom rand;
+            BSPTreePtr bsp;
+            Random rand;
             MapPtr map;
             std::vector<AreaPtr> areas;
 
@@ -37,9 +42,10 @@ namespace rlns
 
         // Member Functions
         protected:
-            MapBuilder(const MapPtr m) 
-            : map(m) {}
+            MapBuilder(const MapPtr m)
+            : rand(Random::stream(STREAM_GENERATION).fork()), map(m) {}
 
+            void findOpenCells();
             void placeStairs();
 
             virtual void buildBSPTree() {}
@@ -56,10 +62,79 @@ namespace rlns
             std::vector<AreaPtr> getAreas() const
             { return areas; }
 
-            void buildMap();
+            // the same seed always builds the same map
+            void setSeed(const uint32_t seed)
+            { rand.seed(seed); }
+
+            virtual void buildMap();
     };
 
 
+
+    /*--------------------------------------------------------------------------------
+        Class       : TileEquals, TileIn
+        Description : Tile ID predicates for borderCode() and neighborCount().
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class TileEquals
+    {
+        private:
+            int id;
+
+        public:
+            TileEquals(const int i): id(i) {}
+            bool operator()(const int tile) const { return tile == id; }
+    };
+
+    class TileIn
+    {
+        private:
+            const std::vector<int>& ids;
+
+        public:
+            TileIn(const std::vector<int>& i): ids(i) {}
+            bool operator()(const int tile) const
+            { return std::find(ids.begin(), ids.end(), tile) != ids.end(); }
+    };
+
+
+    // Inline Functions
+
+    // Assembles the border code described at getBorderCode() for the tiles around
+    // (x,y) that match the predicate.  Neighbors off the map never match.  Taking
+    // the predicate as a template parameter lets per-cell loops inline the test.
+    template<typename Predicate>
+    inline int borderCode(const Map& map, const int x, const int y, Predicate matches)
+    {
+        // from North -> NorthEast -> ... -> NorthWest
+        static const int dx[8] = { 0,  1,  1,  1,  0, -1, -1, -1};
+        static const int dy[8] = {-1, -1,  0,  1,  1,  1,  0, -1};
+
+        int width = map.getWidth();
+        int height = map.getHeight();
+        int code = 0;
+
+        for(int i=0; i<8; ++i)
+        {
+            int nx = x + dx[i], ny = y + dy[i];
+            if(nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+            if(matches(map.bottomMostAt(nx, ny))) code |= (1 << i);
+        }
+        return code;
+    }
+
+    template<typename Predicate>
+    inline int neighborCount(const Map& map, const int x, const int y, Predicate matches)
+    {
+        int code = borderCode(map, x, y, matches);
+        int count = 0;
+        for(; code; code &= code-1) ++count;
+        return count;
+    }
+
+
     // Non-member Functions
 
     int getBorderCode(const MapPtr, const Point&, const int);
@@ -71,7 +146,10 @@ namespace rlns
 
     void makePath(const MapPtr, const std::vector<Point>&, const int);
 
-    void getCurvyPathBetweenPoints(std::vector<Point>*, const MapPtr, TCODRandom*, const Point&, const Point&);
+    void getCurvyPathBetweenPoints(std::vector<Point>*, const MapPtr, Random*, const Point&, const Point&);
+
+    void ensureStairsAreReachable(const MapPtr, Random&);
+    void replaceBorderWalls(const MapPtr);
 }
 
-#endif 
+#endif
@@ -0,0 +1,340 @@
+#include "MapChunk.hpp"
+#include "Tile.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Function    : PackedTiles::add
+        Description : Adds the next cell's tile stack.
+        Inputs      : tiles, bottom first
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void PackedTiles::add(const vector<int>& tiles)
+    {
+        if(values.empty() || values.back() != tiles[0])
+        {
+            runs.push_back(0);
+            values.push_back(tiles[0]);
+        }
+        ++runs.back();
+
+        if(tiles.size() > 1)
+        {
+            cells.push_back(numCells);
+            heights.push_back(tiles.size() - 1);
+            stacked.insert(stacked.end(), tiles.begin() + 1, tiles.end());
+        }
+        ++numCells;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : PackedTiles::saveToDisk
+        Description : Writes the five blocks to the current section.
+        Inputs      : save file
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void PackedTiles::saveToDisk(SaveWriter& save) const
+    {
+        save.putBlock(runs);
+        save.putBlock(values);
+        save.putBlock(cells);
+        save.putBlock(heights);
+        save.putBlock(stacked);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : PackedTiles::loadFromDisk
+        Description : Reads the five blocks written by saveToDisk() and checks that
+                      they fit together, so unpack() can trust them.
+        Inputs      : save file
+        Outputs     : throws runtime_error if the blocks are damaged
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void PackedTiles::loadFromDisk(SaveReader& save)
+    {
+        save.getBlock(runs);
+        save.getBlock(values);
+        save.getBlock(cells);
+        save.getBlock(heights);
+        save.getBlock(stacked);
+
+        if(runs.size() != values.size() || heights.size() != cells.size())
+        {
+            throw runtime_error("save file is damaged");
+        }
+
+        numCells = 0;
+        for(size_t i=0; i<runs.size(); ++i)
+        {
+            numCells += runs[i];
+        }
+
+        // stacked cells come in order, each with its own extra tiles
+        size_t extra = 0;
+        for(size_t i=0; i<cells.size(); ++i)
+        {
+            if(cells[i] >= numCells || (i > 0 && cells[i] <= cells[i-1]))
+            {
+                throw runtime_error("save file is damaged");
+            }
+            extra += heights[i];
+        }
+        if(extra != stacked.size())
+        {
+            throw runtime_error("save file is damaged");
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : PackedTiles::memoryUsage
+        Description : Estimates the bytes held by the blocks.
+        Inputs      : None
+        Outputs     : None
+        Return      : size_t
+    --------------------------------------------------------------------------------*/
+    size_t PackedTiles::memoryUsage() const
+    {
+        return (values.capacity() + stacked.capacity()) * sizeof(int32_t)
+             + (runs.capacity() + cells.capacity()) * sizeof(uint32_t)
+             + heights.capacity();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : MapChunk::MapChunk
+        Description : Constructs a chunk filled with a single tile, lit by the
+                      given ambient light.  A new chunk is not dirty.
+        Inputs      : map coordinates of the topleft tile, filler tile ID, ambient
+                      light
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    MapChunk::MapChunk(const Point& o, const int filler, const TCODColor& ambient)
+    : origin(o),
+      tiles(CELLS, vector<int>(1, filler)),
+      walkable(CELLS, !Tile::findTile(filler)->blocksWalking()),
+      transparent(CELLS, !Tile::findTile(filler)->blocksLight()),
+      light(4*CELLS, ambient),
+      dirty(false) {}
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : MapChunk::updateCell
+        Description : Recomputes the walkable and transparent bits of a cell from
+                      all of the tiles stacked there.
+        Inputs      : cell index
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void MapChunk::updateCell(const int cell)
+    {
+        bool isTransparent = true;
+        bool isWalkable = true;
+
+        vector<int>::const_iterator it, end;
+        it = tiles[cell].begin(); end = tiles[cell].end();
+
+        for(; it!=end; ++it)
+        {
+            TilePtr tile = Tile::findTile(*it);
+            isTransparent = isTransparent && !tile->blocksLight();
+            isWalkable = isWalkable && !tile->blocksWalking();
+        }
+
+        walkable[cell] = isWalkable;
+        transparent[cell] = isTransparent;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : MapChunk::setBottomMostAt
+        Description : Sets the tile ID at the bottom of the stack.
+        Inputs      : x coordinate, y coordinate, new tile ID
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void MapChunk::setBottomMostAt(const int x, const int y, const int id)
+    {
+        int cell = index(x,y);
+        tiles[cell].at(0) = id;
+        updateCell(cell);
+        dirty = true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : MapChunk::addFeature
+        Description : Adds the given tile ID to the top of the stack.
+        Inputs      : x coordinate, y coordinate, feature ID
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void MapChunk::addFeature(const int x, const int y, const int id)
+    {
+        int cell = index(x,y);
+        tiles[cell].push_back(id);
+        updateCell(cell);
+        dirty = true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : MapChunk::signalTile
+        Description : Signals all of the tiles at the given coordinates, replacing
+                      the IDs of any tile the signal changes.
+        Inputs      : x coordinate, y coordinate, signal
+        Outputs     : None
+        Return      : bool (true if any tile changed)
+    --------------------------------------------------------------------------------*/
+    bool MapChunk::signalTile(const int x, const int y, const TileActionType sig)
+    {
+        bool result = false;
+        int cell = index(x,y);
+
+        vector<int>::iterator it, begin, end;
+        begin = tiles[cell].begin();
+        end = tiles[cell].end();
+
+        for(it=begin; it!=end; ++it)
+        {
+            int i = Tile::findTile(*it)->signal(sig);
+            if(i > 0) // the signaling had an effect
+            {
+                // replace the IDs of the old tile with the new
+                replace(begin, end, *it, i);
+                updateCell(cell);
+                dirty = true;
+                result = true;
+            }
+        }
+
+        return result;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : MapChunk::setTiles
+        Description : Replaces a whole stack, for loading a chunk.
+        Inputs      : x coordinate, y coordinate, tiles, bottom first
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void MapChunk::setTiles(const int x, const int y, const vector<int>& stack)
+    {
+        int cell = index(x,y);
+        tiles[cell] = stack;
+        updateCell(cell);
+        dirty = true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : MapChunk::getLightAt
+        Description : Returns the light of a subcell.
+        Inputs      : subcell coordinates, twice the map coordinates
+        Outputs     : None
+        Return      : TCODColor
+    --------------------------------------------------------------------------------*/
+    TCODColor MapChunk::getLightAt(const int x, const int y) const
+    {
+        return light[(x - 2*origin.X())*2*SIZE + (y - 2*origin.Y())];
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : MapChunk::clearLight
+        Description : Resets every subcell to the given light.
+        Inputs      : ambient light
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void MapChunk::clearLight(const TCODColor& ambient)
+    {
+        light.assign(4*CELLS, ambient);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : MapChunk::refreshTiles
+        Description : Recomputes the bits of every cell that holds a changed tile,
+                      after the tiles were reloaded.
+        Inputs      : flags indexed by tile ID, true for the changed tiles; vector
+                      to fill
+        Outputs     : the cells that were recomputed
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void MapChunk::refreshTiles(const vector<bool>& changed, vector<Point>& refreshed)
+    {
+        for(int cell=0; cell<CELLS; ++cell)
+        {
+            const vector<int>& stack = tiles[cell];
+            for(size_t z=0; z<stack.size(); ++z)
+            {
+                if(static_cast<size_t>(stack[z]) < changed.size() && changed[stack[z]])
+                {
+                    updateCell(cell);
+                    refreshed.push_back(Point(origin.X() + cell/SIZE, origin.Y() + cell%SIZE));
+                    break;
+                }
+            }
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : MapChunk::pack
+        Description : Adds every cell of the chunk, column by column, to the packed
+                      tiles.
+        Inputs      : packed tiles to add to
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void MapChunk::pack(PackedTiles& packed) const
+    {
+        for(int cell=0; cell<CELLS; ++cell)
+        {
+            packed.add(tiles[cell]);
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : MapChunk::memoryUsage
+        Description : Estimates the bytes the chunk holds on to: the tile stacks,
+                      the cell bits and the light.
+        Inputs      : None
+        Outputs     : None
+        Return      : size_t
+    --------------------------------------------------------------------------------*/
+    size_t MapChunk::memoryUsage() const
+    {
+        size_t bytes = sizeof(*this) + light.capacity() * sizeof(TCODColor)
+                     + (walkable.capacity() + transparent.capacity()) / 8;
+        for(int cell=0; cell<CELLS; ++cell)
+        {
+            bytes += sizeof(tiles[cell]) + tiles[cell].capacity() * sizeof(int);
+        }
+        return bytes;
+    }
+}
@@ -0,0 +1,180 @@
+#ifndef RLNS_MAPCHUNK_HPP
+#define RLNS_MAPCHUNK_HPP
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <stdint.h>
+
+#include "Point.hpp"
+#include "SaveFile.hpp"
+#include "Types.hpp"
+#include "libtcod.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : PackedTiles
+        Description : Tile stacks in the form they are saved in: the bottom layer
+                      as runs of the same tile, which are long in walls, open
+                      floors and open country, and the few cells with tiles stacked
+                      on top listed with their extra tiles in three more blocks.
+                      Cells are added one after another and numbered in that order.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class PackedTiles
+    {
+        // Member Variables
+        private:
+            std::vector<int32_t> values, stacked;
+            std::vector<uint32_t> runs, cells;
+            std::vector<uint8_t> heights;
+            size_t numCells;
+
+        // Member Functions
+        public:
+            PackedTiles() : numCells(0) {}
+
+            size_t getNumCells() const { return numCells; }
+
+            void add(const std::vector<int>&);
+
+            template<class Visitor>
+            void unpack(Visitor) const;
+
+            void saveToDisk(SaveWriter&) const;
+            void loadFromDisk(SaveReader&);
+            size_t memoryUsage() const;
+    };
+
+
+
+    // Template Functions
+
+    /*--------------------------------------------------------------------------------
+        Function    : PackedTiles::unpack
+        Description : Hands every cell's tile stack, bottom first, to the visitor,
+                      in the order the cells were added.
+        Inputs      : visitor, called with the cell number and its tiles
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    template<class Visitor>
+    void PackedTiles::unpack(Visitor visit) const
+    {
+        std::vector<int> tiles;
+        size_t cell = 0, next = 0, extra = 0;
+        for(size_t i=0; i<runs.size(); ++i)
+        {
+            for(uint32_t r=0; r<runs[i]; ++r, ++cell)
+            {
+                tiles.assign(1, values[i]);
+                if(next < cells.size() && cells[next] == cell)
+                {
+                    tiles.insert(tiles.end(), stacked.begin() + extra,
+                                 stacked.begin() + extra + heights[next]);
+                    extra += heights[next];
+                    ++next;
+                }
+                visit(cell, tiles);
+            }
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : MapChunk
+        Description : A square block of a map's tiles, the unit in which a map is
+                      generated, kept in memory and swapped out.  Tiles are stored
+                      column by column, like the whole map used to be, with the
+                      walkable and transparent bits of each cell and its light,
+                      four subcells a cell so it can be shaded using subpixels.
+                      All coordinates are map coordinates.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class MapChunk
+    {
+        // Static Variables
+        public:
+            static const int SIZE = 32;
+            static const int CELLS = SIZE*SIZE;
+
+        // Member Variables
+        private:
+            Point origin; // map coordinates of the topleft tile
+            std::vector< std::vector<int> > tiles;
+            std::vector<bool> walkable;
+            std::vector<bool> transparent;
+            std::vector<TCODColor> light;
+            bool dirty; // changed since it was generated, loaded or swapped out
+
+        // Member Functions
+        private:
+            int index(const int x, const int y) const
+            { return (x - origin.X())*SIZE + (y - origin.Y()); }
+
+            void updateCell(const int);
+
+        public:
+            MapChunk(const Point&, const int, const TCODColor&);
+
+            Point getOrigin() const { return origin; }
+
+            bool isDirty() const { return dirty; }
+            void setDirty(const bool d) { dirty = d; }
+
+            const std::vector<int>& at(const int x, const int y) const
+            { return tiles[index(x,y)]; }
+            int topMostAt(const int x, const int y) const
+            { return tiles[index(x,y)].back(); }
+            int bottomMostAt(const int x, const int y) const
+            { return tiles[index(x,y)].at(0); }
+
+            void setBottomMostAt(const int, const int, const int);
+            void addFeature(const int, const int, const int);
+            bool signalTile(const int, const int, const TileActionType);
+            void setTiles(const int, const int, const std::vector<int>&);
+
+            bool isWalkable(const int x, const int y) const
+            { return walkable[index(x,y)]; }
+            bool isTransparent(const int x, const int y) const
+            { return transparent[index(x,y)]; }
+
+            TCODColor getLightAt(const int, const int) const;
+            void clearLight(const TCODColor&);
+
+            void refreshTiles(const std::vector<bool>&, std::vector<Point>&);
+
+            void pack(PackedTiles&) const;
+            size_t memoryUsage() const;
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : ChunkSource
+        Description : Interface for whatever fills in a chunk of a streamed map the
+                      first time it is needed, a terrain generator.  A chunk must
+                      come out the same every time, since one that was never
+                      changed is dropped when it is swapped out and generated
+                      again when it is next needed.  Chunks may be generated on
+                      any thread.
+        Parents     : None
+        Children    : OverworldChunkSource
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class ChunkSource
+    {
+        public:
+            virtual ~ChunkSource() {}
+            virtual void generateChunk(MapChunk&) const = 0;
+    };
+}
+
+#endif
@@ -29,8 +29,8 @@ namespace rlns
             MapObject(const int c, 
                       const TCODColor& fg, 
                       const TCODColor& bg,
-                      const std::string& sd,
-                      const std::string& ld,
+                      const InternedString& sd,
+                      const InternedString& ld,
                       const Point& pos)
             : AbstractTile(c, fg, bg, sd, ld),
               position(pos) {}
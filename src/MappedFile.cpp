@@ -0,0 +1,58 @@
+#include "MappedFile.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Function    : MappedFile::MappedFile
+        Description : Constructor for the MappedFile class.  If the file can't be
+                      opened, the MappedFile is left empty; check isOpen().
+        Inputs      : file name
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    MappedFile::MappedFile(const string& name)
+    : data(NULL), length(0)
+    {
+    #ifdef _WIN32
+        ifstream input(name.c_str(), ios::in | ios::binary);
+        if(!input) return;
+        buffer.assign(istreambuf_iterator<char>(input), istreambuf_iterator<char>());
+        if(buffer.empty()) return;
+        data = &buffer[0];
+        length = buffer.size();
+    #else
+        int fd = open(name.c_str(), O_RDONLY);
+        if(fd < 0) return;
+
+        struct stat info;
+        if(fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            void* mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(mapping != MAP_FAILED)
+            {
+                data = static_cast<const char*>(mapping);
+                length = info.st_size;
+            }
+        }
+        close(fd); // the mapping stays valid
+    #endif
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : MappedFile::~MappedFile
+        Description : Destructor for the MappedFile class.  Unmaps the file.
+        Inputs      : None
+        Outputs     : None
+        Return      : None (destructor)
+    --------------------------------------------------------------------------------*/
+    MappedFile::~MappedFile()
+    {
+    #ifndef _WIN32
+        if(data != NULL) munmap(const_cast<char*>(data), length);
+    #endif
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef RLNS_MAPPEDFILE_HPP
+#define RLNS_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : MappedFile
+        Description : Read-only view of a whole file.  The file is memory mapped
+                      where the platform allows it, so nothing is read until it is
+                      touched; on Windows it is read into a buffer instead.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class MappedFile
+    {
+        // Member Variables
+        private:
+            const char* data;
+            size_t length;
+        #ifdef _WIN32
+            std::vector<char> buffer;
+        #endif
+
+        // Member Functions
+        private:
+            // not copyable, since it owns the mapping
+            MappedFile(const MappedFile&);
+            MappedFile& operator=(const MappedFile&);
+
+        public:
+            MappedFile(const std::string&);
+            ~MappedFile();
+
+            bool isOpen() const       { return data != NULL; }
+            const char* begin() const { return data; }
+            size_t size() const       { return length; }
+    };
+}
+
+#endif
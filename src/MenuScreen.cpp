@@ -486,20 +486,23 @@ namespace rlns
 
     /*--------------------------------------------------------------------------------
         Function    : InventoryScreen::eventLoop
-        Description : Event loop for the inventory screen.
-        Inputs      : None
+        Description : Event loop for the inventory screen.  The events come from
+                      the source given, or the keyboard if it is empty, and the
+                      screen is only drawn if asked to be, so that a recording
+                      played back without rendering never touches the window.
+        Inputs      : source of events, whether to draw the screen
         Outputs     : Results of the player's actions in the inventory.
         Return      : bool (whether the action costs a turn)
     --------------------------------------------------------------------------------*/
-    bool InventoryScreen::eventLoop()
+    bool InventoryScreen::eventLoop(const EventSource& input, const bool drawn)
     {
         EventHandler eventHandler;
         EventType event;
 
         do
         {
-            update();
-            event = eventHandler.getPlayerInput();
+            if(drawn) update();
+            event = input ? input() : eventHandler.getPlayerInput();
             interpretEvent(event);
         }
         while(keepRunning);
@@ -2,6 +2,7 @@
 #define RLNS_MENUSCREEN_HPP
 
 #include <boost/lexical_cast.hpp>
+#include <functional>
 #include <vector>
 
 #include "Actor.hpp"
@@ -15,6 +16,11 @@
 
 namespace rlns
 {
+    // where a screen gets its events from; an empty one reads the keyboard
+    typedef std::function<EventType()> EventSource;
+
+
+
     /*--------------------------------------------------------------------------------
         Class       : MenuScreen
         Description : Base class for all the menuscreens in the game.  A MenuScreen
@@ -99,7 +105,8 @@ namespace rlns
 
             void interpretEvent(const EventType);
 
-            virtual bool eventLoop();
+            virtual bool eventLoop() { return eventLoop(EventSource(), true); }
+            bool eventLoop(const EventSource&, const bool);
     };
 }
 
@@ -1,4 +1,5 @@
 #include "MessageTracker.hpp"
+#include "Pool.hpp"
 
 using namespace std;
 
@@ -16,7 +17,7 @@ namespace rlns
     --------------------------------------------------------------------------------*/
     void MessageTracker::addMessage(const string& str, const TCODColor& fg, const TCODColor& bg)
     {
-        MessagePtr message(new Message(str, fg, bg));
+        MessagePtr message = allocatePooled<Message>(Arena::global(), "Message", str, fg, bg);
         messageLog.push_front(message);
 
         if(messageLog.size() > logSize)
@@ -24,4 +25,59 @@ namespace rlns
             messageLog.pop_back();
         }
     }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : MessageTracker::saveMessages
+        Description : Saves a message log, newest message first, in a messages
+                      section.
+        Inputs      : save file, message log
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void MessageTracker::saveMessages(SaveWriter& save, const list<MessagePtr>& messages)
+    {
+        save.beginSection(SAVE_MESSAGES);
+        save.put<uint32_t>(messages.size());
+
+        list<MessagePtr>::const_iterator it, end;
+        it = messages.begin(); end = messages.end();
+        for(; it!=end; ++it)
+        {
+            save.putString((*it)->getText());
+            save.putColor((*it)->getForeColor());
+            save.putColor((*it)->getBackColor());
+        }
+
+        save.endSection();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : MessageTracker::loadFromDisk
+        Description : Replaces the message log with the one in the save.
+        Inputs      : save file
+        Outputs     : throws runtime_error if the section is damaged
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void MessageTracker::loadFromDisk(SaveReader& save)
+    {
+        save.beginSection(SAVE_MESSAGES);
+        size_t numMessages = save.get<uint32_t>();
+
+        list<MessagePtr> loaded;
+        for(size_t i=0; i<numMessages; ++i)
+        {
+            string text = save.getString();
+            TCODColor fg = save.getColor();
+            TCODColor bg = save.getColor();
+            if(loaded.size() < logSize) loaded.push_back(allocatePooled<Message>(Arena::global(), "Message", text, fg, bg));
+        }
+
+        save.endSection();
+        messageLog.swap(loaded);
+        start = 0;
+    }
 }
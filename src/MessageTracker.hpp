@@ -4,6 +4,7 @@
 #include <list>
 #include <string>
 
+#include "SaveFile.hpp"
 #include "Types.hpp"
 
 #include "libtcod.hpp"
@@ -80,9 +81,17 @@ namespace rlns
             std::list<MessagePtr>::const_iterator end() const
             { return messageLog.end(); }
 
+            // messages never change once added, so a copy of the log is a
+            // snapshot of it
+            std::list<MessagePtr> getMessages() const
+            { return messageLog; }
+
             void addMessage(const std::string&, const TCODColor&, const TCODColor&);
 
             void addStdMessage(const std::string&);
+
+            void loadFromDisk(SaveReader&);
+            static void saveMessages(SaveWriter&, const std::list<MessagePtr>&);
     };
 
 
@@ -0,0 +1,106 @@
+#include "Noise.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Function    : latticeValue
+        Description : Hashes a lattice point into a value in [0,1).  Only integer
+                      multiplies, shifts and xors, so it vectorises.
+        Inputs      : lattice coordinates, seed
+        Outputs     : None
+        Return      : float
+    --------------------------------------------------------------------------------*/
+    static inline float latticeValue(const int xi, const int yi, const uint32_t seed)
+    {
+        uint32_t h = (static_cast<uint32_t>(xi) * 0x27D4EB2Du)
+                   ^ (static_cast<uint32_t>(yi) * 0x165667B1u) ^ seed;
+        h ^= h >> 15;
+        h *= 0x2C1B3C6Du;
+        h ^= h >> 12;
+        h *= 0x297A2D39u;
+        h ^= h >> 15;
+        return static_cast<int>(h >> 8) * (1.0f / 16777216.0f);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : FractalNoise::addOctave
+        Description : Adds one octave of value noise to a batch of BATCH samples
+                      along a row.  The trip count is a compile-time constant, so
+                      the loop vectorises without a scalar tail.
+        Inputs      : batch to add to, x coordinate of the first sample, row y
+                      coordinate, octave frequency, octave amplitude, octave seed
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void FractalNoise::addOctave(float* batch, const float x0, const float y, const float freq,
+                                 const float amplitude, const uint32_t octaveSeed) const
+    {
+        // the row coordinate is shared by the whole batch
+        float fy = y * freq;
+        int yi = static_cast<int>(fy);
+        float ty = fy - yi;
+        ty = ty * ty * (3.0f - 2.0f * ty);
+
+        for(int i=0; i<BATCH; ++i)
+        {
+            float fx = (x0 + i) * freq;
+            int xi = static_cast<int>(fx);
+            float tx = fx - xi;
+            tx = tx * tx * (3.0f - 2.0f * tx);
+
+            float a = latticeValue(xi,   yi,   octaveSeed);
+            float b = latticeValue(xi+1, yi,   octaveSeed);
+            float c = latticeValue(xi,   yi+1, octaveSeed);
+            float d = latticeValue(xi+1, yi+1, octaveSeed);
+
+            float top = a + (b - a) * tx;
+            float bottom = c + (d - c) * tx;
+            batch[i] += amplitude * (top + (bottom - top) * ty);
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : FractalNoise::fillRow
+        Description : Evaluates the noise at count consecutive tiles of a row,
+                      starting at (x0, y), and normalises it to [0,1).
+        Inputs      : output array, number of samples, x coordinate of the first
+                      sample, row y coordinate
+        Outputs     : noise values
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void FractalNoise::fillRow(float* out, const int count, const float x0, const float y) const
+    {
+        float totalAmplitude = 0.0f;
+        float amplitude = 1.0f;
+        for(int o=0; o<octaves; ++o)
+        {
+            totalAmplitude += amplitude;
+            amplitude *= gain;
+        }
+        float scale = 1.0f / totalAmplitude;
+
+        for(int start=0; start<count; start+=BATCH)
+        {
+            float batch[BATCH] = {0.0f};
+
+            float freq = frequency;
+            amplitude = 1.0f;
+            for(int o=0; o<octaves; ++o)
+            {
+                addOctave(batch, x0 + start, y, freq, amplitude, seed + o*0x9E3779B9u);
+                freq *= lacunarity;
+                amplitude *= gain;
+            }
+
+            int n = (count - start < BATCH) ? count - start : BATCH;
+            for(int i=0; i<n; ++i)
+            {
+                out[start+i] = batch[i] * scale;
+            }
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef RLNS_NOISE_HPP
+#define RLNS_NOISE_HPP
+
+#include <stdint.h>
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : FractalNoise
+        Description : Seeded 2D value noise summed over several octaves (fractal
+                      Brownian motion), with results in [0,1).  Noise is evaluated a
+                      row at a time, in fixed-size batches of BATCH samples.  Lattice
+                      values come from an integer hash rather than a permutation
+                      table, so a batch has no table lookups or branches and the
+                      compiler can vectorise it.  Coordinates must be non-negative.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class FractalNoise
+    {
+        // Static Variables
+        public:
+            static const int BATCH = 8;
+
+        // Member Variables
+        private:
+            uint32_t seed;
+            int octaves;
+            float frequency;    // lattice cells per tile at the first octave
+            float lacunarity;   // frequency multiplier between octaves
+            float gain;         // amplitude multiplier between octaves
+
+        // Member Functions
+        private:
+            void addOctave(float*, const float, const float, const float,
+                           const float, const uint32_t) const;
+
+        public:
+            FractalNoise(const uint32_t s, const int o, const float f,
+                         const float l=2.0f, const float g=0.5f)
+            : seed(s), octaves(o), frequency(f), lacunarity(l), gain(g) {}
+
+            void fillRow(float*, const int, const float, const float) const;
+    };
+}
+
+#endif
@@ -0,0 +1,160 @@
+#include "Occupation.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    OccupationTablePtr OccupationTable::instance;
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : OccupationTable::OccupationTable
+        Description : Reads the occupations file.  Each line has the form
+                      "Name:Weapon:"; identical lines are counted as one entry with a
+                      higher weight.  Entries keep the order in which they first
+                      appear.
+        Inputs      : file name
+        Outputs     : aborts if the file has no occupations
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    OccupationTable::OccupationTable(const string& filename)
+    : totalWeight(0)
+    {
+        ifstream input(filename.c_str());
+        map<string, size_t> seen;
+
+        string line;
+        while(getline(input, line))
+        {
+            if(!line.empty() && line[line.size()-1] == '\r') line.erase(line.size()-1);
+            if(line.empty()) continue;
+
+            map<string, size_t>::iterator it = seen.find(line);
+            if(it != seen.end())
+            {
+                ++weights[it->second];
+            }
+            else
+            {
+                size_t colon = line.find(':');
+                Occupation occupation;
+                occupation.name = line.substr(0, colon);
+                if(colon != string::npos)
+                    occupation.weapon = line.substr(colon+1, line.find(':', colon+1) - colon - 1);
+
+                seen[line] = occupations.size();
+                occupations.push_back(occupation);
+                weights.push_back(1);
+            }
+            ++totalWeight;
+        }
+
+        if(occupations.empty())
+        {
+            fatalError("No occupations found in " + filename);
+        }
+
+        buildAliasTable();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : OccupationTable::get
+        Description : Returns the table read from datafiles/occupations.txt, reading
+                      it the first time it is asked for.
+        Inputs      : None
+        Outputs     : None
+        Return      : OccupationTablePtr
+    --------------------------------------------------------------------------------*/
+    OccupationTablePtr OccupationTable::get()
+    {
+        if(instance.get() == 0)
+        {
+            instance.reset(new OccupationTable("./datafiles/occupations.txt"));
+        }
+        return instance;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : OccupationTable::buildAliasTable
+        Description : Builds the alias table (Vose's method).  Every column holds
+                      totalWeight draws.  Entry i owns weight*n of the draws in
+                      total; entries with less than a column's worth fill the
+                      rest of their column from an entry with more, until every
+                      column is full.
+        Inputs      : None
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void OccupationTable::buildAliasTable()
+    {
+        int n = occupations.size();
+        threshold.assign(n, totalWeight);
+        alias.resize(n);
+
+        vector<int> scaled(n);
+        vector<int> small, large;
+        for(int i=0; i<n; ++i)
+        {
+            alias[i] = i;
+            scaled[i] = weights[i] * n;
+            if(scaled[i] < totalWeight) small.push_back(i);
+            else                        large.push_back(i);
+        }
+
+        while(!small.empty() && !large.empty())
+        {
+            int s = small.back(); small.pop_back();
+            int l = large.back(); large.pop_back();
+
+            threshold[s] = scaled[s];
+            alias[s] = l;
+
+            scaled[l] -= totalWeight - scaled[s];
+            if(scaled[l] < totalWeight) small.push_back(l);
+            else                        large.push_back(l);
+        }
+
+        // whatever is left owns exactly a full column
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : OccupationTable::choose
+        Description : Draws an occupation, with probability proportional to its
+                      weight.
+        Inputs      : None
+        Outputs     : None
+        Return      : const Occupation&
+    --------------------------------------------------------------------------------*/
+    const Occupation& OccupationTable::choose() const
+    {
+        int column = randomInt(0, occupations.size()-1);
+        int draw = randomInt(0, totalWeight-1);
+        return occupations[draw < threshold[column] ? column : alias[column]];
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : OccupationTable::chooseMany
+        Description : Draws several occupations at once, for rolling up a whole
+                      funnel of characters.
+        Inputs      : vector to fill, number of draws
+        Outputs     : the chosen occupations are appended
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void OccupationTable::chooseMany(vector<const Occupation*>& chosen, const size_t count) const
+    {
+        chosen.reserve(chosen.size() + count);
+        for(size_t i=0; i<count; ++i)
+        {
+            chosen.push_back(&choose());
+        }
+    }
+}
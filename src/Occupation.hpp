@@ -0,0 +1,76 @@
+#ifndef RLNS_OCCUPATION_HPP
+#define RLNS_OCCUPATION_HPP
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Dice.hpp"
+#include "Types.hpp"
+#include "Utility.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : Occupation
+        Description : A character's trade before adventuring, and the weapon they
+                      learned to use in it.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    struct Occupation
+    {
+        std::string name;
+        std::string weapon;
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : OccupationTable
+        Description : The occupations from occupations.txt, read once.  The file
+                      weights an occupation by listing it more than once; the table
+                      collapses the repeats into a single entry with a weight, and
+                      draws from the weighted entries in constant time with an alias
+                      table.  Each column of the alias table holds one entry's share
+                      of the draws and tops it up with another entry's, so a draw is
+                      one column pick and one threshold test.  Weights are integers,
+                      so the thresholds are exact.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class OccupationTable
+    {
+        // Member Variables
+        private:
+            static OccupationTablePtr instance;
+
+            std::vector<Occupation> occupations;
+            std::vector<int> weights;
+            int totalWeight;
+
+            std::vector<int> threshold; // draws below this keep the column's entry
+            std::vector<int> alias;     // entry used for the rest of the column
+
+        // Member Functions
+        private:
+            void buildAliasTable();
+
+        public:
+            OccupationTable(const std::string&);
+
+            static OccupationTablePtr get();
+
+            size_t size() const                      { return occupations.size(); }
+            const Occupation& at(const size_t i) const { return occupations.at(i); }
+            int getWeight(const size_t i) const      { return weights.at(i); }
+
+            const Occupation& choose() const;
+            void chooseMany(std::vector<const Occupation*>&, const size_t) const;
+    };
+}
+
+#endif
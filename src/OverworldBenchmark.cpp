@@ -0,0 +1,126 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GeneratorRegistry.hpp"
+#include "Map.hpp"
+#include "OverworldBuilder.hpp"
+#include "Tile.hpp"
+#include "Tileset.hpp"
+#include "Types.hpp"
+
+using namespace std;
+using namespace rlns;
+
+typedef chrono::steady_clock Clock;
+
+/*--------------------------------------------------------------------------------
+    Function    : millisecondsSince
+    Description : Returns the time elapsed since the given point.
+    Inputs      : start time
+    Outputs     : None
+    Return      : double (milliseconds)
+--------------------------------------------------------------------------------*/
+static double millisecondsSince(const Clock::time_point start)
+{
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : addSizedTileset
+    Description : Adds a copy of the Plains tileset whose maps have the given
+                  size.  The BSP goes two levels deeper than the shipped one's,
+                  so the leaves of a large map stay about as big.
+    Inputs      : map width and height
+    Outputs     : None
+    Return      : TilesetPtr
+--------------------------------------------------------------------------------*/
+static TilesetPtr addSizedTileset(const int width, const int height)
+{
+    const Tileset& t = *Tileset::findTileset("Plains");
+    temp_tileset sized = { "Plains benchmark", t.getType(),
+                           t.getFloorTileID(), t.getWallTileID(), t.getFillerTileID(),
+                           t.getUpStairTileID(), t.getDownStairTileID(),
+                           t.getN_S_DoorID(), t.getE_W_DoorID(), t.getAmbientLight(),
+                           width, height, t.getRecurseLevel() + 2,
+                           t.getMinHSize(), t.getMinVSize(),
+                           t.getMaxHRatio(), t.getMaxVRatio() };
+    TilesetPtr tileset(new Tileset(sized));
+    Tileset::list.push_back(tileset);
+    return tileset;
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : main
+    Description : Times generating an overworld map with OverworldBuilder.  For
+                  each seed it times the noise alone, every row evaluated on
+                  this thread, then making the Map and building it.  The map
+                  is streamed, so building generates every chunk as the areas
+                  are found and swaps it out again; the last column is the map's
+                  memory once built, which stays bounded however large the map
+                  is.  Run from the directory that holds datafiles/.
+    Inputs      : optional map size (default 1000), number of seeds (default 3)
+                  and first seed (default 1)
+    Outputs     : a table on stdout
+    Return      : int (0 if every map was built in under a second)
+--------------------------------------------------------------------------------*/
+int main(int argc, char* argv[])
+{
+    int size = (argc > 1) ? atoi(argv[1]) : 1000;
+    int numSeeds = (argc > 2) ? atoi(argv[2]) : 3;
+    uint32_t seed = (argc > 3) ? strtoul(argv[3], NULL, 10) : 1;
+    if(size < 10) size = 10;
+    if(numSeeds < 1) numSeeds = 1;
+
+    TileParser("./datafiles/tiles.txt").run();
+    TilesetParser("./datafiles/tileset.txt").run();
+    TilesetPtr tileset = addSizedTileset(size, size);
+
+    cout << size << "x" << size << " overworld, " << thread::hardware_concurrency()
+         << " hardware threads" << endl;
+    cout << right << setw(8) << "seed" << setw(12) << "noise ms" << setw(12) << "map ms"
+         << setw(12) << "build ms" << setw(12) << "total ms" << setw(8) << "areas"
+         << setw(12) << "map KiB" << endl;
+    cout << fixed << setprecision(2);
+
+    vector<int> row(size);
+    double worst = 0;
+    for(int s=0; s<numSeeds; ++s, ++seed)
+    {
+        Clock::time_point start = Clock::now();
+        OverworldTerrain terrain(*tileset, seed);
+        for(int y=0; y<size; ++y)
+        {
+            terrain.fillRow(&row[0], size, 0, y);
+        }
+        double noiseTime = millisecondsSince(start);
+
+        start = Clock::now();
+        MapPtr map(new Map(tileset));
+        double mapTime = millisecondsSince(start);
+
+        start = Clock::now();
+        MapBuilderPtr builder = GeneratorRegistry::createBuilder(map);
+        builder->setSeed(seed);
+        builder->buildMap();
+        double buildTime = millisecondsSince(start);
+
+        double total = mapTime + buildTime;
+        if(total > worst) worst = total;
+        cout << setw(8) << seed << setw(12) << noiseTime << setw(12) << mapTime
+             << setw(12) << buildTime << setw(12) << total
+             << setw(8) << builder->getAreas().size()
+             << setw(12) << map->memoryUsage()/1024 << endl;
+    }
+
+    cout << "slowest map took " << worst << " ms" << endl;
+    return (worst < 1000.0) ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+#include "GeneratorRegistry.hpp"
+#include "OverworldBuilder.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    // the Overworld tileset is built by OverworldBuilder
+    static const bool registered = GeneratorRegistry::registerBuilder(OVERWORLD, &makeBuilder<OverworldBuilder>);
+
+    // and streamed, its chunks generated by OverworldChunkSource
+    static const bool streamed = GeneratorRegistry::registerChunkSource(OVERWORLD, &makeChunkSource<OverworldChunkSource>);
+
+    // terrain thresholds, on the [0,1) noise scale
+    static const float MOUNTAIN_LEVEL = 0.68f;
+    static const float DRY_LEVEL = 0.40f;
+    static const float WET_LEVEL = 0.60f;
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : OverworldTerrain::OverworldTerrain
+        Description : Constructor for the OverworldTerrain class.  Elevation varies
+                      over a few dozen tiles; moisture varies more slowly, so the
+                      grasslands form broad bands.
+        Inputs      : tileset, seed
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    OverworldTerrain::OverworldTerrain(const Tileset& t, const uint32_t seed)
+    : elevation(seed, 6, 1.0f/64),
+      moisture(seed ^ 0x5BD1E995u, 4, 1.0f/128),
+      mountainID(t.getWallTileID()),
+      grassID(t.getFloorTileID(0)),
+      highGrassID(t.getFloorTileID(1)),
+      dirtID(t.getFloorTileID(2)) {}
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : OverworldTerrain::fillRow
+        Description : Computes the tile IDs of count consecutive tiles of a row,
+                      starting at (x0, y).
+        Inputs      : output array, number of tiles, x coordinate of the first tile,
+                      row y coordinate
+        Outputs     : tile IDs
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void OverworldTerrain::fillRow(int* ids, const int count, const int x0, const int y) const
+    {
+        float height[SEGMENT];
+        float wetness[SEGMENT];
+
+        for(int start=0; start<count; start+=SEGMENT)
+        {
+            int n = min(SEGMENT, count - start);
+            elevation.fillRow(height, n, x0 + start, y);
+            moisture.fillRow(wetness, n, x0 + start, y);
+
+            for(int i=0; i<n; ++i)
+            {
+                if(height[i] > MOUNTAIN_LEVEL)  ids[start+i] = mountainID;
+                else if(wetness[i] < DRY_LEVEL) ids[start+i] = dirtID;
+                else if(wetness[i] > WET_LEVEL) ids[start+i] = highGrassID;
+                else                            ids[start+i] = grassID;
+            }
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : OverworldChunkSource::OverworldChunkSource
+        Description : Constructor for the OverworldChunkSource class.
+        Inputs      : tileset, seed
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    OverworldChunkSource::OverworldChunkSource(const Tileset& t, const uint32_t seed)
+    : terrain(t, seed),
+      width(t.getMapWidth()),
+      height(t.getMapHeight()),
+      wallID(t.getWallTileID()) {}
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : OverworldChunkSource::generateChunk
+        Description : Fills a chunk with terrain a row at a time.  Tiles on the
+                      border of the map, or past it in the chunks along the right
+                      and bottom edges, are mountains.
+        Inputs      : chunk to fill
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void OverworldChunkSource::generateChunk(MapChunk& chunk) const
+    {
+        int ids[MapChunk::SIZE];
+        int x0 = chunk.getOrigin().X();
+        int y0 = chunk.getOrigin().Y();
+
+        for(int y=y0; y<y0+MapChunk::SIZE; ++y)
+        {
+            terrain.fillRow(ids, MapChunk::SIZE, x0, y);
+            for(int i=0; i<MapChunk::SIZE; ++i)
+            {
+                int x = x0 + i;
+                bool border = (x <= 0 || y <= 0 || x >= width-1 || y >= height-1);
+                chunk.setBottomMostAt(x,y, border ? wallID : ids[i]);
+            }
+        }
+    }
+}
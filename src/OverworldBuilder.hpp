@@ -0,0 +1,149 @@
+#ifndef RLNS_OVERWORLDBUILDER_HPP
+#define RLNS_OVERWORLDBUILDER_HPP
+
+#include <algorithm>
+#include <vector>
+
+#include <stdint.h>
+
+#include "Area.hpp"
+#include "MapBuilder.hpp"
+#include "Noise.hpp"
+#include "PhasedBuilder.hpp"
+#include "Tileset.hpp"
+#include "Utility.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : OverworldTerrain
+        Description : Turns two noise fields, elevation and moisture, into tile IDs.
+                      High ground becomes the tileset's wall tile (mountains); the
+                      rest is dry dirt, grass or high grass by moisture.  The tileset
+                      must list grass, high grass and dirt as its first three floor
+                      tiles.  Terrain depends only on the seed and the coordinates,
+                      so a row can be evaluated on any thread, in any order.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class OverworldTerrain
+    {
+        // Static Variables
+        public:
+            static const int SEGMENT = 256; // samples evaluated per noise call
+
+        // Member Variables
+        private:
+            FractalNoise elevation;
+            FractalNoise moisture;
+            int mountainID, grassID, highGrassID, dirtID;
+
+        // Member Functions
+        public:
+            OverworldTerrain(const Tileset&, const uint32_t);
+
+            void fillRow(int*, const int, const int, const int) const;
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : OverworldChunkSource
+        Description : Generates the chunks of a streamed Overworld map from
+                      OverworldTerrain.  The map border is sealed with mountains.
+        Parents     : ChunkSource
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class OverworldChunkSource: public ChunkSource
+    {
+        // Member Variables
+        private:
+            OverworldTerrain terrain;
+            int width, height;
+            int wallID;
+
+        // Member Functions
+        public:
+            OverworldChunkSource(const Tileset&, const uint32_t);
+
+            virtual void generateChunk(MapChunk&) const;
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : NoiseCarver
+        Description : Carving policy that starts the map generating its terrain
+                      from OverworldTerrain, a chunk at a time as it is used, with
+                      a seed drawn from the builder.  Nothing is generated yet;
+                      every BSP leaf becomes an Area, and the ones without enough
+                      open tiles are dropped by OverworldFinisher once the builder
+                      has found their open cells, so the map is only read through
+                      once.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    struct NoiseCarver
+    {
+        template<class Builder>
+        static void run(Builder& b)
+        {
+            b.map->generateFrom(b.rand.getInt(0, 0x7FFFFFFF));
+
+            // add Areas
+            std::vector<AreaPtr> leaves;
+            b.bsp->getLeafAreas(leaves);
+            for(size_t i=0; i<leaves.size(); ++i)
+            {
+                b.addArea(leaves[i]);
+            }
+        }
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : OverworldFinisher
+        Description : Finishing policy that drops the areas with too few open tiles
+                      to place anything in, then places the stairs and makes sure
+                      they are connected.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    struct OverworldFinisher
+    {
+        static const size_t MIN_OPEN_CELLS = 10;
+
+        template<class Builder>
+        static void run(Builder& b)
+        {
+            std::vector<AreaPtr>& areas = b.areas;
+            areas.erase(std::remove_if(areas.begin(), areas.end(), [](const AreaPtr& area)
+                        { return area->getNumOpenCells() < MIN_OPEN_CELLS; }), areas.end());
+
+            b.placeStairs();
+            ensureStairsAreReachable(b.map, b.rand);
+        }
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : OverworldBuilder
+        Description : Builds the Overworld tileset map from elevation and moisture
+                      noise.  The terrain is open, so areas are not connected.
+        Parents     : PhasedBuilder
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    typedef PhasedBuilder< BSPPartition,
+                           NoiseCarver,
+                           NoConnector,
+                           OverworldFinisher > OverworldBuilder;
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "Party.hpp"
+#include "Pool.hpp"
 
 namespace rlns
 {
@@ -15,4 +16,104 @@ namespace rlns
     {
         members.at(leader)->shiftPosition(dir);
     }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Party::Party(SaveReader&)
+        Description : Loads a party written by saveToDisk.
+        Inputs      : save file
+        Outputs     : throws runtime_error if the party is damaged
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    Party::Party(SaveReader& save)
+    : leader(0)
+    {
+        leader = save.get<uint32_t>();
+        size_t numMembers = save.get<uint32_t>();
+
+        for(size_t i=0; i<numMembers; ++i)
+        {
+            int ch = save.get<int32_t>();
+            TCODColor color = save.getColor();
+            int x = save.get<int32_t>();
+            int y = save.get<int32_t>();
+
+            ActorPtr member = allocatePooled<Actor>(Arena::global(), "Actor", Point(x,y), ch, color);
+
+            std::vector<ItemPtr> items;
+            Item::loadList(save, items);
+            for(size_t j=0; j<items.size(); ++j)
+            {
+                member->giveItem(items[j]);
+            }
+
+            members.push_back(member);
+        }
+
+        if(!members.empty() && leader >= members.size())
+        {
+            throw std::runtime_error("save file is damaged");
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Party::takeSnapshot
+        Description : Copies the party with everything saveToDisk writes: each
+                      member's look, position and a copy of each item carried.  The
+                      copy can be saved on another thread while this party moves on.
+        Inputs      : None
+        Outputs     : None
+        Return      : PartyPtr
+    --------------------------------------------------------------------------------*/
+    PartyPtr Party::takeSnapshot() const
+    {
+        PartyPtr copy(new Party());
+        copy->leader = leader;
+
+        for(size_t i=0; i<members.size(); ++i)
+        {
+            const Actor& member = *members[i];
+            ActorPtr memberCopy = allocatePooled<Actor>(Arena::global(), "Actor", member.getPosition(),
+                                                        member.getChar(), member.getFgColor());
+
+            const std::vector<ItemPtr>& items = member.getInventory().getMiscItems();
+            for(size_t j=0; j<items.size(); ++j)
+            {
+                memberCopy->giveItem(allocatePooled<Item>(Arena::global(), "Item", *items[j]));
+            }
+
+            copy->members.push_back(memberCopy);
+        }
+
+        return copy;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Party::saveToDisk
+        Description : Saves the party: the leader, then each member's look,
+                      position and inventory.
+        Inputs      : save file
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Party::saveToDisk(SaveWriter& save) const
+    {
+        save.put<uint32_t>(leader);
+        save.put<uint32_t>(members.size());
+
+        for(size_t i=0; i<members.size(); ++i)
+        {
+            const Actor& member = *members[i];
+            save.put<int32_t>(member.getChar());
+            save.putColor(member.getFgColor());
+            save.put<int32_t>(member.getPosition().X());
+            save.put<int32_t>(member.getPosition().Y());
+            Item::saveList(save, member.getInventory().getMiscItems());
+        }
+    }
 }
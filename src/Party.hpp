@@ -2,7 +2,10 @@
 #define RLNS_PARTY_HPP
 
 #include "Actor.hpp"
+#include "Item.hpp"
+#include "SaveFile.hpp"
 
+#include <stdexcept>
 #include <vector>
 
 namespace rlns
@@ -36,6 +39,7 @@ namespace rlns
             Party(): leader(0) {}
             Party(std::vector<ActorPtr> m)
             : members(m), leader(0) {}
+            Party(SaveReader&);
 
             ActorPtr getLeader() const { return members.at(leader); }
             void setLeader(const size_t l) { leader = l; }
@@ -45,8 +49,12 @@ namespace rlns
 
             void moveLeader(const DirectionType);
 
+            PartyPtr takeSnapshot() const;
+            void saveToDisk(SaveWriter&) const;
+
         // Static Functions
             static PartyPtr getPlayerParty() { return playerParty; }
+            static void setPlayerParty(const PartyPtr p) { playerParty = p; }
     };
 
 
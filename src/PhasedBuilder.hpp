@@ -0,0 +1,120 @@
+#ifndef RLNS_PHASEDBUILDER_HPP
+#define RLNS_PHASEDBUILDER_HPP
+
+#include "BSPTree.hpp"
+#include "MapBuilder.hpp"
+#include "Tileset.hpp"
+#include "Types.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : WrappedPolicy
+        Description : Names the policy that a wrapping policy runs, so that
+                      PhasedBuilder can befriend it too.  A policy that runs another
+                      one specialises this; for every other policy it is the policy
+                      itself.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    template<class Policy>
+    struct WrappedPolicy
+    {
+        typedef Policy type;
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : PhasedBuilder
+        Description : A MapBuilder assembled at compile time from four phase
+                      policies.  Each policy is a class with a static run() template
+                      that receives the builder.  Because the policies are known at
+                      compile time, their per-cell loops are inlined and specialised
+                      instead of being reached through virtual calls.
+
+                      Partitioner - splits the map into regions
+                      Carver      - digs areas out of the regions and adds them
+                                    to the builder
+                      Connector   - joins the areas together
+                      Finisher    - walls, doors, stairs and other final touches
+        Parents     : MapBuilder
+        Children    : None
+        Friends     : the four phase policies and the policies they wrap
+    --------------------------------------------------------------------------------*/
+    template<class Partitioner, class Carver, class Connector, class Finisher>
+    class PhasedBuilder: public MapBuilder
+    {
+        friend Partitioner;
+        friend Carver;
+        friend Connector;
+        friend Finisher;
+        friend typename WrappedPolicy<Partitioner>::type;
+        friend typename WrappedPolicy<Carver>::type;
+        friend typename WrappedPolicy<Connector>::type;
+        friend typename WrappedPolicy<Finisher>::type;
+
+        // Member Functions
+        public:
+            PhasedBuilder(const MapPtr m)
+            : MapBuilder(m) {}
+
+            void buildMap()
+            {
+                Partitioner::run(*this);
+                Carver::run(*this);
+                findOpenCells();
+                Connector::run(*this);
+                Finisher::run(*this);
+                findOpenCells();
+            }
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : BSPPartition
+        Description : Partitioning policy that builds and splits the builder's BSP
+                      tree.  The root node covers all of the internal tiles of the
+                      map, so that no room opens onto the edge of the map.  Split
+                      parameters come from the map's tileset.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    struct BSPPartition
+    {
+        template<class Builder>
+        static void run(Builder& b)
+        {
+            // topleft corner of the root node
+            int x = 1, y = 1;
+            // bottomright corner of the root node
+            //
+            // For some reason, w needs to be set to Width-2, otherwise rooms can run
+            // a tile over the eastern edge of the map. h is fine to be set at Height-1.
+            int w = b.map->getWidth()-2, h = b.map->getHeight()-1;
+            b.bsp.reset(new BSPTree(x,y,w,h));
+            b.bsp->splitRecursive(b.rand, *b.map->tileset);
+        }
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : NoConnector
+        Description : Connection policy for maps whose carver already leaves the
+                      areas joined, such as open terrain.  Does nothing.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    struct NoConnector
+    {
+        template<class Builder>
+        static void run(Builder&) {}
+    };
+}
+
+#endif
@@ -0,0 +1,361 @@
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+#include "Pool.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    const size_t Arena::MAX_KINDS;
+
+    static const size_t SLAB_BYTES = 16 * 1024;
+    static const size_t ALIGNMENT = alignof(max_align_t);
+
+    /*--------------------------------------------------------------------------------
+        Function    : blockSizeFor
+        Description : Returns the size of the blocks that objects of the given size
+                      are kept in: big enough to hold a free list link, and a
+                      multiple of the strictest alignment.
+        Inputs      : object size
+        Outputs     : None
+        Return      : size_t
+    --------------------------------------------------------------------------------*/
+    static size_t blockSizeFor(const size_t size)
+    {
+        return (max(size, sizeof(void*)) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : counterTable
+        Description : Returns the counters of every kind of object seen so far, and
+                      the lock guarding the table.  They are never freed, since
+                      pools in the global arena may outlive static destruction.
+        Inputs      : None
+        Outputs     : None
+        Return      : map of names to counters
+    --------------------------------------------------------------------------------*/
+    static map<string, PoolCounters*>& counterTable(mutex*& lock)
+    {
+        static map<string, PoolCounters*>* table = new map<string, PoolCounters*>;
+        static mutex* tableLock = new mutex;
+        lock = tableLock;
+        return *table;
+    }
+
+
+
+    // name and block size of a kind of pooled object
+    typedef pair<const char*, size_t> PoolKind;
+
+    /*--------------------------------------------------------------------------------
+        Function    : kindTable
+        Description : Returns every kind of pooled object numbered so far, and the
+                      lock guarding the table.  Never freed, like the counters.
+        Inputs      : None
+        Outputs     : None
+        Return      : vector of kinds, by number
+    --------------------------------------------------------------------------------*/
+    static vector<PoolKind>& kindTable(mutex*& lock)
+    {
+        static vector<PoolKind>* table = new vector<PoolKind>;
+        static mutex* tableLock = new mutex;
+        lock = tableLock;
+        return *table;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : PoolCounters::raise
+        Description : Raises a peak to the given value if it is lower.
+        Inputs      : peak, value
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void PoolCounters::raise(atomic<size_t>& peak, const size_t value)
+    {
+        size_t seen = peak.load();
+        while(seen < value && !peak.compare_exchange_weak(seen, value)) {}
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : PoolCounters::getStats
+        Description : Returns the counters as they are now.
+        Inputs      : None
+        Outputs     : None
+        Return      : PoolStats
+    --------------------------------------------------------------------------------*/
+    PoolStats PoolCounters::getStats() const
+    {
+        PoolStats stats = { name, live.load(), peak.load(), total.load(), bytes.load(), peakBytes.load() };
+        return stats;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : PoolCounters::find
+        Description : Returns the counters for a kind of object, making them the
+                      first time the name is seen.
+        Inputs      : name
+        Outputs     : None
+        Return      : PoolCounters&
+    --------------------------------------------------------------------------------*/
+    PoolCounters& PoolCounters::find(const char* name)
+    {
+        mutex* lock;
+        map<string, PoolCounters*>& table = counterTable(lock);
+        lock_guard<mutex> guard(*lock);
+
+        PoolCounters*& counters = table[name];
+        if(counters == NULL) counters = new PoolCounters(name);
+        return *counters;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : PoolCounters::getAll
+        Description : Returns the statistics of every kind of object, by name.
+        Inputs      : None
+        Outputs     : None
+        Return      : vector<PoolStats>
+    --------------------------------------------------------------------------------*/
+    vector<PoolStats> PoolCounters::getAll()
+    {
+        mutex* lock;
+        map<string, PoolCounters*>& table = counterTable(lock);
+        lock_guard<mutex> guard(*lock);
+
+        vector<PoolStats> all;
+        map<string, PoolCounters*>::const_iterator it, end;
+        it = table.begin(); end = table.end();
+        for(; it!=end; ++it)
+        {
+            all.push_back(it->second->getStats());
+        }
+        return all;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Pool::Pool
+        Description : Makes an empty pool whose slabs hold about 16 KB.
+        Inputs      : name counted under, block size
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    Pool::Pool(const char* n, const size_t size)
+    : name(n), blockSize(blockSizeFor(size)), blocksPerSlab(max<size_t>(SLAB_BYTES / blockSize, 16)),
+      freeList(NULL), carved(blocksPerSlab), counters(PoolCounters::find(n)) {}
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Pool::~Pool
+        Description : Frees every slab.  Blocks still out are freed with them, so
+                      the pool must outlive everything allocated from it.
+        Inputs      : None
+        Outputs     : None
+        Return      : None (destructor)
+    --------------------------------------------------------------------------------*/
+    Pool::~Pool()
+    {
+        for(size_t i=0; i<slabs.size(); ++i)
+        {
+            ::operator delete(slabs[i]);
+        }
+        counters.slabsFreed(memoryUsage());
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Pool::allocate
+        Description : Returns an unused block, adding a slab if there is none.
+        Inputs      : None
+        Outputs     : None
+        Return      : void*
+    --------------------------------------------------------------------------------*/
+    void* Pool::allocate()
+    {
+        lock_guard<mutex> guard(lock);
+        void* block;
+        if(freeList != NULL)
+        {
+            block = freeList;
+            memcpy(&freeList, block, sizeof(void*));
+        }
+        else
+        {
+            if(carved == blocksPerSlab)
+            {
+                slabs.push_back(static_cast<char*>(::operator new(blocksPerSlab * blockSize)));
+                carved = 0;
+                counters.slabAdded(blocksPerSlab * blockSize);
+            }
+            block = slabs.back() + carved * blockSize;
+            ++carved;
+        }
+
+        counters.allocated();
+        return block;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Pool::deallocate
+        Description : Takes back a block for reuse.
+        Inputs      : block from allocate()
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Pool::deallocate(void* block)
+    {
+        lock_guard<mutex> guard(lock);
+        memcpy(block, &freeList, sizeof(void*));
+        freeList = block;
+        counters.freed();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Pool::memoryUsage
+        Description : Returns the bytes of slabs the pool holds.
+        Inputs      : None
+        Outputs     : None
+        Return      : size_t
+    --------------------------------------------------------------------------------*/
+    size_t Pool::memoryUsage() const
+    {
+        lock_guard<mutex> guard(lock);
+        return slabs.size() * blocksPerSlab * blockSize;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Arena::Arena
+        Description : Makes an arena with no pools.
+        Inputs      : None
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    Arena::Arena()
+    {
+        for(size_t i=0; i<MAX_KINDS; ++i)
+        {
+            byKind[i].store(NULL);
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Arena::findKind
+        Description : Returns the number of the kind of object counted under the
+                      given name and kept in blocks for the given size, numbering
+                      it the first time it is seen.  Kinds are shared by every
+                      arena and never forgotten.
+        Inputs      : name, object size
+        Outputs     : throws runtime_error if there are more than MAX_KINDS kinds
+        Return      : size_t
+    --------------------------------------------------------------------------------*/
+    size_t Arena::findKind(const char* name, const size_t size)
+    {
+        mutex* lock;
+        vector<PoolKind>& kinds = kindTable(lock);
+        lock_guard<mutex> guard(*lock);
+
+        size_t blockSize = blockSizeFor(size);
+        for(size_t i=0; i<kinds.size(); ++i)
+        {
+            if(kinds[i].second == blockSize && strcmp(kinds[i].first, name) == 0) return i;
+        }
+        if(kinds.size() == MAX_KINDS) throw runtime_error("too many kinds of pooled object");
+
+        kinds.push_back(make_pair(name, blockSize));
+        return kinds.size() - 1;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Arena::poolFor
+        Description : Returns the arena's pool for a kind of object, making it the
+                      first time.  Once made, a pool is found without locking.
+        Inputs      : kind from findKind()
+        Outputs     : None
+        Return      : Pool&
+    --------------------------------------------------------------------------------*/
+    Pool& Arena::poolFor(const size_t kind)
+    {
+        Pool* pool = byKind[kind].load(memory_order_acquire);
+        if(pool != NULL) return *pool;
+
+        lock_guard<mutex> guard(lock);
+        pool = byKind[kind].load(memory_order_relaxed);
+        if(pool == NULL)
+        {
+            mutex* kindsLock;
+            vector<PoolKind>& kinds = kindTable(kindsLock);
+            PoolKind k;
+            {
+                lock_guard<mutex> kindsGuard(*kindsLock);
+                k = kinds.at(kind);
+            }
+
+            pool = new Pool(k.first, k.second);
+            pools.push_back(PoolPtr(pool));
+            byKind[kind].store(pool, memory_order_release);
+        }
+        return *pool;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Arena::memoryUsage
+        Description : Returns the bytes of slabs the arena holds.
+        Inputs      : None
+        Outputs     : None
+        Return      : size_t
+    --------------------------------------------------------------------------------*/
+    size_t Arena::memoryUsage()
+    {
+        lock_guard<mutex> guard(lock);
+        size_t bytes = 0;
+        for(size_t i=0; i<pools.size(); ++i)
+        {
+            bytes += pools[i]->memoryUsage();
+        }
+        return bytes;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Arena::global
+        Description : Returns the arena for objects not tied to a level.  It is
+                      never freed, so objects may still be let go during static
+                      destruction.
+        Inputs      : None
+        Outputs     : None
+        Return      : ArenaPtr
+    --------------------------------------------------------------------------------*/
+    ArenaPtr Arena::global()
+    {
+        static ArenaPtr* arena = new ArenaPtr(new Arena);
+        return *arena;
+    }
+}
@@ -0,0 +1,235 @@
+#ifndef RLNS_POOL_HPP
+#define RLNS_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/make_shared.hpp>
+
+#include "Types.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Struct      : PoolStats
+        Description : What the pools of one kind of object hold, over every arena:
+                      objects alive now, at most and ever, and bytes of slabs now
+                      and at most.
+    --------------------------------------------------------------------------------*/
+    struct PoolStats
+    {
+        std::string name;
+        size_t live, peak;
+        size_t total; // ever allocated
+        size_t bytes, peakBytes;
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : PoolCounters
+        Description : The running totals behind a PoolStats.  There is one for each
+                      kind of object, shared by all of its pools and kept for the
+                      life of the program, so they can be read while pools come and
+                      go on other threads.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class PoolCounters
+    {
+        // Member Variables
+        private:
+            std::string name;
+            std::atomic<size_t> live, peak, total;
+            std::atomic<size_t> bytes, peakBytes;
+
+        // Member Functions
+        private:
+            static void raise(std::atomic<size_t>&, const size_t);
+
+        public:
+            PoolCounters(const std::string& n)
+            : name(n), live(0), peak(0), total(0), bytes(0), peakBytes(0) {}
+
+            void allocated()  { raise(peak, ++live); ++total; }
+            void freed()      { --live; }
+            void slabAdded(const size_t n)   { raise(peakBytes, bytes += n); }
+            void slabsFreed(const size_t n)  { bytes -= n; }
+            PoolStats getStats() const;
+
+            static PoolCounters& find(const char*);
+            static std::vector<PoolStats> getAll();
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : Pool
+        Description : Hands out blocks of one size, carved from slabs of many blocks
+                      at a time.  Blocks never move, so a pointer to one stays good
+                      until it is given back; given back blocks are reused before
+                      the slab is carved further.  Slabs are only freed with the
+                      pool, all at once.  Thread safe: each pool has its own lock,
+                      so allocating one kind of object never waits on another.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class Pool
+    {
+        // Member Variables
+        private:
+            const char* name;
+            size_t blockSize;
+            size_t blocksPerSlab;
+            std::vector<char*> slabs;
+            void* freeList;      // given back blocks, each holding the next
+            size_t carved;       // blocks used so far of the newest slab
+            PoolCounters& counters;
+            mutable std::mutex lock;
+
+        // Member Functions
+        public:
+            Pool(const char*, const size_t);
+            ~Pool();
+
+            const char* getName() const { return name; }
+            size_t getBlockSize() const { return blockSize; }
+
+            void* allocate();
+            void deallocate(void*);
+            size_t memoryUsage() const;
+
+        private:
+            Pool(const Pool&);
+            Pool& operator=(const Pool&);
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : Arena
+        Description : A set of pools, one for each kind and size of object
+                      allocated from it.  A level owns an arena for its items, so
+                      all of them are freed together, slabs and all, once the
+                      level and every item taken from it are gone; objects not
+                      tied to a level come from the global arena.  Each kind of
+                      object is numbered once for the whole program by findKind(),
+                      and an arena finds its pool for a kind by that number
+                      without locking; the arena's lock is only taken to make a
+                      pool.  Thread safe.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class Arena
+    {
+        // Member Variables
+        public:
+            static const size_t MAX_KINDS = 64;
+
+        private:
+            std::atomic<Pool*> byKind[MAX_KINDS]; // the pools made so far
+            std::vector<PoolPtr> pools;
+            std::mutex lock; // held while making a pool
+
+        // Member Functions
+        private:
+            Pool& poolFor(const size_t);
+
+        public:
+            Arena();
+
+            void* allocate(const size_t kind) { return poolFor(kind).allocate(); }
+            void deallocate(const size_t kind, void* block) { poolFor(kind).deallocate(block); }
+            size_t memoryUsage();
+
+            static size_t findKind(const char*, const size_t);
+            static ArenaPtr global();
+
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : PoolAllocator
+        Description : A standard allocator drawing single objects from an arena,
+                      under the name the objects are counted by.  Arrays are left
+                      to operator new.  Used with boost::allocate_shared, the object
+                      and its reference counts share one block.  A type is always
+                      counted under the same name, so its kind is looked up only
+                      the first time one is allocated.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    template<typename T>
+    class PoolAllocator
+    {
+        // Member Variables
+        public:
+            typedef T value_type;
+            template<typename U> struct rebind { typedef PoolAllocator<U> other; };
+
+            ArenaPtr arena;
+            const char* name;
+
+        // Member Functions
+        public:
+            PoolAllocator(const ArenaPtr& a, const char* n)
+            : arena(a), name(n) {}
+
+            template<typename U>
+            PoolAllocator(const PoolAllocator<U>& other)
+            : arena(other.arena), name(other.name) {}
+
+            T* allocate(const size_t n)
+            {
+                if(n != 1) return static_cast<T*>(::operator new(n * sizeof(T)));
+                return static_cast<T*>(arena->allocate(kind()));
+            }
+
+            void deallocate(T* p, const size_t n)
+            {
+                if(n != 1) ::operator delete(p);
+                else arena->deallocate(kind(), p);
+            }
+
+            size_t kind() const
+            {
+                static const size_t k = Arena::findKind(name, sizeof(T));
+                return k;
+            }
+
+            template<typename U>
+            bool operator==(const PoolAllocator<U>& other) const
+            { return arena == other.arena; }
+            template<typename U>
+            bool operator!=(const PoolAllocator<U>& other) const
+            { return arena != other.arena; }
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : allocatePooled
+        Description : Makes an object in the given arena, counted under the given
+                      name, with its reference counts in the same block.
+        Inputs      : arena, name, constructor arguments
+        Outputs     : None
+        Return      : boost::shared_ptr<T>
+    --------------------------------------------------------------------------------*/
+    template<typename T, typename... Args>
+    boost::shared_ptr<T> allocatePooled(const ArenaPtr& arena, const char* name, Args&&... args)
+    {
+        return boost::allocate_shared<T>(PoolAllocator<T>(arena, name), std::forward<Args>(args)...);
+    }
+}
+
+#endif
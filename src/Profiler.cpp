@@ -0,0 +1,109 @@
+#include <algorithm>
+
+#include "Profiler.hpp"
+#include "Pool.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Function    : StartupProfiler::markFirstFrame
+        Description : Records the time at which the first frame was drawn.  Only
+                      the first call counts.
+        Inputs      : None
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void StartupProfiler::markFirstFrame()
+    {
+        lock_guard<mutex> guard(lock);
+        if(firstFrame < 0.0) firstFrame = now();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : StartupProfiler::report
+        Description : Prints each recorded phase with its start time and duration,
+                      then the time to first frame.  Phases that overlapped ran in
+                      parallel.  The pools' statistics follow.
+        Inputs      : stream to print to
+        Outputs     : startup profile
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void StartupProfiler::report(ostream& out)
+    {
+        lock_guard<mutex> guard(lock);
+
+        out << "Startup profile (ms):" << endl;
+        out << fixed << setprecision(1);
+        for(size_t i=0; i<phases.size(); ++i)
+        {
+            out << "  " << left << setw(24) << phases[i].name << right
+                << " start " << setw(8) << phases[i].begin
+                << "  took " << setw(8) << phases[i].end - phases[i].begin << endl;
+        }
+        out << "  time to first frame: " << firstFrame << endl;
+        reportPools(out);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : StartupProfiler::reportPools
+        Description : Prints, for each kind of pooled object, how many are alive,
+                      the most there have been and how many were ever allocated,
+                      and the KB of slabs held now and at most.  May be called at
+                      any time.
+        Inputs      : stream to print to
+        Outputs     : pool statistics
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void StartupProfiler::reportPools(ostream& out)
+    {
+        vector<PoolStats> pools = PoolCounters::getAll();
+        out << "Memory pools:" << endl;
+        out << fixed << setprecision(1);
+        for(size_t i=0; i<pools.size(); ++i)
+        {
+            out << "  " << left << setw(24) << pools[i].name << right
+                << " live " << setw(8) << pools[i].live
+                << "  peak " << setw(8) << pools[i].peak
+                << "  allocated " << setw(10) << pools[i].total
+                << "  KB " << setw(8) << pools[i].bytes / 1024.0
+                << "  peak KB " << setw(8) << pools[i].peakBytes / 1024.0 << endl;
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : TurnProfiler::report
+        Description : Prints the number of turns recorded, their total and mean
+                      time, the median, the 99th percentile and the slowest.
+        Inputs      : stream to print to
+        Outputs     : turn profile
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void TurnProfiler::report(ostream& out) const
+    {
+        out << "Turn profile (ms): " << turns.size() << " turns" << endl;
+        if(turns.empty()) return;
+
+        vector<float> sorted(turns);
+        sort(sorted.begin(), sorted.end());
+        double total = 0.0;
+        for(size_t i=0; i<sorted.size(); ++i)
+        {
+            total += sorted[i];
+        }
+
+        out << fixed << setprecision(3);
+        out << "  total  " << setw(12) << total << endl;
+        out << "  mean   " << setw(12) << total / sorted.size() << endl;
+        out << "  median " << setw(12) << sorted[sorted.size() / 2] << endl;
+        out << "  99%    " << setw(12) << sorted[(sorted.size() - 1) * 99 / 100] << endl;
+        out << "  max    " << setw(12) << sorted.back() << endl;
+    }
+}
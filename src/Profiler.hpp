@@ -0,0 +1,110 @@
+#ifndef RLNS_PROFILER_HPP
+#define RLNS_PROFILER_HPP
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : StartupProfiler
+        Description : Records how long each startup phase took and when it ran,
+                      relative to the moment the profiler was created.  Phases may
+                      be timed from several threads at once.  Once the first frame
+                      has been drawn, report() prints every phase and the time to
+                      first frame.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class StartupProfiler
+    {
+        // Member Variables
+        private:
+            typedef std::chrono::steady_clock Clock;
+
+            struct Phase
+            {
+                std::string name;
+                double begin; // milliseconds since the profiler was created
+                double end;
+            };
+
+            Clock::time_point start;
+            std::vector<Phase> phases;
+            std::mutex lock;
+            double firstFrame; // milliseconds, or negative until it is marked
+
+        // Member Functions
+        private:
+            double now() const
+            { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); }
+
+        public:
+            StartupProfiler(): start(Clock::now()), firstFrame(-1.0) {}
+
+            /*--------------------------------------------------------------------------------
+                Function    : StartupProfiler::time
+                Description : Calls f and records how long it took under the given
+                              name.
+                Inputs      : phase name, function to call
+                Outputs     : None
+                Return      : void
+            --------------------------------------------------------------------------------*/
+            template<typename Function>
+            void time(const std::string& name, Function f)
+            {
+                double begin = now();
+                f();
+                double end = now();
+
+                std::lock_guard<std::mutex> guard(lock);
+                Phase phase = { name, begin, end };
+                phases.push_back(phase);
+            }
+
+            void markFirstFrame();
+            bool hasFirstFrame() const { return firstFrame >= 0.0; }
+            void report(std::ostream&);
+            static void reportPools(std::ostream&);
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : TurnProfiler
+        Description : Records how long each turn took, as when a recording is
+                      played back, and summarizes them.  The same recording
+                      played on two builds gives two summaries of the same turns
+                      that can be compared directly.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class TurnProfiler
+    {
+        // Member Variables
+        private:
+            typedef std::chrono::steady_clock Clock;
+
+            std::vector<float> turns; // milliseconds each
+            Clock::time_point begun;
+
+        // Member Functions
+        public:
+            TurnProfiler() {}
+
+            void beginTurn() { begun = Clock::now(); }
+            void endTurn()
+            { turns.push_back(std::chrono::duration<float, std::milli>(Clock::now() - begun).count()); }
+
+            size_t size() const { return turns.size(); }
+            void report(std::ostream&) const;
+    };
+}
+
+#endif
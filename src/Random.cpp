@@ -0,0 +1,217 @@
+#include "Random.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    // until seedStreams() is called, each stream starts from its own number
+    Random Random::streams[NUM_RANDOM_STREAMS] =
+    {
+        Random(STREAM_GENERATION), Random(STREAM_COMBAT), Random(STREAM_AI), Random(STREAM_LOOT)
+    };
+
+    /*--------------------------------------------------------------------------------
+        Function    : splitmix
+        Description : Steps a splitmix64 generator and returns its next number.
+                      Used to spread a seed over a generator's state, since the
+                      state must not be all zero and nearby seeds must not give
+                      nearby states.
+        Inputs      : splitmix state
+        Outputs     : the new state
+        Return      : uint64_t
+    --------------------------------------------------------------------------------*/
+    static uint64_t splitmix(uint64_t& x)
+    {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Random::seed
+        Description : Starts the generator again from the given seed.  The same
+                      seed always gives the same numbers.
+        Inputs      : seed
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Random::seed(const uint64_t s)
+    {
+        uint64_t x = s;
+        for(int i=0; i<4; ++i)
+        {
+            state[i] = splitmix(x);
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Random::getDouble
+        Description : Returns a number from low up to but not including high.
+        Inputs      : bounds
+        Outputs     : None
+        Return      : double
+    --------------------------------------------------------------------------------*/
+    double Random::getDouble(const double low, const double high)
+    {
+        double unit = (next() >> 11) * (1.0 / 9007199254740992.0); // 2^-53
+        return low + unit * (high - low);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Random::fill
+        Description : Fills an array with raw 64 bit numbers.
+        Inputs      : array, its length
+        Outputs     : the numbers
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Random::fill(uint64_t* out, const size_t n)
+    {
+        for(size_t i=0; i<n; ++i)
+        {
+            out[i] = next();
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Random::fillInts
+        Description : Fills an array with numbers from low to high, both included,
+                      the same numbers n calls to getInt() would give.
+        Inputs      : array, its length, bounds
+        Outputs     : the numbers
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Random::fillInts(int* out, const size_t n, const int low, const int high)
+    {
+        for(size_t i=0; i<n; ++i)
+        {
+            out[i] = getInt(low, high);
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Random::fillBelow
+        Description : Fills an array with numbers in [0, bound), bound > 0, for when
+                      many are wanted at once.  Each raw number gives two draws,
+                      and a block of draws is scaled by Lemire's method in a loop
+                      with no branches, which the compiler can vectorise; the rare
+                      draws that would bias the result are drawn again afterwards.
+                      The numbers are not the ones n calls to below() would give.
+        Inputs      : array, its length, bound
+        Outputs     : the numbers
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Random::fillBelow(uint32_t* out, const size_t n, const uint32_t bound)
+    {
+        static const size_t BLOCK = 256;
+        uint32_t draws[BLOCK];
+        const uint32_t threshold = (0u - bound) % bound;
+
+        for(size_t start=0; start<n; start+=BLOCK)
+        {
+            size_t count = min(BLOCK, n - start);
+            for(size_t i=0; i<count; i+=2)
+            {
+                uint64_t x = next();
+                draws[i] = static_cast<uint32_t>(x);
+                draws[i+1] = static_cast<uint32_t>(x >> 32);
+            }
+
+            uint32_t* block = out + start;
+            uint32_t biased = 0;
+            for(size_t i=0; i<count; ++i)
+            {
+                uint64_t m = static_cast<uint64_t>(draws[i]) * bound;
+                block[i] = static_cast<uint32_t>(m >> 32);
+                biased |= static_cast<uint32_t>(static_cast<uint32_t>(m) < threshold);
+            }
+
+            if(biased)
+            {
+                for(size_t i=0; i<count; ++i)
+                {
+                    if(static_cast<uint32_t>(draws[i] * bound) < threshold) block[i] = below(bound);
+                }
+            }
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Random::jump
+        Description : Moves the generator on by 2^128 numbers in the time it takes
+                      to draw a few hundred.
+        Inputs      : None
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Random::jump()
+    {
+        static const uint64_t JUMP[4] = { 0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+                                          0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL };
+
+        uint64_t jumped[4] = { 0, 0, 0, 0 };
+        for(int i=0; i<4; ++i)
+        {
+            for(int b=0; b<64; ++b)
+            {
+                if(JUMP[i] & (1ULL << b))
+                {
+                    for(int j=0; j<4; ++j) jumped[j] ^= state[j];
+                }
+                next();
+            }
+        }
+        for(int j=0; j<4; ++j) state[j] = jumped[j];
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Random::fork
+        Description : Returns a generator that carries on from here, and moves this
+                      one past the 2^128 numbers the new one will give.  Forking
+                      for each worker before they start gives every thread its own
+                      generator, and the same results however they are scheduled.
+        Inputs      : None
+        Outputs     : None
+        Return      : Random
+    --------------------------------------------------------------------------------*/
+    Random Random::fork()
+    {
+        Random child(*this);
+        jump();
+        return child;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Random::seedStreams
+        Description : Seeds each of the game's named streams from the game seed.
+                      Each gets a different seed, so drawing more from one never
+                      changes what another gives.
+        Inputs      : game seed
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Random::seedStreams(const uint64_t gameSeed)
+    {
+        uint64_t x = gameSeed;
+        for(int s=0; s<NUM_RANDOM_STREAMS; ++s)
+        {
+            streams[s].seed(splitmix(x));
+        }
+    }
+}
@@ -0,0 +1,135 @@
+#ifndef RLNS_RANDOM_HPP
+#define RLNS_RANDOM_HPP
+
+#include <algorithm>
+#include <vector>
+
+#include <stdint.h>
+
+namespace rlns
+{
+    // the game's independent random streams, each seeded from the game seed
+    enum RandomStream
+    {
+        STREAM_GENERATION, // levels and their layout
+        STREAM_COMBAT,     // dice
+        STREAM_AI,         // decisions of actors that aren't hash based
+        STREAM_LOOT,       // items placed outside seeded generation
+        NUM_RANDOM_STREAMS
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : Random
+        Description : A random number generator (xoshiro256**): four words of
+                      state, a few shifts and multiplies per number, and a period
+                      of 2^256 - 1.  It is a plain value, so it can be copied and
+                      kept by whatever needs one.  fork() hands out a generator
+                      whose numbers don't overlap this one's for 2^128 draws, for
+                      giving each worker thread its own.  Bounded numbers are
+                      drawn without modulo bias.  The game's named streams are
+                      reached through stream() and belong to the main thread;
+                      other threads fork their own.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class Random
+    {
+        // Member Variables
+        private:
+            uint64_t state[4];
+
+            static Random streams[NUM_RANDOM_STREAMS];
+
+        // Member Functions
+        private:
+            static uint64_t rotl(const uint64_t x, const int k)
+            { return (x << k) | (x >> (64 - k)); }
+
+        public:
+            Random() { seed(0); }
+            explicit Random(const uint64_t s) { seed(s); }
+
+            void seed(const uint64_t);
+
+            uint64_t next()
+            {
+                uint64_t result = rotl(state[1] * 5, 7) * 9;
+                uint64_t t = state[1] << 17;
+                state[2] ^= state[0];
+                state[3] ^= state[1];
+                state[1] ^= state[2];
+                state[0] ^= state[3];
+                state[2] ^= t;
+                state[3] = rotl(state[3], 45);
+                return result;
+            }
+
+            uint32_t below(const uint32_t);
+            int getInt(int, int);
+            double getDouble(const double, const double);
+
+            void fill(uint64_t*, const size_t);
+            void fillInts(int*, const size_t, const int, const int);
+            void fillBelow(uint32_t*, const size_t, const uint32_t);
+            void fillInts(std::vector<int>& out, const size_t n, const int low, const int high)
+            { out.resize(n); if(n > 0) fillInts(&out[0], n, low, high); }
+
+            void jump();
+            Random fork();
+
+            static Random& stream(const RandomStream s) { return streams[s]; }
+            static void seedStreams(const uint64_t);
+    };
+
+
+
+    // Inline Functions
+
+    /*--------------------------------------------------------------------------------
+        Function    : Random::below
+        Description : Returns a number in [0, n), n > 0, by Lemire's method: the top
+                      of a 32 by 32 bit product, drawing again in the rare case
+                      the bottom falls where it would bias the result.
+        Inputs      : n
+        Outputs     : None
+        Return      : uint32_t
+    --------------------------------------------------------------------------------*/
+    inline uint32_t Random::below(const uint32_t n)
+    {
+        uint64_t m = (next() >> 32) * n;
+        uint32_t low = static_cast<uint32_t>(m);
+        if(low < n)
+        {
+            uint32_t threshold = (0u - n) % n;
+            while(low < threshold)
+            {
+                m = (next() >> 32) * n;
+                low = static_cast<uint32_t>(m);
+            }
+        }
+        return static_cast<uint32_t>(m >> 32);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Random::getInt
+        Description : Returns a number from low to high, both included, as
+                      TCODRandom::getInt does; the bounds may come in either order.
+        Inputs      : bounds
+        Outputs     : None
+        Return      : int
+    --------------------------------------------------------------------------------*/
+    inline int Random::getInt(int low, int high)
+    {
+        if(low > high) std::swap(low, high);
+        uint32_t span = static_cast<uint32_t>(high) - static_cast<uint32_t>(low) + 1;
+        if(span == 0) return static_cast<int>(next() >> 32); // every int
+        return static_cast<int>(static_cast<uint32_t>(low) + below(span));
+    }
+}
+
+#endif
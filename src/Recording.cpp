@@ -0,0 +1,142 @@
+#include "Recording.hpp"
+#include "MappedFile.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Function    : Recording::Recording(uint32_t)
+        Description : Starts an empty recording of a game started from the given
+                      seed.
+        Inputs      : seed
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    Recording::Recording(const uint32_t s)
+    : seed(s), nextEvent(0), nextCommand(0) {}
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Recording::Recording(string)
+        Description : Loads a recording written by saveToFile(), ready to be played
+                      back from the start.
+        Inputs      : file name
+        Outputs     : throws runtime_error if the file can't be read or is damaged
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    Recording::Recording(const string& file)
+    : seed(0), nextEvent(0), nextCommand(0)
+    {
+        MappedFile mapped(file);
+        if(!mapped.isOpen())
+        {
+            throw runtime_error("can't open " + file);
+        }
+
+        SaveReader save(mapped.begin(), mapped.size());
+        vector<size_t> offsets;
+        save.findSections(SAVE_INPUT, offsets);
+        if(offsets.empty())
+        {
+            throw runtime_error(file + " isn't a recording");
+        }
+
+        save.seek(offsets[0]);
+        save.beginSection(SAVE_INPUT);
+        seed = save.get<uint32_t>();
+        save.getBlock(events);
+        size_t numCommands = save.get<uint32_t>();
+        for(size_t i=0; i<numCommands; ++i)
+        {
+            commands.push_back(save.getString());
+        }
+        save.endSection();
+
+        size_t numCommandEvents = 0;
+        for(size_t i=0; i<events.size(); ++i)
+        {
+            if(events[i] > SAVE) throw runtime_error("recording is damaged");
+            if(events[i] == COMMAND) ++numCommandEvents;
+        }
+        if(numCommandEvents != commands.size())
+        {
+            throw runtime_error("recording is damaged");
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Recording::add
+        Description : Adds an event to the end of the recording.  For a COMMAND,
+                      the command typed is kept with it.
+        Inputs      : event, command typed
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Recording::add(const EventType event, const string& command)
+    {
+        events.push_back(static_cast<uint8_t>(event));
+        if(event == COMMAND) commands.push_back(command);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Recording::next
+        Description : Plays back the next event, and the command typed with it if
+                      it is a COMMAND.
+        Inputs      : None
+        Outputs     : event, command (empty unless a COMMAND)
+        Return      : bool (false once every event has been played)
+    --------------------------------------------------------------------------------*/
+    bool Recording::next(EventType& event, string& command)
+    {
+        if(atEnd()) return false;
+
+        event = static_cast<EventType>(events[nextEvent++]);
+        command.clear();
+        if(event == COMMAND) command = commands[nextCommand++];
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Recording::saveToDisk
+        Description : Writes the recording as an input section.
+        Inputs      : save file
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Recording::saveToDisk(SaveWriter& save) const
+    {
+        save.beginSection(SAVE_INPUT);
+        save.put<uint32_t>(seed);
+        save.putBlock(events);
+        save.put<uint32_t>(commands.size());
+        for(size_t i=0; i<commands.size(); ++i)
+        {
+            save.putString(commands[i]);
+        }
+        save.endSection();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Recording::saveToFile
+        Description : Writes the recording to the given file.
+        Inputs      : file name
+        Outputs     : None
+        Return      : bool (whether the file was written)
+    --------------------------------------------------------------------------------*/
+    bool Recording::saveToFile(const string& file) const
+    {
+        SaveWriter save;
+        saveToDisk(save);
+        return save.saveToFile(file);
+    }
+}
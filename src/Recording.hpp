@@ -0,0 +1,57 @@
+#ifndef RLNS_RECORDING_HPP
+#define RLNS_RECORDING_HPP
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include "SaveFile.hpp"
+#include "Types.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : Recording
+        Description : The input of a game session: the seed the game was started
+                      with and every event the player gave, in order, with the
+                      text of each command typed at the prompt.  Started from the
+                      same seed, a game given the same events plays out the same
+                      way, so a recording can be played back to reproduce a
+                      session or to time it.  The events given inside a screen
+                      an event opens, like the keys pressed in the inventory
+                      after an EQUIPMENT, follow that event in the same stream
+                      and are played back into the screen.  Events are kept one byte each and
+                      the file is deflated, so recordings stay small.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class Recording
+    {
+        // Member Variables
+        private:
+            uint32_t seed;
+            std::vector<uint8_t> events;
+            std::vector<std::string> commands; // one for each COMMAND event
+            size_t nextEvent, nextCommand;     // for playing back
+
+        // Member Functions
+        public:
+            explicit Recording(const uint32_t);
+            explicit Recording(const std::string&);
+
+            uint32_t getSeed() const { return seed; }
+            size_t size() const      { return events.size(); }
+            bool atEnd() const       { return nextEvent >= events.size(); }
+
+            void add(const EventType, const std::string& = "");
+            bool next(EventType&, std::string&);
+            void rewind() { nextEvent = 0; nextCommand = 0; }
+
+            void saveToDisk(SaveWriter&) const;
+            bool saveToFile(const std::string&) const;
+    };
+}
+
+#endif
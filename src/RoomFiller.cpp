@@ -12,14 +12,34 @@ namespace rlns
     ItemPtr RoomFiller::genItem(const AreaPtr area) const
     {
         // find an empty point in the room
-        Point pt;
-        TCODRandom rand;
-        do { pt = area->getRandomPoint(rand); }
-        while(!map->moveLegal(pt, MovementType::WALKING));
+        Point pt = area->getRandomOpenPoint(rand);
 
         // add an item
-        ItemPtr newItem(new Item(pt));
-        return newItem;
+        return allocatePooled<Item>(arena, "Item", pt);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : RoomFiller::genItems
+        Description : Generates up to n items on distinct points in the given area.
+                      If the area has fewer than n open points, every open point
+                      receives an item.
+        Inputs      : result vector, area of the map, number of items
+        Outputs     : None
+        Return      : void (the items are returned through the vector parameter)
+    --------------------------------------------------------------------------------*/
+    void RoomFiller::genItems(std::vector<ItemPtr>& result, const AreaPtr area, const size_t n) const
+    {
+        std::vector<Point> points;
+        area->getRandomOpenPoints(points, rand, n);
+
+        std::vector<Point>::const_iterator it, end;
+        it = points.begin(); end = points.end();
+        for(; it!=end; ++it)
+        {
+            result.push_back(allocatePooled<Item>(arena, "Item", *it));
+        }
     }
 
 
@@ -6,8 +6,12 @@
 #pragma warning( disable : 4482 )
 #endif
 
+#include <vector>
+
 #include "Area.hpp"
 #include "Item.hpp"
+#include "Pool.hpp"
+#include "Random.hpp"
 #include "Types.hpp"
 
 #include "libtcod.hpp"
@@ -31,13 +35,19 @@ namespace rlns
         private:
             MapPtr map;
             unsigned int depth;
+            mutable Random rand;
+            ArenaPtr arena; // where the items are allocated
 
         // Member Functions
         public:
             RoomFiller(const MapPtr m, const unsigned int d) 
-            : map(m), depth(d) {}
+            : map(m), depth(d), rand(Random::stream(STREAM_LOOT).fork()), arena(Arena::global()) {}
+
+            RoomFiller(const MapPtr m, const unsigned int d, const uint32_t seed, const ArenaPtr& a)
+            : map(m), depth(d), rand(seed), arena(a) {}
 
             ItemPtr genItem(const AreaPtr) const;
+            void genItems(std::vector<ItemPtr>&, const AreaPtr, const size_t) const;
             //PartyPtr genMonsterGroup(const AreaPtr) const;
     };
 }
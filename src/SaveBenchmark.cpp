@@ -0,0 +1,155 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "Level.hpp"
+#include "MappedFile.hpp"
+#include "MessageTracker.hpp"
+#include "SaveFile.hpp"
+#include "SaveGame.hpp"
+#include "Tile.hpp"
+#include "Tileset.hpp"
+#include "Types.hpp"
+#include "Vault.hpp"
+
+using namespace std;
+using namespace rlns;
+
+typedef chrono::steady_clock Clock;
+
+/*--------------------------------------------------------------------------------
+    Function    : millisecondsSince
+    Description : Returns the time elapsed since the given point.
+    Inputs      : start time
+    Outputs     : None
+    Return      : double (milliseconds)
+--------------------------------------------------------------------------------*/
+static double millisecondsSince(const Clock::time_point start)
+{
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : fileSize
+    Description : Returns the size of a file on disk.
+    Inputs      : file name
+    Outputs     : None
+    Return      : long (bytes, or -1 if the file can't be opened)
+--------------------------------------------------------------------------------*/
+static long fileSize(const string& name)
+{
+    FILE* file = fopen(name.c_str(), "rb");
+    if(file == NULL) return -1;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : main
+    Description : Compares the old RLNSZip save with the sectioned save format.
+                  Generates a few levels without opening a window, then saves and
+                  loads them in both formats and prints the size of each file and
+                  how long saving and loading took, and how long the game thread
+                  spends on a background save.  Run from the directory that holds
+                  datafiles/.
+    Inputs      : optional number of levels to generate (default 8)
+    Outputs     : a table on stdout
+    Return      : int (0 on success)
+--------------------------------------------------------------------------------*/
+int main(int argc, char* argv[])
+{
+    int numLevels = (argc > 1) ? atoi(argv[1]) : 8;
+    if(numLevels < 1) numLevels = 1;
+
+    const string oldFile("savebench.old.sav");
+    const string newFile("savebench.new.sav");
+
+    TileParser("./datafiles/tiles.txt").run();
+    TilesetParser("./datafiles/tileset.txt").run();
+    VaultParser("./datafiles/vaults.txt").run();
+
+    for(int i=0; i<numLevels; ++i)
+    {
+        Level::addLevel((i % 2 == 0) ? "Castle" : "Cavern");
+    }
+
+    // save in both formats first, since loading the old format adds to the
+    // level list instead of replacing it
+    Clock::time_point start = Clock::now();
+    RLNSZip zip;
+    Level::saveLevelsToDisk(zip);
+    zip.saveToFile(oldFile.c_str());
+    double oldSave = millisecondsSince(start);
+
+    start = Clock::now();
+    if(!Level::saveLevelsToFile(newFile))
+    {
+        cerr << "Couldn't write " << newFile << endl;
+        return 1;
+    }
+    double newSave = millisecondsSince(start);
+
+    start = Clock::now();
+    RLNSZip oldZip;
+    oldZip.loadFromFile(oldFile.c_str());
+    Level::loadLevelsFromDisk(oldZip);
+    double oldLoad = millisecondsSince(start);
+
+    // resuming only loads the current level; a full load reads every level
+    double resume, newLoad;
+    try
+    {
+        start = Clock::now();
+        Level::loadLevelsFromFile(newFile);
+        resume = millisecondsSince(start);
+
+        start = Clock::now();
+        MappedFile file(newFile);
+        SaveReader save(file.begin(), file.size());
+        Level::loadLevelsFromDisk(save);
+        newLoad = millisecondsSince(start);
+    }
+    catch(const runtime_error& e)
+    {
+        cerr << "Couldn't load " << newFile << ": " << e.what() << endl;
+        return 1;
+    }
+
+    // what a background save costs the game thread: only the snapshot, which
+    // copies every map the first time and then only the maps that changed
+    MessageTracker messages;
+    start = Clock::now();
+    GameSnapshot first(messages);
+    double firstSnapshot = millisecondsSince(start);
+
+    start = Clock::now();
+    GameSnapshot repeat(messages);
+    double repeatSnapshot = millisecondsSince(start);
+
+    cout << numLevels << " levels" << endl;
+    cout << left << setw(12) << "format" << right << setw(12) << "bytes"
+         << setw(12) << "save ms" << setw(12) << "load ms" << endl;
+    cout << fixed << setprecision(2);
+    cout << left << setw(12) << "old" << right << setw(12) << fileSize(oldFile)
+         << setw(12) << oldSave << setw(12) << oldLoad << endl;
+    cout << left << setw(12) << (SaveWriter().isChecked() ? "new checked" : "new")
+         << right << setw(12) << fileSize(newFile)
+         << setw(12) << newSave << setw(12) << newLoad << endl;
+    cout << "resume (current level only): " << resume << " ms" << endl;
+    cout << "background save snapshot: " << firstSnapshot << " ms first, "
+         << repeatSnapshot << " ms when nothing changed" << endl;
+
+    remove(oldFile.c_str());
+    remove(newFile.c_str());
+    return 0;
+}
@@ -0,0 +1,516 @@
+#include "SaveFile.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Function    : checksum
+        Description : Computes the CRC-32 of a block of bytes.
+        Inputs      : bytes, number of bytes
+        Outputs     : None
+        Return      : uint32_t
+    --------------------------------------------------------------------------------*/
+    static uint32_t checksum(const char* data, const size_t n)
+    {
+        return crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(data), n);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveWriter::SaveWriter
+        Description : Starts a save with the file header.
+        Inputs      : whether to tag every value with its type
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    SaveWriter::SaveWriter(const bool c)
+    : checked(c)
+    {
+        uint32_t header[3] = { MAGIC, VERSION, checked ? CHECKED : 0 };
+        putRaw(header, sizeof(header));
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveWriter::beginSection
+        Description : Starts a section.  Its length and checksum are filled in by
+                      the matching endSection().
+        Inputs      : section tag
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void SaveWriter::beginSection(const uint32_t tag)
+    {
+        sections.push_back(buffer.size());
+        uint32_t header[3] = { tag, 0, 0 };
+        putRaw(header, sizeof(header));
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveWriter::endSection
+        Description : Ends the innermost open section, filling in its length and
+                      checksum.
+        Inputs      : None
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void SaveWriter::endSection()
+    {
+        size_t start = sections.back();
+        sections.pop_back();
+
+        size_t contents = start + SECTION_HEADER_SIZE;
+        uint32_t length = buffer.size() - contents;
+        uint32_t crc = checksum(&buffer[0] + contents, length);
+        memcpy(&buffer[start + 4], &length, sizeof(length));
+        memcpy(&buffer[start + 8], &crc, sizeof(crc));
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveWriter::putString
+        Description : Writes a length-prefixed string.
+        Inputs      : string
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void SaveWriter::putString(const string& s)
+    {
+        putType(SAVE_STRING);
+        uint32_t n = s.size();
+        putRaw(&n, sizeof(n));
+        putRaw(s.data(), n);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveWriter::putColor
+        Description : Writes a color as three bytes.
+        Inputs      : color
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void SaveWriter::putColor(const TCODColor& c)
+    {
+        putType(SAVE_COLOR);
+        uint8_t rgb[3] = { c.r, c.g, c.b };
+        putRaw(rgb, sizeof(rgb));
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveWriter::packSections
+        Description : Lays the save out as it goes to disk.  Each top level section
+                      is copied, deflated if asked for, in which case its contents
+                      become the inflated size followed by the deflated bytes and
+                      its checksum covers those.  An index section listing the tag
+                      and offset of every top level section follows, then the
+                      index's own offset as the last four bytes of the file.
+        Inputs      : vector to fill, whether to deflate the sections
+        Outputs     : the file's contents
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void SaveWriter::packSections(vector<char>& file, const bool compressed) const
+    {
+        uint32_t header[3];
+        memcpy(header, &buffer[0], HEADER_SIZE);
+        header[2] |= INDEXED | (compressed ? COMPRESSED : 0);
+        file.assign(reinterpret_cast<char*>(header), reinterpret_cast<char*>(header) + HEADER_SIZE);
+
+        vector<uint32_t> index;
+        size_t next = HEADER_SIZE;
+        while(next < buffer.size())
+        {
+            uint32_t section[3];
+            memcpy(section, &buffer[next], SECTION_HEADER_SIZE);
+            const char* contents = &buffer[next + SECTION_HEADER_SIZE];
+            uint32_t length = section[1];
+            next += SECTION_HEADER_SIZE + length;
+
+            index.push_back(section[0]);
+            index.push_back(file.size());
+
+            if(!compressed)
+            {
+                file.insert(file.end(), contents - SECTION_HEADER_SIZE, contents + length);
+                continue;
+            }
+
+            uLongf packedSize = compressBound(length);
+            vector<char> packed(sizeof(length) + packedSize);
+            memcpy(&packed[0], &length, sizeof(length));
+            if(compress2(reinterpret_cast<Bytef*>(&packed[sizeof(length)]), &packedSize,
+                         reinterpret_cast<const Bytef*>(contents), length,
+                         Z_DEFAULT_COMPRESSION) != Z_OK)
+            {
+                throw runtime_error("couldn't compress the save");
+            }
+            packed.resize(sizeof(length) + packedSize);
+
+            section[1] = packed.size();
+            section[2] = checksum(&packed[0], packed.size());
+            file.insert(file.end(), reinterpret_cast<char*>(section),
+                        reinterpret_cast<char*>(section) + SECTION_HEADER_SIZE);
+            file.insert(file.end(), packed.begin(), packed.end());
+        }
+
+        // the index is a plain list of (tag, offset) pairs, never compressed
+        // or checked, so it reads the same whatever kind of save it is in
+        uint32_t indexOffset = file.size();
+        const char* entries = reinterpret_cast<const char*>(index.empty() ? NULL : &index[0]);
+        uint32_t indexLength = index.size() * sizeof(uint32_t);
+        uint32_t indexHeader[3] = { SAVE_INDEX, indexLength, checksum(entries, indexLength) };
+        file.insert(file.end(), reinterpret_cast<char*>(indexHeader),
+                    reinterpret_cast<char*>(indexHeader) + SECTION_HEADER_SIZE);
+        file.insert(file.end(), entries, entries + indexLength);
+        file.insert(file.end(), reinterpret_cast<char*>(&indexOffset),
+                    reinterpret_cast<char*>(&indexOffset) + sizeof(indexOffset));
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveWriter::saveToFile
+        Description : Writes the save to a temporary file, flushes it to the disk
+                      and moves it into place, so that a crash or an interrupted
+                      save never replaces a good save with a partial one.  Every
+                      section must have been ended.
+        Inputs      : file name, whether to compress the save
+        Outputs     : None
+        Return      : bool (whether the save was written)
+    --------------------------------------------------------------------------------*/
+    bool SaveWriter::saveToFile(const string& name, const bool compressed) const
+    {
+        if(!sections.empty()) return false;
+
+        vector<char> contents;
+        packSections(contents, compressed);
+
+        string temp = name + ".tmp";
+        FILE* file = fopen(temp.c_str(), "wb");
+        if(file == NULL) return false;
+
+        bool ok = fwrite(&contents[0], 1, contents.size(), file) == contents.size();
+        ok = (fflush(file) == 0) && ok;
+    #ifdef _WIN32
+        ok = (_commit(_fileno(file)) == 0) && ok;
+    #else
+        ok = (fsync(fileno(file)) == 0) && ok;
+    #endif
+        ok = (fclose(file) == 0) && ok;
+
+        remove(name.c_str()); // rename doesn't replace files on Windows
+        if(!ok || rename(temp.c_str(), name.c_str()) != 0)
+        {
+            remove(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveReader::SaveReader
+        Description : Checks the header of a save held in memory, and reads its
+                      index if it has one.
+        Inputs      : start of the save, its size in bytes
+        Outputs     : throws runtime_error if it isn't a save this version can read
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    SaveReader::SaveReader(const char* data, const size_t n)
+    : start(data), pos(data), end(data + n), checked(false), compressed(false), version(0)
+    {
+        uint32_t header[3];
+        if(data == NULL || n < SaveWriter::HEADER_SIZE)
+            throw runtime_error("save file is truncated");
+        getRaw(header, sizeof(header));
+
+        if(header[0] != SaveWriter::MAGIC)
+            throw runtime_error("not a save file");
+        if(header[1] > SaveWriter::VERSION)
+            throw runtime_error("save file was written by a newer version");
+        if(header[1] < SaveWriter::VERSION)
+            throw runtime_error("save file was written by an older version");
+
+        version = header[1];
+        checked = (header[2] & SaveWriter::CHECKED) != 0;
+        compressed = (header[2] & SaveWriter::COMPRESSED) != 0;
+        if(header[2] & SaveWriter::INDEXED) readIndex();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveReader::readIndex
+        Description : Reads the index at the end of the file.  Sequential reads stop
+                      where the index begins.
+        Inputs      : None
+        Outputs     : throws runtime_error if the index is damaged
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void SaveReader::readIndex()
+    {
+        uint32_t indexOffset;
+        if(static_cast<size_t>(end - pos) < sizeof(indexOffset) + SaveWriter::SECTION_HEADER_SIZE)
+            throw runtime_error("save file is truncated");
+        memcpy(&indexOffset, end - sizeof(indexOffset), sizeof(indexOffset));
+
+        const char* indexEnd = end - sizeof(indexOffset);
+        if(indexOffset < SaveWriter::HEADER_SIZE ||
+           static_cast<size_t>(indexEnd - start) < indexOffset + SaveWriter::SECTION_HEADER_SIZE)
+            throw runtime_error("save file is damaged");
+
+        uint32_t header[3];
+        memcpy(header, start + indexOffset, sizeof(header));
+        const char* entries = start + indexOffset + SaveWriter::SECTION_HEADER_SIZE;
+        if(header[0] != SAVE_INDEX || header[1] != static_cast<size_t>(indexEnd - entries) ||
+           header[1] % sizeof(IndexEntry) != 0 || checksum(entries, header[1]) != header[2])
+            throw runtime_error("save file is damaged");
+
+        index.resize(header[1] / sizeof(IndexEntry));
+        if(!index.empty()) memcpy(&index[0], entries, header[1]);
+
+        end = start + indexOffset;
+        for(size_t i=0; i<index.size(); ++i)
+        {
+            if(index[i].offset < SaveWriter::HEADER_SIZE || index[i].offset >= indexOffset)
+                throw runtime_error("save file is damaged");
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveReader::expectType
+        Description : In a checked save, reads the type of the next value and makes
+                      sure it is the one the loader asked for.  Does nothing in an
+                      unchecked save.
+        Inputs      : expected type
+        Outputs     : throws runtime_error if the type is different
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void SaveReader::expectType(const uint8_t expected)
+    {
+        if(!checked) return;
+
+        uint8_t found;
+        getRaw(&found, sizeof(found));
+        if(found != expected)
+        {
+            char msg[80];
+            sprintf(msg, "save file has a value of type %d where type %d was expected",
+                    found, expected);
+            throw runtime_error(msg);
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveReader::peekSection
+        Description : Returns the tag of the next section without entering it.
+        Inputs      : None
+        Outputs     : None
+        Return      : uint32_t (0 if the current section or file has ended)
+    --------------------------------------------------------------------------------*/
+    uint32_t SaveReader::peekSection() const
+    {
+        uint32_t tag = 0;
+        if(static_cast<size_t>(limit() - pos) >= SaveWriter::SECTION_HEADER_SIZE)
+            memcpy(&tag, pos, sizeof(tag));
+        return tag;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveReader::beginSection
+        Description : Enters the next section, which must have the given tag.  A top
+                      level section of a compressed save is inflated first.
+        Inputs      : expected section tag
+        Outputs     : throws runtime_error if the tag is different, the section
+                      runs past its parent, or its checksum doesn't match
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void SaveReader::beginSection(const uint32_t expected)
+    {
+        uint32_t header[3];
+        getRaw(header, sizeof(header));
+
+        if(header[0] != expected)
+            throw runtime_error("save file has sections out of order");
+        if(static_cast<size_t>(limit() - pos) < header[1])
+            throw runtime_error("save file is truncated");
+
+        const char* sectionEnd = pos + header[1];
+        if(!sections.empty())
+        {
+            OpenSection section = { sectionEnd, sectionEnd };
+            sections.push_back(section);
+            return;
+        }
+
+        if(checksum(pos, header[1]) != header[2])
+            throw runtime_error("save file is damaged");
+
+        if(compressed)
+        {
+            uint32_t rawSize;
+            if(header[1] < sizeof(rawSize))
+                throw runtime_error("save file is damaged");
+            memcpy(&rawSize, pos, sizeof(rawSize));
+
+            uLongf inflatedSize = rawSize;
+            inflated.resize(rawSize);
+            if(rawSize > 0)
+            {
+                Bytef* out = reinterpret_cast<Bytef*>(&inflated[0]);
+                const Bytef* in = reinterpret_cast<const Bytef*>(pos + sizeof(rawSize));
+                if(uncompress(out, &inflatedSize, in, header[1] - sizeof(rawSize)) != Z_OK ||
+                   inflatedSize != rawSize)
+                    throw runtime_error("save file is damaged");
+            }
+
+            pos = inflated.empty() ? NULL : &inflated[0];
+            OpenSection section = { pos + rawSize, sectionEnd };
+            sections.push_back(section);
+        }
+        else
+        {
+            OpenSection section = { sectionEnd, sectionEnd };
+            sections.push_back(section);
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveReader::endSection
+        Description : Leaves the current section, skipping whatever wasn't read.
+        Inputs      : None
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void SaveReader::endSection()
+    {
+        pos = sections.back().resume;
+        sections.pop_back();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveReader::copySection
+        Description : Reads the next section, which must have the given tag, without
+                      interpreting it.  The contents can be written into another
+                      save of the same kind with SaveWriter::putContents.
+        Inputs      : expected section tag, vector to fill
+        Outputs     : the section's contents, inflated; throws runtime_error like
+                      beginSection
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void SaveReader::copySection(const uint32_t expected, vector<char>& contents)
+    {
+        beginSection(expected);
+        contents.assign(pos, limit());
+        endSection();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveReader::findSections
+        Description : Lists the offsets of the top level sections with the given
+                      tag, in file order.  They come from the index if the file has
+                      one; otherwise the section headers are walked.
+        Inputs      : section tag, vector to fill
+        Outputs     : offsets from the start of the file
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void SaveReader::findSections(const uint32_t tag, vector<size_t>& offsets) const
+    {
+        if(!index.empty())
+        {
+            for(size_t i=0; i<index.size(); ++i)
+            {
+                if(index[i].tag == tag) offsets.push_back(index[i].offset);
+            }
+            return;
+        }
+
+        const char* next = start + SaveWriter::HEADER_SIZE;
+        while(static_cast<size_t>(end - next) >= SaveWriter::SECTION_HEADER_SIZE)
+        {
+            uint32_t header[2];
+            memcpy(header, next, sizeof(header));
+            if(header[0] == tag) offsets.push_back(next - start);
+            if(static_cast<size_t>(end - next) - SaveWriter::SECTION_HEADER_SIZE < header[1]) break;
+            next += SaveWriter::SECTION_HEADER_SIZE + header[1];
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveReader::seek
+        Description : Moves to the top level section at the given offset, as found
+                      by findSections.  Any open sections are left.
+        Inputs      : offset from the start of the file
+        Outputs     : throws runtime_error if the offset is outside the save
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void SaveReader::seek(const size_t offset)
+    {
+        if(offset < SaveWriter::HEADER_SIZE || offset > static_cast<size_t>(end - start))
+            throw runtime_error("save file is damaged");
+        sections.clear();
+        pos = start + offset;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveReader::getString
+        Description : Reads a length-prefixed string.
+        Inputs      : None
+        Outputs     : throws runtime_error if the save is truncated
+        Return      : string
+    --------------------------------------------------------------------------------*/
+    string SaveReader::getString()
+    {
+        expectType(SAVE_STRING);
+        uint32_t n;
+        getRaw(&n, sizeof(n));
+        if(static_cast<size_t>(limit() - pos) < n)
+            throw runtime_error("save file is truncated");
+        string s(pos, n);
+        pos += n;
+        return s;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SaveReader::getColor
+        Description : Reads a color as three bytes.
+        Inputs      : None
+        Outputs     : throws runtime_error if the save is truncated
+        Return      : TCODColor
+    --------------------------------------------------------------------------------*/
+    TCODColor SaveReader::getColor()
+    {
+        expectType(SAVE_COLOR);
+        uint8_t rgb[3];
+        getRaw(rgb, sizeof(rgb));
+        return TCODColor(rgb[0], rgb[1], rgb[2]);
+    }
+}
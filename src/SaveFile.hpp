@@ -0,0 +1,271 @@
+#ifndef RLNS_SAVEFILE_HPP
+#define RLNS_SAVEFILE_HPP
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <zlib.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "libtcod.hpp"
+
+namespace rlns
+{
+    // Section tags, four characters read as a little endian int
+    const uint32_t SAVE_GAME     = 0x454D4147; // "GAME" game state and level count
+    const uint32_t SAVE_LEVEL    = 0x4C56454C; // "LEVL" one level, made of the below
+    const uint32_t SAVE_TILESET  = 0x54455354; // "TSET" name of the level's tileset
+    const uint32_t SAVE_GRID     = 0x44495247; // "GRID" tile layers and stairs
+    const uint32_t SAVE_TERRAIN  = 0x52524554; // "TERR" a streamed map's seed and changed chunks
+    const uint32_t SAVE_CHUNK    = 0x4B4E4843; // "CHNK" one map chunk, swapped out
+    const uint32_t SAVE_ITEMS    = 0x4D455449; // "ITEM" items lying in the level
+    const uint32_t SAVE_PARTIES  = 0x59545250; // "PRTY" parties and their members
+    const uint32_t SAVE_AREAS    = 0x41455241; // "AREA" a level's areas, as rectangles
+    const uint32_t SAVE_ENTITIES = 0x53544E45; // "ENTS" a level's entity components
+    const uint32_t SAVE_MESSAGES = 0x5347534D; // "MSGS" the message log
+    const uint32_t SAVE_INPUT    = 0x54504E49; // "INPT" a recording's seed and events
+    const uint32_t SAVE_INDEX    = 0x58444E49; // "INDX" where each section starts
+
+    // In a checked save, every value is preceded by one of these, so a loader
+    // reading something other than what was written is caught on the spot.
+    enum SaveValueType
+    {
+        SAVE_INT8 = 1,
+        SAVE_UINT8 = 2,
+        SAVE_INT16 = 3,
+        SAVE_UINT16 = 4,
+        SAVE_INT32 = 5,
+        SAVE_UINT32 = 6,
+        SAVE_FLOAT = 7,
+        SAVE_STRING = 8,
+        SAVE_COLOR = 9,
+        SAVE_BLOCK = 10 // followed by the element type, once for the whole block
+    };
+
+    template<typename T> struct SaveTypeOf;
+    template<> struct SaveTypeOf<int8_t>   { static const uint8_t code = SAVE_INT8;   };
+    template<> struct SaveTypeOf<uint8_t>  { static const uint8_t code = SAVE_UINT8;  };
+    template<> struct SaveTypeOf<int16_t>  { static const uint8_t code = SAVE_INT16;  };
+    template<> struct SaveTypeOf<uint16_t> { static const uint8_t code = SAVE_UINT16; };
+    template<> struct SaveTypeOf<int32_t>  { static const uint8_t code = SAVE_INT32;  };
+    template<> struct SaveTypeOf<uint32_t> { static const uint8_t code = SAVE_UINT32; };
+    template<> struct SaveTypeOf<float>    { static const uint8_t code = SAVE_FLOAT;  };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : SaveWriter
+        Description : Builds a save file in memory.  The file starts with a header
+                      holding the format version, followed by sections.  Each
+                      section has a tag, the length of its contents and a CRC-32
+                      of them, so a loader can check a section and skip the ones
+                      it doesn't need without reading them.  Sections may be
+                      nested.  Arrays of values are written as a single block.
+
+                      When the save is written to a file, each top level section
+                      is deflated on its own, and an index of the top level
+                      sections is added at the end, followed by the index's
+                      offset.  A loader can then find, inflate and read any one
+                      section (a single level, say) without touching the rest.
+
+                      Debug builds write checked saves, which tag every value (and
+                      every block, once) with its type; any build can read either
+                      kind.  Values are stored in the machine's byte order, which
+                      is little endian on every platform the game runs on.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class SaveWriter
+    {
+        // Static Variables
+        public:
+            static const uint32_t MAGIC = 0x534E4C52; // "RLNS"
+            static const uint32_t VERSION = 5;
+            static const uint32_t CHECKED = 1;        // header flags
+            static const uint32_t COMPRESSED = 2;
+            static const uint32_t INDEXED = 4;
+            static const size_t HEADER_SIZE = 12;
+            static const size_t SECTION_HEADER_SIZE = 12;
+
+        // Member Variables
+        private:
+            std::vector<char> buffer;
+            std::vector<size_t> sections; // offsets of the open sections' headers
+            bool checked;
+
+        // Member Functions
+        private:
+            void putRaw(const void* data, const size_t n)
+            {
+                const char* bytes = static_cast<const char*>(data);
+                buffer.insert(buffer.end(), bytes, bytes + n);
+            }
+
+            void putType(const uint8_t type)
+            { if(checked) buffer.push_back(static_cast<char>(type)); }
+
+        public:
+        #ifdef _DEBUG
+            static const bool CHECKED_BY_DEFAULT = true;
+        #else
+            static const bool CHECKED_BY_DEFAULT = false;
+        #endif
+
+            SaveWriter(const bool c = CHECKED_BY_DEFAULT);
+
+            bool isChecked() const { return checked; }
+            size_t size() const    { return buffer.size(); }
+            const std::vector<char>& getBuffer() const { return buffer; }
+
+            void beginSection(const uint32_t);
+            void endSection();
+
+            template<typename T>
+            void put(const T value)
+            {
+                putType(SaveTypeOf<T>::code);
+                putRaw(&value, sizeof(T));
+            }
+
+            template<typename T>
+            void putBlock(const std::vector<T>& values)
+            {
+                putType(SAVE_BLOCK);
+                putType(SaveTypeOf<T>::code);
+                uint32_t n = values.size();
+                putRaw(&n, sizeof(n));
+                if(n > 0) putRaw(&values[0], n * sizeof(T));
+            }
+
+            void putString(const std::string&);
+            void putColor(const TCODColor&);
+
+            // copies the contents of a section read with SaveReader::copySection
+            void putContents(const std::vector<char>& contents)
+            { if(!contents.empty()) putRaw(&contents[0], contents.size()); }
+
+            // the save as saveToFile() writes it, for keeping in memory
+            void packSections(std::vector<char>&, const bool) const;
+            bool saveToFile(const std::string&, const bool compressed = true) const;
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : SaveReader
+        Description : Reads a file written by SaveWriter, in the order it was
+                      written, or jumps straight to a top level section found in
+                      the file's index.  Sections are entered with beginSection(),
+                      which checks the tag and, for sections that aren't nested
+                      in another, the checksum (an outer checksum already covers
+                      the sections inside it) and inflates them if the file is
+                      compressed.  Reads never run past the end of the current
+                      section.  Every problem is reported by throwing
+                      runtime_error, so a damaged save never loads halfway.
+
+                      A reader can also read a save held in a SaveWriter's
+                      buffer, which has neither index nor compression.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class SaveReader
+    {
+        // Member Variables
+        private:
+            struct OpenSection
+            {
+                const char* end;    // where reads within the section stop
+                const char* resume; // where reading continues once it is left
+            };
+
+            struct IndexEntry
+            {
+                uint32_t tag;
+                uint32_t offset;
+            };
+
+            const char* start;
+            const char* pos;
+            const char* end;
+            std::vector<OpenSection> sections;
+            std::vector<IndexEntry> index;
+            std::vector<char> inflated;        // the open top level section, if compressed
+            bool checked;
+            bool compressed;
+            uint32_t version;
+
+        // Member Functions
+        private:
+            // pos may point into inflated, so a reader can't be copied
+            SaveReader(const SaveReader&);
+            SaveReader& operator=(const SaveReader&);
+
+            const char* limit() const
+            { return sections.empty() ? end : sections.back().end; }
+
+            void readIndex();
+
+            void getRaw(void* data, const size_t n)
+            {
+                if(static_cast<size_t>(limit() - pos) < n)
+                    throw std::runtime_error("save file is truncated");
+                std::memcpy(data, pos, n);
+                pos += n;
+            }
+
+            void expectType(const uint8_t);
+
+        public:
+            SaveReader(const char*, const size_t);
+
+            bool isChecked() const      { return checked; }
+            uint32_t getVersion() const { return version; }
+
+            bool atSectionEnd() const   { return pos == limit(); }
+            uint32_t peekSection() const;
+            void beginSection(const uint32_t);
+            void endSection();
+            void copySection(const uint32_t, std::vector<char>&);
+
+            void findSections(const uint32_t, std::vector<size_t>&) const;
+            void seek(const size_t);
+
+            template<typename T>
+            T get()
+            {
+                expectType(SaveTypeOf<T>::code);
+                T value;
+                getRaw(&value, sizeof(T));
+                return value;
+            }
+
+            template<typename T>
+            void getBlock(std::vector<T>& values)
+            {
+                expectType(SAVE_BLOCK);
+                expectType(SaveTypeOf<T>::code);
+                uint32_t n;
+                getRaw(&n, sizeof(n));
+                if(static_cast<size_t>(limit() - pos) / sizeof(T) < n)
+                    throw std::runtime_error("save file is truncated");
+                values.resize(n);
+                if(n > 0) getRaw(&values[0], n * sizeof(T));
+            }
+
+            std::string getString();
+            TCODColor getColor();
+    };
+}
+
+#endif
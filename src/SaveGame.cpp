@@ -0,0 +1,195 @@
+#include "SaveGame.hpp"
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Function    : makeParentDirectory
+        Description : Creates the directory a file is to be written in, if it isn't
+                      there yet.  Only the last directory of the path is created.
+        Inputs      : file name
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    static void makeParentDirectory(const string& file)
+    {
+        size_t slash = file.find_last_of("/\\");
+        if(slash == string::npos || slash == 0) return;
+
+        string directory = file.substr(0, slash);
+    #ifdef _WIN32
+        _mkdir(directory.c_str());
+    #else
+        mkdir(directory.c_str(), 0755);
+    #endif
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : GameSnapshot::GameSnapshot
+        Description : Takes a snapshot of every level and of the message log.
+        Inputs      : message log
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    GameSnapshot::GameSnapshot(const MessageTracker& messageTracker)
+    : currentLevel(Level::getCurrentLevelIndex()),
+      messages(messageTracker.getMessages())
+    {
+        Level::takeSnapshots(levels);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : GameSnapshot::saveToDisk
+        Description : Saves the levels, followed by the message log.
+        Inputs      : save file
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void GameSnapshot::saveToDisk(SaveWriter& save) const
+    {
+        Level::saveSnapshots(save, currentLevel, levels);
+        MessageTracker::saveMessages(save, messages);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : BackgroundSaver::start
+        Description : Takes a snapshot of the game and starts saving it to the given
+                      file on a worker thread.  Refuses if the last save hasn't
+                      finished yet.
+        Inputs      : file name, message log
+        Outputs     : a message if a save is already running
+        Return      : bool (whether the save was started)
+    --------------------------------------------------------------------------------*/
+    bool BackgroundSaver::start(const string& file, MessageTracker& messageTracker)
+    {
+        if(isSaving())
+        {
+            messageTracker.addStdMessage("Still saving the last game.");
+            return false;
+        }
+
+        started = chrono::steady_clock::now();
+        GameSnapshotPtr snapshot(new GameSnapshot(messageTracker));
+
+        pending = async(launch::async, [snapshot, file]()
+        {
+            SaveWriter save;
+            snapshot->saveToDisk(save);
+            makeParentDirectory(file);
+            return save.saveToFile(file);
+        });
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : BackgroundSaver::poll
+        Description : If the running save has finished, reports in the message log
+                      whether it succeeded and how long it took.  Returns at once
+                      otherwise.
+        Inputs      : message log
+        Outputs     : a message once the save is done
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void BackgroundSaver::poll(MessageTracker& messageTracker)
+    {
+        if(!isSaving()) return;
+        if(pending.wait_for(chrono::seconds(0)) != future_status::ready) return;
+
+        bool saved = false;
+        try
+        {
+            saved = pending.get();
+        }
+        catch(const exception&) {}
+
+        if(saved)
+        {
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+            char msg[64];
+            sprintf(msg, "Game saved (%.0f ms).", ms);
+            messageTracker.addStdMessage(msg);
+        }
+        else
+        {
+            messageTracker.addMessage("The game couldn't be saved.", TCODColor::red, TCODColor::black);
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : BackgroundSaver::wait
+        Description : Blocks until the running save, if any, has finished, then
+                      reports it.  Used when the game exits.
+        Inputs      : message log
+        Outputs     : a message if a save was running
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void BackgroundSaver::wait(MessageTracker& messageTracker)
+    {
+        if(!isSaving()) return;
+        pending.wait();
+        poll(messageTracker);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : loadMessages
+        Description : Replaces the message log with the one in a save, if the save
+                      has one.
+        Inputs      : file name, message log to replace
+        Outputs     : throws runtime_error if the file can't be read or is damaged
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void loadMessages(const string& file, MessageTracker& messageTracker)
+    {
+        MappedFile mapped(file);
+        if(!mapped.isOpen())
+        {
+            throw runtime_error("can't open " + file);
+        }
+
+        SaveReader save(mapped.begin(), mapped.size());
+        vector<size_t> offsets;
+        save.findSections(SAVE_MESSAGES, offsets);
+        if(offsets.empty()) return;
+
+        save.seek(offsets[0]);
+        messageTracker.loadFromDisk(save);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : loadGame
+        Description : Resumes a saved game: the current level and the message log
+                      are loaded, and the other levels are left in the save until
+                      they are needed.  Nothing is replaced unless both load.
+        Inputs      : file name, message log to replace
+        Outputs     : throws runtime_error if the file can't be read or is damaged
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void loadGame(const string& file, MessageTracker& messageTracker)
+    {
+        MessageTracker messages(messageTracker);
+        loadMessages(file, messages);
+        Level::loadLevelsFromFile(file);
+        messageTracker = messages;
+    }
+}
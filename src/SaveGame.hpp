@@ -0,0 +1,82 @@
+#ifndef RLNS_SAVEGAME_HPP
+#define RLNS_SAVEGAME_HPP
+
+#include <chrono>
+#include <exception>
+#include <future>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "Level.hpp"
+#include "MappedFile.hpp"
+#include "MessageTracker.hpp"
+#include "SaveFile.hpp"
+#include "Types.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : GameSnapshot
+        Description : Everything a save holds, captured on the game thread: the
+                      level snapshots, the current level and the message log.  It
+                      is cheap to take, since levels that haven't changed since the
+                      last save share their map snapshot with it, and it never
+                      changes afterwards, so it can be saved from any thread.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class GameSnapshot
+    {
+        // Member Variables
+        private:
+            unsigned int currentLevel;
+            std::vector<LevelSnapshotPtr> levels;
+            std::list<MessagePtr> messages;
+
+        // Member Functions
+        public:
+            GameSnapshot(const MessageTracker&);
+
+            void saveToDisk(SaveWriter&) const;
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : BackgroundSaver
+        Description : Saves the game without stopping it.  start() takes a snapshot
+                      on the game thread and hands it to a worker thread, which
+                      serializes, compresses and writes it.  The game thread calls
+                      poll() every frame, which never blocks; once the save is done
+                      it reports the result in the message log.  One save runs at a
+                      time.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class BackgroundSaver
+    {
+        // Member Variables
+        private:
+            std::future<bool> pending;
+            std::chrono::steady_clock::time_point started;
+
+        // Member Functions
+        public:
+            bool isSaving() const { return pending.valid(); }
+
+            bool start(const std::string&, MessageTracker&);
+            void poll(MessageTracker&);
+            void wait(MessageTracker&);
+    };
+
+
+    // Non-member Functions
+
+    void loadMessages(const std::string&, MessageTracker&);
+    void loadGame(const std::string&, MessageTracker&);
+}
+
+#endif
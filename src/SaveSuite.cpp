@@ -0,0 +1,588 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Actor.hpp"
+#include "InactiveLevels.hpp"
+#include "Level.hpp"
+#include "MappedFile.hpp"
+#include "Party.hpp"
+#include "Pool.hpp"
+#include "SaveFile.hpp"
+#include "Tile.hpp"
+#include "Tileset.hpp"
+#include "Types.hpp"
+#include "Vault.hpp"
+
+using namespace std;
+using namespace rlns;
+
+typedef chrono::steady_clock Clock;
+
+/*--------------------------------------------------------------------------------
+    Struct      : LevelResult
+    Description : What the suite found for one level: its size, how each format
+                  did with it, and the first difference found, if any.
+--------------------------------------------------------------------------------*/
+struct LevelResult
+{
+    string tileset;
+    uint32_t seed;
+    size_t items;
+    long oldBytes, newBytes;
+    double oldSave, oldLoad, newSave, newLoad;
+    string problem;
+};
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : millisecondsSince
+    Description : Returns the time elapsed since the given point.
+    Inputs      : start time
+    Outputs     : None
+    Return      : double (milliseconds)
+--------------------------------------------------------------------------------*/
+static double millisecondsSince(const Clock::time_point start)
+{
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : fileSize
+    Description : Returns the size of a file on disk.
+    Inputs      : file name
+    Outputs     : None
+    Return      : long (bytes, or -1 if the file can't be opened)
+--------------------------------------------------------------------------------*/
+static long fileSize(const string& name)
+{
+    FILE* file = fopen(name.c_str(), "rb");
+    if(file == NULL) return -1;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : addScaledTileset
+    Description : Adds a copy of a tileset whose maps have the given size, so the
+                  same generator can be tried on small and large maps.
+    Inputs      : tileset to copy, map width and height
+    Outputs     : None
+    Return      : string (the new tileset's name)
+--------------------------------------------------------------------------------*/
+static string addScaledTileset(const Tileset& t, const int width, const int height)
+{
+    ostringstream name;
+    name << t.getName() << " " << width << "x" << height;
+    string n = name.str();
+
+    temp_tileset scaled = { n.c_str(), t.getType(),
+                            t.getFloorTileID(), t.getWallTileID(), t.getFillerTileID(),
+                            t.getUpStairTileID(), t.getDownStairTileID(),
+                            t.getN_S_DoorID(), t.getE_W_DoorID(), t.getAmbientLight(),
+                            width, height, t.getRecurseLevel(),
+                            t.getMinHSize(), t.getMinVSize(),
+                            t.getMaxHRatio(), t.getMaxVRatio() };
+    Tileset::list.push_back(TilesetPtr(new Tileset(scaled)));
+    return n;
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : compareLevels
+    Description : Compares two levels cell by cell: the tileset, every tile of
+                  every cell, both stairs and, if asked, the items and areas.
+    Inputs      : expected level, level to check, whether to compare the items
+                  and areas
+    Outputs     : None
+    Return      : string (the first difference, or empty if they match)
+--------------------------------------------------------------------------------*/
+static string compareLevels(const Level& expected, const Level& actual, const bool withItems)
+{
+    ostringstream difference;
+
+    if(expected.getTileset() != actual.getTileset())
+        return "tileset differs";
+    if(expected.getMapWidth() != actual.getMapWidth() ||
+       expected.getMapHeight() != actual.getMapHeight())
+        return "map size differs";
+
+    for(int x=0; x<expected.getMapWidth(); ++x)
+    {
+        for(int y=0; y<expected.getMapHeight(); ++y)
+        {
+            if(expected.getTiles(x,y) != actual.getTiles(x,y))
+            {
+                difference << "tiles differ at (" << x << "," << y << ")";
+                return difference.str();
+            }
+        }
+    }
+
+    if(expected.getUpStairLocation() != actual.getUpStairLocation())
+        return "up stairs differ";
+    if(expected.getDownStairLocation() != actual.getDownStairLocation())
+        return "down stairs differ";
+
+    if(!withItems) return "";
+
+    vector<ItemPtr> e = expected.getItems(), a = actual.getItems();
+    if(e.size() != a.size())
+    {
+        difference << e.size() << " items became " << a.size();
+        return difference.str();
+    }
+    for(size_t i=0; i<e.size(); ++i)
+    {
+        if(e[i]->getPosition() != a[i]->getPosition() ||
+           e[i]->getName() != a[i]->getName() ||
+           e[i]->getCount() != a[i]->getCount())
+        {
+            difference << "item " << i << " differs";
+            return difference.str();
+        }
+    }
+
+    const vector<AreaPtr>& ea = expected.getAreas();
+    const vector<AreaPtr>& aa = actual.getAreas();
+    if(ea.size() != aa.size())
+    {
+        difference << ea.size() << " areas became " << aa.size();
+        return difference.str();
+    }
+    for(size_t i=0; i<ea.size(); ++i)
+    {
+        if(ea[i]->getTL() != aa[i]->getTL() || ea[i]->getBR() != aa[i]->getBR() ||
+           ea[i]->getNumOpenCells() != aa[i]->getNumOpenCells())
+        {
+            difference << "area " << i << " differs";
+            return difference.str();
+        }
+    }
+    return "";
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : roundTripOld
+    Description : Saves a level to a file in the old RLNSZip format and loads it
+                  back.  The old format has no items, so only the map is checked.
+    Inputs      : level, file name, result to fill
+    Outputs     : bytes, times and any difference, in the result
+    Return      : void
+--------------------------------------------------------------------------------*/
+static void roundTripOld(const Level& level, const string& file, LevelResult& result)
+{
+    Clock::time_point start = Clock::now();
+    RLNSZip zip;
+    level.saveToDisk(zip);
+    zip.saveToFile(file.c_str());
+    result.oldSave = millisecondsSince(start);
+    result.oldBytes = fileSize(file);
+
+    start = Clock::now();
+    RLNSZip loadZip;
+    loadZip.loadFromFile(file.c_str());
+    Level loaded(loadZip);
+    result.oldLoad = millisecondsSince(start);
+
+    string problem = compareLevels(level, loaded, false);
+    if(!problem.empty() && result.problem.empty()) result.problem = "old format: " + problem;
+    remove(file.c_str());
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : roundTripNew
+    Description : Saves a level to a file in the sectioned format and loads it
+                  back, checking the map and the items.
+    Inputs      : level, file name, result to fill
+    Outputs     : bytes, times and any difference, in the result
+    Return      : void
+--------------------------------------------------------------------------------*/
+static void roundTripNew(const Level& level, const string& file, LevelResult& result)
+{
+    Clock::time_point start = Clock::now();
+    SaveWriter save;
+    save.beginSection(SAVE_LEVEL);
+    level.saveToDisk(save);
+    save.endSection();
+    bool saved = save.saveToFile(file);
+    result.newSave = millisecondsSince(start);
+    result.newBytes = fileSize(file);
+
+    if(!saved)
+    {
+        if(result.problem.empty()) result.problem = "new format: couldn't write " + file;
+        return;
+    }
+
+    try
+    {
+        start = Clock::now();
+        MappedFile mapped(file);
+        SaveReader reader(mapped.begin(), mapped.size());
+        reader.beginSection(SAVE_LEVEL);
+        Level loaded(reader);
+        reader.endSection();
+        result.newLoad = millisecondsSince(start);
+
+        string problem = compareLevels(level, loaded, true);
+        if(!problem.empty() && result.problem.empty()) result.problem = "new format: " + problem;
+    }
+    catch(const runtime_error& e)
+    {
+        result.newLoad = 0;
+        if(result.problem.empty()) result.problem = string("new format: ") + e.what();
+    }
+    remove(file.c_str());
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : hasPlayerParty
+    Description : Returns whether the player's party is on the given level.
+    Inputs      : level
+    Outputs     : None
+    Return      : bool
+--------------------------------------------------------------------------------*/
+static bool hasPlayerParty(const LevelPtr& level)
+{
+    vector<PartyPtr> parties = level->getParties();
+    return find(parties.begin(), parties.end(), Party::getPlayerParty()) != parties.end();
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : checkLevelChange
+    Description : Plays three levels of a game down and back up one, checking
+                  that the player's party goes along to the right stair, that
+                  the level left is parked in memory, that parked levels go to
+                  the swap file once the levels are over the budget, and that
+                  the swap file doesn't grow as the same levels are evicted
+                  over and over.
+    Inputs      : game seed
+    Outputs     : None
+    Return      : string (the first problem found, empty if there is none)
+--------------------------------------------------------------------------------*/
+static string checkLevelChange(const uint32_t seed)
+{
+    Level::setGameSeed(seed);
+    for(int i=0; i<3; ++i)
+    {
+        Level::addLevel("Castle");
+    }
+
+    Point start = Level::getCurrentLevel()->getUpStairLocation();
+    ActorPtr player = allocatePooled<Actor>(Arena::global(), "Actor", start, '@', TCODColor::white);
+    PartyPtr party(new Party);
+    party->addMember(player);
+    Party::setPlayerParty(party);
+    Level::getCurrentLevel()->addParty(party);
+
+    const InactiveLevels& inactive = Level::getInactiveLevels();
+    if(!Level::gotoNextLevel()) return "couldn't go down to level 1";
+    if(!hasPlayerParty(Level::getCurrentLevel())) return "the party didn't arrive on level 1";
+    if(player->getPosition() != Level::getCurrentLevel()->getUpStairLocation())
+    {
+        return "the party didn't arrive on the up stair of level 1";
+    }
+    if(inactive.getPlace(0) != InactiveLevels::IN_MEMORY) return "level 0 wasn't parked when it was left";
+
+    // nothing fits in one byte, so every level but the current one is evicted
+    Level::setMemoryBudget(1);
+    if(!Level::gotoNextLevel()) return "couldn't go down to level 2";
+    if(inactive.getPlace(0) != InactiveLevels::IN_SWAP_FILE ||
+       inactive.getPlace(1) != InactiveLevels::IN_SWAP_FILE)
+    {
+        return "levels over the budget weren't moved to the swap file";
+    }
+
+    if(!Level::gotoPreviousLevel()) return "couldn't go back up to level 1";
+    if(!hasPlayerParty(Level::getCurrentLevel())) return "the party didn't arrive back on level 1";
+    if(player->getPosition() != Level::getCurrentLevel()->getDownStairLocation())
+    {
+        return "the party didn't arrive on the down stair of level 1";
+    }
+    if(inactive.getPlace(2) != InactiveLevels::IN_SWAP_FILE) return "level 2 wasn't evicted when it was left";
+
+    // the levels come and go unchanged, so they fit in the room they left
+    long swapSize = inactive.getSwapFileSize();
+    for(int i=0; i<10; ++i)
+    {
+        if(!Level::gotoNextLevel() || !Level::gotoPreviousLevel()) return "couldn't go down and up again";
+    }
+    if(inactive.getSwapFileSize() > swapSize) return "the swap file grows as levels are evicted again";
+
+    return "";
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : readThrough
+    Description : Compares every cell of a map with the tiles expected, column
+                  by column, trimming the map after each column.
+    Inputs      : map, tiles expected, column after column
+    Outputs     : None
+    Return      : string (the first difference, or empty if they match)
+--------------------------------------------------------------------------------*/
+static string readThrough(const MapPtr map, const vector< vector<int> >& expected)
+{
+    ostringstream difference;
+    size_t cell = 0;
+    for(size_t x=0; x<map->getWidth(); ++x)
+    {
+        for(size_t y=0; y<map->getHeight(); ++y, ++cell)
+        {
+            if(map->at(x,y) != expected[cell])
+            {
+                difference << "tiles differ at (" << x << "," << y << ")";
+                return difference.str();
+            }
+        }
+        map->trim();
+        if(map->getNumResident() > Map::STREAMED_CHUNKS) return "more chunks in memory than the map keeps";
+    }
+    return "";
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : saveMap
+    Description : Saves a map in the sectioned format and loads it back.
+    Inputs      : map, number of chunks saved to fill in
+    Outputs     : the number of chunks the save holds
+    Return      : MapPtr (the map loaded)
+--------------------------------------------------------------------------------*/
+static MapPtr saveMap(const MapPtr map, size_t& savedChunks)
+{
+    SaveWriter save;
+    map->saveToDisk(save);
+    vector<char> bytes;
+    save.packSections(bytes, true);
+
+    SaveReader header(&bytes[0], bytes.size());
+    header.beginSection(SAVE_TILESET);
+    header.getString();
+    header.endSection();
+    header.beginSection(SAVE_TERRAIN);
+    header.get<uint32_t>();
+    header.get<uint32_t>();
+    header.get<uint8_t>();
+    header.get<uint32_t>();
+    vector<uint32_t> chunks;
+    header.getBlock(chunks);
+    savedChunks = chunks.size();
+
+    SaveReader reader(&bytes[0], bytes.size());
+    return MapPtr(new Map(reader));
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : checkStreamedMap
+    Description : Builds large overworld maps, which are streamed, and checks
+                  that no more of their chunks stay in memory than a map keeps
+                  while it is built and read through, that chunks let go
+                  unchanged come back the same, that changes to many more
+                  chunks than that survive the swap file, that a save holds
+                  only the changed chunks and loads back the same map, and
+                  that a map's memory doesn't grow with its size.
+    Inputs      : seed
+    Outputs     : None
+    Return      : string (the first problem found, empty if there is none)
+--------------------------------------------------------------------------------*/
+static string checkStreamedMap(const uint32_t seed)
+{
+    const Tileset& plains = *Tileset::findTileset("Plains");
+    size_t memory[2] = { 0, 0 };
+    for(int m=0; m<2; ++m)
+    {
+        MapPtr map(new Map(Tileset::findTileset(addScaledTileset(plains, 400 << m, 400 << m))));
+        if(!map->isStreamed()) return "overworld maps aren't streamed";
+
+        MapBuilderPtr builder = GeneratorRegistry::createBuilder(map);
+        builder->setSeed(seed);
+        builder->buildMap();
+        if(map->getNumResident() > Map::STREAMED_CHUNKS) return "building left more chunks in memory than the map keeps";
+
+        // chunks let go the first time through are generated again the second
+        vector< vector<int> > tiles;
+        for(size_t x=0; x<map->getWidth(); ++x)
+        {
+            for(size_t y=0; y<map->getHeight(); ++y)
+            {
+                tiles.push_back(map->at(x,y));
+            }
+            map->trim();
+        }
+        string problem = readThrough(map, tiles);
+        if(!problem.empty()) return "generated again: " + problem;
+        memory[m] = map->memoryUsage();
+
+        size_t savedChunks = 0;
+        problem = readThrough(saveMap(map, savedChunks), tiles);
+        if(!problem.empty()) return "saved as built: " + problem;
+        if(savedChunks >= map->getNumChunks()) return "a map saved as built holds chunks nothing changed";
+
+        // a change in every chunk, many more than the map keeps
+        const int id = map->tileset->getDownStairTileID();
+        for(size_t x=1; x<map->getWidth(); x+=MapChunk::SIZE)
+        {
+            for(size_t y=1; y<map->getHeight(); y+=MapChunk::SIZE)
+            {
+                map->addFeature(x,y, id);
+                tiles[x*map->getHeight() + y].push_back(id);
+            }
+            map->trim();
+        }
+        problem = readThrough(map, tiles);
+        if(!problem.empty()) return "swapped out: " + problem;
+
+        problem = readThrough(saveMap(map, savedChunks), tiles);
+        if(!problem.empty()) return "saved changed: " + problem;
+        if(savedChunks != map->getNumChunks()) return "a save lost changed chunks";
+    }
+
+    // four times the cells, about the same memory
+    if(memory[1] > memory[0] + memory[0]/4) return "memory grows with the size of the map";
+    return "";
+}
+
+
+
+/*--------------------------------------------------------------------------------
+    Function    : main
+    Description : Round trip suite for saved levels.  Generates seeded levels of
+                  every tileset at three map sizes, each several levels deep,
+                  without opening a window.  Every level is generated twice to
+                  check that its seed decides it, then saved and loaded in both
+                  the old RLNSZip format and the sectioned format, and the loaded
+                  level is compared with the original cell by cell.  Prints the
+                  bytes written and the save and load times of each level, and
+                  the totals.  Then a game goes down and up its levels, to
+                  check that the levels left are parked and evicted, and large
+                  overworld maps are checked for streaming.  Run from the
+                  directory that holds datafiles/.
+    Inputs      : optional number of levels per tileset and size (default 3),
+                  optional first seed (default 1)
+    Outputs     : a table on stdout, differences on stderr
+    Return      : int (0 if every level came back unchanged)
+--------------------------------------------------------------------------------*/
+int main(int argc, char* argv[])
+{
+    int depth = (argc > 1) ? atoi(argv[1]) : 3;
+    if(depth < 1) depth = 1;
+    uint32_t seed = (argc > 2) ? strtoul(argv[2], NULL, 10) : 1;
+
+    const string oldFile("savesuite.old.sav");
+    const string newFile("savesuite.new.sav");
+    const int sizes[] = { 50, 100, 200 };
+
+    TileParser("./datafiles/tiles.txt").run();
+    TilesetParser("./datafiles/tileset.txt").run();
+    VaultParser("./datafiles/vaults.txt").run();
+
+    vector<string> tilesets;
+    vector<TilesetPtr> originals(Tileset::list);
+    for(size_t s=0; s<sizeof(sizes)/sizeof(sizes[0]); ++s)
+    {
+        for(size_t t=0; t<originals.size(); ++t)
+        {
+            tilesets.push_back(addScaledTileset(*originals[t], sizes[s], sizes[s]));
+        }
+    }
+
+    vector<LevelResult> results;
+    for(size_t t=0; t<tilesets.size(); ++t)
+    {
+        for(int d=0; d<depth; ++d, ++seed)
+        {
+            LevelResult result = { tilesets[t], seed, 0, -1, -1, 0, 0, 0, 0, "" };
+
+            Level level(tilesets[t], seed);
+            Level again(tilesets[t], seed);
+            result.items = level.getItems().size();
+            result.problem = compareLevels(level, again, true);
+            if(!result.problem.empty()) result.problem = "same seed: " + result.problem;
+
+            roundTripOld(level, oldFile, result);
+            roundTripNew(level, newFile, result);
+            results.push_back(result);
+        }
+    }
+
+    cout << left << setw(24) << "tileset" << right << setw(8) << "seed" << setw(7) << "items"
+         << setw(10) << "old B" << setw(9) << "save ms" << setw(9) << "load ms"
+         << setw(10) << "new B" << setw(9) << "save ms" << setw(9) << "load ms"
+         << "  result" << endl;
+    cout << fixed << setprecision(2);
+
+    long oldBytes = 0, newBytes = 0;
+    double oldSave = 0, oldLoad = 0, newSave = 0, newLoad = 0;
+    int failures = 0;
+    for(size_t i=0; i<results.size(); ++i)
+    {
+        const LevelResult& r = results[i];
+        cout << left << setw(24) << r.tileset << right << setw(8) << r.seed << setw(7) << r.items
+             << setw(10) << r.oldBytes << setw(9) << r.oldSave << setw(9) << r.oldLoad
+             << setw(10) << r.newBytes << setw(9) << r.newSave << setw(9) << r.newLoad
+             << "  " << (r.problem.empty() ? "ok" : "FAILED") << endl;
+        if(!r.problem.empty())
+        {
+            cerr << r.tileset << ", seed " << r.seed << ": " << r.problem << endl;
+            ++failures;
+        }
+
+        oldBytes += r.oldBytes; newBytes += r.newBytes;
+        oldSave += r.oldSave; oldLoad += r.oldLoad;
+        newSave += r.newSave; newLoad += r.newLoad;
+    }
+
+    cout << left << setw(39) << "total" << right
+         << setw(10) << oldBytes << setw(9) << oldSave << setw(9) << oldLoad
+         << setw(10) << newBytes << setw(9) << newSave << setw(9) << newLoad << endl;
+    cout << results.size() - failures << " of " << results.size() << " levels came back unchanged"
+         << (SaveWriter().isChecked() ? " (checked saves)" : "") << endl;
+
+
+    string levelChange = checkLevelChange(seed);
+    cout << "changing levels: " << (levelChange.empty() ? "ok" : "FAILED") << endl;
+    if(!levelChange.empty())
+    {
+        cerr << "changing levels: " << levelChange << endl;
+        ++failures;
+    }
+
+    string streaming = checkStreamedMap(seed);
+    cout << "streaming maps: " << (streaming.empty() ? "ok" : "FAILED") << endl;
+    if(!streaming.empty())
+    {
+        cerr << "streaming maps: " << streaming << endl;
+        ++failures;
+    }
+
+    return (failures == 0) ? 0 : 1;
+}
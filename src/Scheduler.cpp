@@ -0,0 +1,201 @@
+#include <algorithm>
+
+#include "Scheduler.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    const unsigned int Scheduler::NORMAL_COST;
+    const unsigned int Scheduler::NORMAL_SPEED;
+    const unsigned int Scheduler::WHEEL_SIZE;
+    const Entity Scheduler::PLAYER = { 0xFFFFFFFF, 0 };
+
+    /*--------------------------------------------------------------------------------
+        Function    : Scheduler::Scheduler
+        Description : Makes an empty scheduler at tick zero.
+        Inputs      : None
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    Scheduler::Scheduler()
+    : wheel(WHEEL_SIZE), now(0), next(0), inWheel(0) {}
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Scheduler::schedule
+        Description : Has an actor act once the given number of ticks has passed.
+                      With no ticks it acts again on this tick, after those already
+                      waiting for it.
+        Inputs      : actor, ticks from now
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Scheduler::schedule(const Entity who, const unsigned int ticks)
+    {
+        if(ticks < WHEEL_SIZE)
+        {
+            wheel[(now + ticks) & (WHEEL_SIZE - 1)].push_back(who);
+            ++inWheel;
+        }
+        else
+        {
+            Waiting waiting = { who, now + ticks };
+            overflow.push_back(waiting);
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Scheduler::pop
+        Description : Returns the next actor to act, moving time on to its tick.
+        Inputs      : None
+        Outputs     : the actor
+        Return      : bool (false if no one is waiting)
+    --------------------------------------------------------------------------------*/
+    bool Scheduler::pop(Entity& who)
+    {
+        if(!findDue()) return false;
+
+        who = wheel[now & (WHEEL_SIZE - 1)][next++];
+        --inWheel;
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Scheduler::popTick
+        Description : Returns every actor due on the next tick anyone is due,
+                      moving time on to it, in the order pop() would give them.
+                      It stops after the player's party, so those due after it on
+                      the same tick wait for its turn.  Actors scheduled with no
+                      delay meanwhile are left for the next call.
+        Inputs      : vector to fill
+        Outputs     : the actors
+        Return      : size_t (number of actors, 0 if no one is waiting)
+    --------------------------------------------------------------------------------*/
+    size_t Scheduler::popTick(vector<Entity>& due)
+    {
+        due.clear();
+        if(!findDue()) return 0;
+
+        const vector<Entity>& bucket = wheel[now & (WHEEL_SIZE - 1)];
+        while(next < bucket.size())
+        {
+            due.push_back(bucket[next++]);
+            --inWheel;
+            if(due.back() == PLAYER) break;
+        }
+        return due.size();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Scheduler::findDue
+        Description : Moves time on until someone is due on the current tick.
+        Inputs      : None
+        Outputs     : None
+        Return      : bool (false if no one is waiting)
+    --------------------------------------------------------------------------------*/
+    bool Scheduler::findDue()
+    {
+        while(next >= wheel[now & (WHEEL_SIZE - 1)].size())
+        {
+            if(empty()) return false;
+            advance();
+        }
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Scheduler::advance
+        Description : Moves on to the next tick.  Each time the wheel comes round,
+                      the overflowing actors due before it comes round again are
+                      sorted into it; if only overflowing actors are left, time
+                      jumps straight to the turn of the wheel the first is due in.
+        Inputs      : None
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Scheduler::advance()
+    {
+        wheel[now & (WHEEL_SIZE - 1)].clear();
+        next = 0;
+
+        uint64_t turn = (now | (WHEEL_SIZE - 1)) + 1;
+        if(inWheel == 0 && !overflow.empty())
+        {
+            uint64_t earliest = overflow[0].time;
+            for(size_t i=1; i<overflow.size(); ++i)
+            {
+                earliest = min(earliest, overflow[i].time);
+            }
+            now = max(turn, earliest & ~static_cast<uint64_t>(WHEEL_SIZE - 1));
+        }
+        else
+        {
+            ++now;
+            if(now != turn) return;
+        }
+
+        size_t kept = 0;
+        for(size_t i=0; i<overflow.size(); ++i)
+        {
+            if(overflow[i].time < now + WHEEL_SIZE)
+            {
+                wheel[overflow[i].time & (WHEEL_SIZE - 1)].push_back(overflow[i].who);
+                ++inWheel;
+            }
+            else
+            {
+                overflow[kept++] = overflow[i];
+            }
+        }
+        overflow.resize(kept);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Scheduler::clear
+        Description : Forgets every waiting actor and starts again at tick zero.
+        Inputs      : None
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Scheduler::clear()
+    {
+        for(size_t i=0; i<wheel.size(); ++i)
+        {
+            wheel[i].clear();
+        }
+        overflow.clear();
+        now = 0;
+        next = 0;
+        inWheel = 0;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Scheduler::delay
+        Description : Returns the ticks an action takes an actor of the given speed.
+                      An actor of twice the normal speed takes half as long; every
+                      action that costs anything takes at least a tick.
+        Inputs      : cost of the action at normal speed, speed
+        Outputs     : None
+        Return      : unsigned int
+    --------------------------------------------------------------------------------*/
+    unsigned int Scheduler::delay(const unsigned int cost, const unsigned int speed)
+    {
+        if(cost == 0) return 0;
+        uint64_t ticks = static_cast<uint64_t>(cost) * NORMAL_SPEED / max(speed, 1u);
+        return static_cast<unsigned int>(max<uint64_t>(ticks, 1));
+    }
+}
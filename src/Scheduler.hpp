@@ -0,0 +1,72 @@
+#ifndef RLNS_SCHEDULER_HPP
+#define RLNS_SCHEDULER_HPP
+
+#include <vector>
+
+#include <stdint.h>
+
+#include "EntityStore.hpp"
+#include "Types.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : Scheduler
+        Description : Decides who acts next on a level.  Time is counted in ticks;
+                      an action's cost is the ticks it takes at normal speed, and
+                      faster actors spend fewer.  Actors waiting to act are kept in
+                      a timing wheel with a bucket per tick, so finding the next
+                      one never looks at the others; actors due further off than
+                      the wheel reaches wait in an overflow list that is sorted
+                      into the wheel once per turn of it.  Actors due on the same
+                      tick act in the order they were scheduled.  Destroyed
+                      entities aren't removed, but skipped by whoever dispatches.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class Scheduler
+    {
+        // Member Variables
+        public:
+            static const unsigned int NORMAL_COST = 100;  // ticks for one action
+            static const unsigned int NORMAL_SPEED = 100;
+            static const Entity PLAYER; // stands for the player's party
+
+        private:
+            static const unsigned int WHEEL_SIZE = 1024; // ticks, a power of two
+
+            struct Waiting
+            {
+                Entity who;
+                uint64_t time;
+            };
+
+            std::vector< std::vector<Entity> > wheel;
+            std::vector<Waiting> overflow;
+            uint64_t now;
+            size_t next;    // in the current bucket
+            size_t inWheel; // still to act in the wheel
+
+        // Member Functions
+        private:
+            void advance();
+            bool findDue();
+
+        public:
+            Scheduler();
+
+            uint64_t getTime() const { return now; }
+            size_t size() const      { return inWheel + overflow.size(); }
+            bool empty() const       { return size() == 0; }
+
+            void schedule(const Entity, const unsigned int);
+            bool pop(Entity&);
+            size_t popTick(std::vector<Entity>&);
+            void clear();
+
+            static unsigned int delay(const unsigned int, const unsigned int);
+    };
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef RLNS_SUMMEDAREATABLE_HPP
+#define RLNS_SUMMEDAREATABLE_HPP
+
+#include <vector>
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : SummedAreaTable
+        Description : Counts the cells of a grid that satisfy a predicate, so that
+                      the number inside any rectangle can be read back with four
+                      lookups instead of visiting every cell.  The table is one
+                      row and one column larger than the grid, with a zero border,
+                      and is laid out column by column like Map.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class SummedAreaTable
+    {
+        // Member Variables
+        private:
+            int width, height;
+            std::vector<int> sums; // sums[x*(height+1)+y] covers [0,x) x [0,y)
+
+        // Member Functions
+        private:
+            int at(const int x, const int y) const
+            { return sums[x*(height+1) + y]; }
+
+        public:
+            /*--------------------------------------------------------------------------------
+                Function    : SummedAreaTable::SummedAreaTable
+                Description : Builds the table for a width by height grid, counting the
+                              cells for which pred(x,y) is true.
+                Inputs      : grid width, grid height, predicate
+                Outputs     : None
+                Return      : None (constructor)
+            --------------------------------------------------------------------------------*/
+            template<class Predicate>
+            SummedAreaTable(const int w, const int h, Predicate pred)
+            : width(w), height(h), sums((w+1)*(h+1), 0)
+            {
+                for(int x=1; x<=width; ++x)
+                {
+                    int column = 0; // cells counted so far in column x-1
+                    for(int y=1; y<=height; ++y)
+                    {
+                        column += pred(x-1, y-1) ? 1 : 0;
+                        sums[x*(height+1) + y] = sums[(x-1)*(height+1) + y] + column;
+                    }
+                }
+            }
+
+            int getWidth() const  { return width;  }
+            int getHeight() const { return height; }
+
+            // number of counted cells in the w by h rectangle with topleft (x,y)
+            int count(const int x, const int y, const int w, const int h) const
+            { return at(x+w, y+h) - at(x, y+h) - at(x+w, y) + at(x, y); }
+
+            bool all(const int x, const int y, const int w, const int h) const
+            { return count(x, y, w, h) == w*h; }
+    };
+}
+
+#endif
@@ -0,0 +1,215 @@
+#include "SwapFile.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Function    : SwapFile::SwapFile
+        Description : Opens a new temporary file.  If none can be made the swap
+                      file stays closed and whatever would be swapped out is kept
+                      in memory instead.
+        Inputs      : None
+        Outputs     : None
+        Return      : None (constructor)
+    --------------------------------------------------------------------------------*/
+    SwapFile::SwapFile()
+    : file(tmpfile()), end(0) {}
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SwapFile::~SwapFile
+        Description : Closes the file, which deletes it.
+        Inputs      : None
+        Outputs     : None
+        Return      : None (destructor)
+    --------------------------------------------------------------------------------*/
+    SwapFile::~SwapFile()
+    {
+        if(file != NULL) fclose(file);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SwapFile::getSize
+        Description : Returns how many bytes the file takes, free extents included.
+        Inputs      : None
+        Outputs     : None
+        Return      : long
+    --------------------------------------------------------------------------------*/
+    long SwapFile::getSize() const
+    {
+        lock_guard<mutex> guard(lock);
+        return end;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SwapFile::addFree
+        Description : Adds an extent to the free lists.  The lock must be held.
+        Inputs      : where it starts, its size
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void SwapFile::addFree(const long offset, const size_t size)
+    {
+        freeBySize.insert(make_pair(size, offset));
+        freeByOffset[offset] = size;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SwapFile::removeFree
+        Description : Takes an extent off the free lists.  The lock must be held.
+        Inputs      : where it starts, its size
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void SwapFile::removeFree(const long offset, const size_t size)
+    {
+        freeByOffset.erase(offset);
+
+        pair<multimap<size_t, long>::iterator, multimap<size_t, long>::iterator> same;
+        same = freeBySize.equal_range(size);
+        for(multimap<size_t, long>::iterator it=same.first; it!=same.second; ++it)
+        {
+            if(it->second == offset)
+            {
+                freeBySize.erase(it);
+                return;
+            }
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SwapFile::allocate
+        Description : Finds room for the given number of bytes: the smallest free
+                      extent that holds them, with what is left of it kept free,
+                      or else the end of the file, taking in a free extent that
+                      ends there.  The lock must be held.
+        Inputs      : number of bytes
+        Outputs     : None
+        Return      : long (where they go)
+    --------------------------------------------------------------------------------*/
+    long SwapFile::allocate(const size_t n)
+    {
+        multimap<size_t, long>::iterator fits = freeBySize.lower_bound(n);
+        if(fits != freeBySize.end())
+        {
+            long offset = fits->second;
+            size_t size = fits->first;
+            removeFree(offset, size);
+            if(size > n) addFree(offset + n, size - n);
+            return offset;
+        }
+
+        long offset = end;
+        if(!freeByOffset.empty())
+        {
+            map<long, size_t>::iterator last = --freeByOffset.end();
+            if(last->first + static_cast<long>(last->second) == end)
+            {
+                offset = last->first;
+                removeFree(last->first, last->second);
+            }
+        }
+        end = offset + n;
+        return offset;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SwapFile::release
+        Description : Frees an extent, joining it with the free extents on either
+                      side of it.  The lock must be held.
+        Inputs      : where it starts, its size
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void SwapFile::release(long offset, size_t size)
+    {
+        map<long, size_t>::iterator next = freeByOffset.lower_bound(offset);
+        if(next != freeByOffset.begin())
+        {
+            map<long, size_t>::iterator previous = next;
+            --previous;
+            if(previous->first + static_cast<long>(previous->second) == offset)
+            {
+                offset = previous->first;
+                size += previous->second;
+                removeFree(previous->first, previous->second);
+            }
+        }
+        if(next != freeByOffset.end() && offset + static_cast<long>(size) == next->first)
+        {
+            size += next->second;
+            removeFree(next->first, next->second);
+        }
+        addFree(offset, size);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SwapFile::write
+        Description : Writes the given bytes where there is room for them.  They
+                      stay there until the extent returned is let go by everything
+                      holding it.
+        Inputs      : bytes to write
+        Outputs     : None
+        Return      : SwapExtentPtr (null if they weren't written)
+    --------------------------------------------------------------------------------*/
+    SwapExtentPtr SwapFile::write(const vector<char>& bytes)
+    {
+        lock_guard<mutex> guard(lock);
+        if(file == NULL || bytes.empty()) return SwapExtentPtr();
+
+        long offset = allocate(bytes.size());
+        if(fseek(file, offset, SEEK_SET) != 0 ||
+           fwrite(&bytes[0], 1, bytes.size(), file) != bytes.size() || fflush(file) != 0)
+        {
+            release(offset, bytes.size());
+            return SwapExtentPtr();
+        }
+
+        SwapExtent* extent = new SwapExtent;
+        extent->offset = offset;
+        extent->size = bytes.size();
+
+        // the extent keeps the file open until it is freed
+        boost::shared_ptr<SwapFile> self = shared_from_this();
+        return SwapExtentPtr(extent, [self](const SwapExtent* freed)
+        {
+            lock_guard<mutex> guard(self->lock);
+            self->release(freed->offset, freed->size);
+            delete freed;
+        });
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : SwapFile::read
+        Description : Reads back bytes written by write().
+        Inputs      : where they were written, vector to fill
+        Outputs     : the bytes; throws runtime_error if they can't be read
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void SwapFile::read(const SwapExtent& extent, vector<char>& bytes)
+    {
+        lock_guard<mutex> guard(lock);
+        bytes.resize(extent.size);
+        if(file == NULL || fseek(file, extent.offset, SEEK_SET) != 0 ||
+           (extent.size > 0 && fread(&bytes[0], 1, extent.size, file) != extent.size))
+        {
+            throw runtime_error("can't read back from the swap file");
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef RLNS_SWAPFILE_HPP
+#define RLNS_SWAPFILE_HPP
+
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "Types.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Struct      : SwapExtent
+        Description : Where a level or a map chunk was written in the swap file.
+    --------------------------------------------------------------------------------*/
+    struct SwapExtent
+    {
+        long offset;
+        size_t size;
+    };
+
+    typedef boost::shared_ptr<const SwapExtent> SwapExtentPtr;
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : SwapFile
+        Description : A temporary file that evicted levels and map chunks are
+                      written to.  Each write is given back as an extent, which is
+                      freed once nothing holds it any more, so a save running on
+                      another thread can still read a level after it has been
+                      brought back.  Freed extents are kept by size and reused, the
+                      smallest that fits first, and neighbouring ones are joined,
+                      so the file stays near the size of what is in it however
+                      often it comes and goes.  Reads and writes may come from any
+                      thread.  The file is deleted when it is closed.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class SwapFile: public boost::enable_shared_from_this<SwapFile>
+    {
+        // Member Variables
+        private:
+            FILE* file;
+            long end;                              // bytes the file takes
+            std::multimap<size_t, long> freeBySize; // free extents, to find one that fits
+            std::map<long, size_t> freeByOffset;   // the same, to find their neighbours
+            mutable std::mutex lock;
+
+        // Member Functions
+        private:
+            SwapFile(const SwapFile&);
+            SwapFile& operator=(const SwapFile&);
+
+            long allocate(const size_t);
+            void release(long, size_t);
+            void addFree(const long, const size_t);
+            void removeFree(const long, const size_t);
+
+        public:
+            SwapFile();
+            ~SwapFile();
+
+            bool isOpen() const { return file != NULL; }
+            long getSize() const;
+
+            SwapExtentPtr write(const std::vector<char>&);
+            void read(const SwapExtent&, std::vector<char>&);
+    };
+}
+
+#endif
@@ -0,0 +1,102 @@
+#include "TaskGraph.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Function    : TaskGraph::addTask
+        Description : Adds a task that may run on any thread.
+        Inputs      : task name, work to do, indices of the tasks it depends on
+        Outputs     : None
+        Return      : size_t (index of the new task)
+    --------------------------------------------------------------------------------*/
+    size_t TaskGraph::addTask(const string& name, const function<void()>& work,
+                              const vector<size_t>& dependencies)
+    {
+        Task task = { name, work, dependencies, false };
+        tasks.push_back(task);
+        return tasks.size() - 1;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : TaskGraph::addMainThreadTask
+        Description : Adds a task that must run on the thread that calls run().
+        Inputs      : task name, work to do, indices of the tasks it depends on
+        Outputs     : None
+        Return      : size_t (index of the new task)
+    --------------------------------------------------------------------------------*/
+    size_t TaskGraph::addMainThreadTask(const string& name, const function<void()>& work,
+                                        const vector<size_t>& dependencies)
+    {
+        Task task = { name, work, dependencies, true };
+        tasks.push_back(task);
+        return tasks.size() - 1;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : TaskGraph::run
+        Description : Runs every task and waits for all of them to finish.  Worker
+                      tasks are all started first, each waiting on its own
+                      dependencies, so they overlap with the main thread tasks.
+        Inputs      : profiler to time the tasks with
+        Outputs     : rethrows the first exception thrown by a task
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void TaskGraph::run(StartupProfiler& profiler)
+    {
+        vector< shared_future<void> > done(tasks.size());
+        vector< promise<void> > mainDone(tasks.size());
+
+        // every task can be waited on before it has started
+        for(size_t i=0; i<tasks.size(); ++i)
+        {
+            if(tasks[i].mainThread) done[i] = mainDone[i].get_future().share();
+        }
+
+        for(size_t i=0; i<tasks.size(); ++i)
+        {
+            if(tasks[i].mainThread) continue;
+
+            const Task& task = tasks[i];
+            vector< shared_future<void> > waitFor;
+            for(size_t d=0; d<task.dependencies.size(); ++d)
+            {
+                waitFor.push_back(done[task.dependencies[d]]);
+            }
+
+            done[i] = async(launch::async, [&task, &profiler, waitFor]()
+            {
+                for(size_t d=0; d<waitFor.size(); ++d) waitFor[d].get();
+                profiler.time(task.name, task.work);
+            }).share();
+        }
+
+        for(size_t i=0; i<tasks.size(); ++i)
+        {
+            if(!tasks[i].mainThread) continue;
+
+            try
+            {
+                for(size_t d=0; d<tasks[i].dependencies.size(); ++d)
+                {
+                    done[tasks[i].dependencies[d]].get();
+                }
+                profiler.time(tasks[i].name, tasks[i].work);
+                mainDone[i].set_value();
+            }
+            catch(...)
+            {
+                mainDone[i].set_exception(current_exception());
+            }
+        }
+
+        // wait for everything before rethrowing, so no task outlives the graph
+        for(size_t i=0; i<done.size(); ++i) done[i].wait();
+        for(size_t i=0; i<done.size(); ++i) done[i].get();
+    }
+}
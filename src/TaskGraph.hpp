@@ -0,0 +1,51 @@
+#ifndef RLNS_TASKGRAPH_HPP
+#define RLNS_TASKGRAPH_HPP
+
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "Profiler.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : TaskGraph
+        Description : A small set of named tasks with dependencies, run as early as
+                      their dependencies allow.  Worker tasks each get a thread of
+                      their own; tasks that must stay on the calling thread (window
+                      creation, for one) run there, in the order they were added.
+                      A task may only depend on tasks added before it, so the graph
+                      can't have cycles.  Every task is timed by the profiler.
+                      Exceptions thrown by a task are rethrown by run().
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class TaskGraph
+    {
+        // Member Variables
+        private:
+            struct Task
+            {
+                std::string name;
+                std::function<void()> work;
+                std::vector<size_t> dependencies;
+                bool mainThread;
+            };
+
+            std::vector<Task> tasks;
+
+        // Member Functions
+        public:
+            size_t addTask(const std::string&, const std::function<void()>&,
+                           const std::vector<size_t>& = std::vector<size_t>());
+            size_t addMainThreadTask(const std::string&, const std::function<void()>&,
+                                     const std::vector<size_t>& = std::vector<size_t>());
+
+            void run(StartupProfiler&);
+    };
+}
+
+#endif
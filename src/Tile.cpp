@@ -32,6 +32,64 @@ namespace rlns
 
 
 
+    /*--------------------------------------------------------------------------------
+        Function    : Tile::reloadList
+        Description : Rereads the tiles file while the game is running.  Tiles that
+                      already exist are overwritten in place, so every TilePtr
+                      handed out earlier sees the new data, and new IDs are added.
+                      IDs missing from the file are kept, since live maps may still
+                      use them.  Colours and descriptions are read straight from
+                      the tiles when drawing, so only changes to the walking and
+                      light blocking flags need the maps to update.
+        Inputs      : file name, vector to fill
+        Outputs     : IDs whose blocking flags changed; throws if the file has no
+                      tiles
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Tile::reloadList(const string& filename, vector<int>& blockingChanged)
+    {
+        multimap<int, TilePtr> fresh;
+        fresh.swap(list);
+        try
+        {
+            TileParser(filename).run(); // starts from an empty list
+        }
+        catch(...)
+        {
+            list.swap(fresh);
+            throw;
+        }
+        fresh.swap(list);
+
+        // a file caught halfway through being written may parse to nothing
+        if(fresh.empty())
+        {
+            throw runtime_error("no tiles found");
+        }
+
+        multimap<int, TilePtr>::const_iterator it, end;
+        end = fresh.end();
+        for(it=fresh.begin(); it!=end; ++it)
+        {
+            multimap<int, TilePtr>::iterator old = list.find(it->first);
+            if(old == list.end())
+            {
+                list.insert(*it);
+                continue;
+            }
+
+            Tile& tile = *old->second;
+            if(tile.blocksWalking() != it->second->blocksWalking()
+            || tile.blocksLight() != it->second->blocksLight())
+            {
+                blockingChanged.push_back(it->first);
+            }
+            tile = *it->second;
+        }
+    }
+
+
+
     /*--------------------------------------------------------------------------------
         Function    : Tile::signal
         Description : Interprets an action send to the tile, which may turn it into
@@ -5,6 +5,7 @@
 #include <cstdio>
 #include <iostream>
 #include <map>
+#include <stdexcept>
 #include <string>
 #include <typeinfo>
 #include <vector>
@@ -33,7 +34,7 @@ namespace rlns
         // Member Variables
         private:
             int numChars;
-            std::string light;
+            InternedString light;
             std::array<int, NUM_TILE_ACTIONS> actions;
             std::array<bool, NUM_TILE_FLAGS> flags;
 
@@ -60,10 +61,12 @@ namespace rlns
             bool isDirectionallyLinked() const { return flags[DIRECTIONALLY_LINKED]; }
             bool hasMultipleChars()      const { return flags[MULTIPLE_CHARS]; }
             bool isNotable()             const { return flags[NOTABLE]; }
-            std::string getLight()       const { return light; }
+            const std::string& getLight() const { return light; }
+            int getAction(const TileActionType a) const { return actions[a]; }
 
             static bool tileExists(const int i);
             static TilePtr findTile(const int i);
+            static void reloadList(const std::string&, std::vector<int>&);
 
             int signal(const TileActionType);
     };
@@ -51,6 +51,66 @@ namespace rlns
 
 
 
+    /*--------------------------------------------------------------------------------
+        Function    : Tileset::reloadList
+        Description : Rereads the tileset file while the game is running.  Existing
+                      tilesets are overwritten in place, since live maps hold on to
+                      them, and new ones are added.  Tilesets missing from the file
+                      are kept.  A live map can't change size, so each tileset keeps
+                      its map dimensions until the game is restarted; the other
+                      generation settings apply to the next level made with it.
+        Inputs      : file name, vector to fill
+        Outputs     : tilesets whose ambient light changed; throws if the file has
+                      no tilesets
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Tileset::reloadList(const string& filename, vector<TilesetPtr>& lightChanged)
+    {
+        vector<TilesetPtr> fresh;
+        fresh.swap(list);
+        try
+        {
+            TilesetParser(filename).run(); // starts from an empty list
+        }
+        catch(...)
+        {
+            list.swap(fresh);
+            throw;
+        }
+        fresh.swap(list);
+
+        // a file caught halfway through being written may parse to nothing
+        if(fresh.empty())
+        {
+            throw runtime_error("no tilesets found");
+        }
+
+        for(size_t i=0; i<fresh.size(); ++i)
+        {
+            int index = findTilesetIndex(fresh[i]->name);
+            if(index < 0)
+            {
+                list.push_back(fresh[i]);
+                continue;
+            }
+
+            Tileset& tileset = *list[index];
+            if(fresh[i]->mapWidth != tileset.mapWidth || fresh[i]->mapHeight != tileset.mapHeight)
+            {
+                cerr << "Tileset '" << tileset.name << "' map size changes need a restart" << endl;
+                fresh[i]->mapWidth = tileset.mapWidth;
+                fresh[i]->mapHeight = tileset.mapHeight;
+            }
+            if(!(fresh[i]->ambientLight == tileset.ambientLight))
+            {
+                lightChanged.push_back(list[index]);
+            }
+            tileset = *fresh[i];
+        }
+    }
+
+
+
     /*--------------------------------------------------------------------------------
         Function    : Tileset::saveToDisk
         Description : Saves the tileset to the given RLNSZip save buffer.  Since
@@ -90,6 +150,10 @@ namespace rlns
         {
             temp.type = MapType::CAVE;
         }
+        else if(strName == "Overworld")
+        {
+            temp.type = MapType::OVERWORLD;
+        }
         temp.n = name;
         return true; 
     }
@@ -345,6 +409,24 @@ namespace rlns
         Cave.addProperty("minVSize", TCOD_TYPE_INT, true);
         Cave.addProperty("maxHRatio", TCOD_TYPE_FLOAT, true);
         Cave.addProperty("maxVRatio", TCOD_TYPE_FLOAT, true);
+
+        // define Overworld structure
+        TCODParserStruct Overworld = *(parser.newStructure("Overworld"));
+        Overworld.addProperty("floorTile", TCOD_TYPE_INT, true);
+        Overworld.addProperty("wallTile", TCOD_TYPE_INT, true);
+        Overworld.addProperty("fillerTile", TCOD_TYPE_INT, true);
+        Overworld.addProperty("upStair", TCOD_TYPE_INT, true);
+        Overworld.addProperty("downStair", TCOD_TYPE_INT, true);
+        Overworld.addProperty("n_s_Door", TCOD_TYPE_INT, true);
+        Overworld.addProperty("e_w_Door", TCOD_TYPE_INT, true);
+        Overworld.addProperty("ambientLight", TCOD_TYPE_COLOR, true);
+        Overworld.addProperty("mapWidth", TCOD_TYPE_INT, true);
+        Overworld.addProperty("mapHeight", TCOD_TYPE_INT, true);
+        Overworld.addProperty("recurseLevel", TCOD_TYPE_INT, true);
+        Overworld.addProperty("minHSize", TCOD_TYPE_INT, true);
+        Overworld.addProperty("minVSize", TCOD_TYPE_INT, true);
+        Overworld.addProperty("maxHRatio", TCOD_TYPE_FLOAT, true);
+        Overworld.addProperty("maxVRatio", TCOD_TYPE_FLOAT, true);
     }
 
 
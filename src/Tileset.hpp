@@ -6,6 +6,8 @@
 #pragma warning( disable : 4482 )
 #endif
 
+#include <iostream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -130,6 +132,7 @@ namespace rlns
             float getMaxVRatio()    const    { return maxVRatio;     }
 
             static TilesetPtr findTileset(const std::string&);
+            static void reloadList(const std::string&, std::vector<TilesetPtr>&);
 
             void saveToDisk(RLNSZip&) const;
     };
@@ -181,7 +184,7 @@ namespace rlns
         public:
             TilesetParser(const std::string& n): FileParser(n)
             {
-                Tile::list.clear();
+                Tileset::list.clear();
             }
 
             void run();
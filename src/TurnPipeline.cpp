@@ -0,0 +1,227 @@
+#include "TurnPipeline.hpp"
+#include "Level.hpp"
+#include "Tile.hpp"
+#include "Utility.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    const size_t TurnPipeline::PARALLEL_BATCH;
+    size_t TurnPipeline::maxThreads = 0;
+
+    /*--------------------------------------------------------------------------------
+        Function    : mix
+        Description : Scrambles a number so that nearby inputs give unrelated
+                      outputs (the splitmix64 finalizer).
+        Inputs      : number
+        Outputs     : None
+        Return      : uint64_t
+    --------------------------------------------------------------------------------*/
+    static uint64_t mix(uint64_t z)
+    {
+        z += 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : randomDirection
+        Description : Picks a direction for an entity with nowhere it wants to go.
+                      The choice depends only on the tick, the entity and where it
+                      stands.
+        Inputs      : tick, entity, its position
+        Outputs     : None
+        Return      : DirectionType
+    --------------------------------------------------------------------------------*/
+    static DirectionType randomDirection(const uint64_t tick, const Entity who, const Point& pt)
+    {
+        uint64_t entity = (static_cast<uint64_t>(who.index) << 32) | who.generation;
+        uint64_t place = (static_cast<uint64_t>(static_cast<uint32_t>(pt.X())) << 32) |
+                         static_cast<uint32_t>(pt.Y());
+        return static_cast<DirectionType>(mix(tick ^ mix(entity ^ mix(place))) % (NORTHWEST + 1));
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : canOpen
+        Description : Returns whether any tile at the given point would change if
+                      told to open.
+        Inputs      : level, point
+        Outputs     : None
+        Return      : bool
+    --------------------------------------------------------------------------------*/
+    static bool canOpen(const Level& level, const Point& pt)
+    {
+        const vector<int>& tiles = level.getTiles(pt.X(), pt.Y());
+        for(size_t i=0; i<tiles.size(); ++i)
+        {
+            if(Tile::findTile(tiles[i])->getAction(OPEN) > 0) return true;
+        }
+        return false;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : decideIntent
+        Description : Works out one entity's intent.  It steps where it wants to,
+                      or else in a random direction: a move if it can go there, an
+                      attempt to open what is there if it can't, and a wait if
+                      neither or if it has no position.
+        Inputs      : level, entity, tick
+        Outputs     : None
+        Return      : Intent
+    --------------------------------------------------------------------------------*/
+    static Intent decideIntent(const Level& level, const Entity who, const uint64_t tick)
+    {
+        const EntityStore& entities = level.getEntities();
+        Intent intent = { who, INTENT_WAIT, Point() };
+
+        const Point* position = entities.positions.find(who.index);
+        if(position == NULL) return intent;
+
+        const DirectionType* wanted = entities.steps.find(who.index);
+        Point target = *position;
+        target.shift(wanted ? *wanted : randomDirection(tick, who, *position));
+        if(target.X() < 0 || target.Y() < 0 ||
+           target.X() >= level.getMapWidth() || target.Y() >= level.getMapHeight())
+        {
+            return intent;
+        }
+
+        intent.target = target;
+        const MovementType* type = entities.movement.find(who.index);
+        if(level.moveLegal(target, type ? *type : WALKING)) intent.type = INTENT_MOVE;
+        else if(canOpen(level, target))                       intent.type = INTENT_OPEN;
+        return intent;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : TurnPipeline::findOccupied
+        Description : Finds the cells taken up as things stand: those of the
+                      entities with a speed and a position, and of the members of
+                      every party on the level, the player's included.
+        Inputs      : level
+        Outputs     : the occupied cells
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void TurnPipeline::findOccupied(const Level& level, Occupancy& occupied)
+    {
+        const EntityStore& entities = level.getEntities();
+        int height = level.getMapHeight();
+        occupied.clear();
+
+        for(size_t i=0; i<entities.speeds.size(); ++i)
+        {
+            const Point* position = entities.positions.find(entities.speeds.ownerAt(i));
+            if(position != NULL) occupied.insert(position->X() * height + position->Y());
+        }
+
+        vector<PartyPtr> parties = level.getParties();
+        for(size_t p=0; p<parties.size(); ++p)
+        {
+            vector<ActorPtr> members = parties[p]->getMembers();
+            for(size_t m=0; m<members.size(); ++m)
+            {
+                Point position = members[m]->getPosition();
+                occupied.insert(position.X() * height + position.Y());
+            }
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : TurnPipeline::decide
+        Description : The decision phase: works out the intent of every entity in
+                      the batch.  Large batches are spread across threads; the
+                      level must not change until it returns.
+        Inputs      : level, entities due, the tick they are due on
+        Outputs     : intents, in the order of the batch
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void TurnPipeline::decide(const Level& level, const vector<Entity>& batch, const uint64_t tick,
+                              vector<Intent>& intents)
+    {
+        intents.resize(batch.size());
+        auto decideOne = [&level, &batch, tick, &intents](const size_t i)
+        {
+            intents[i] = decideIntent(level, batch[i], tick);
+        };
+
+        if(batch.size() < PARALLEL_BATCH)
+        {
+            for(size_t i=0; i<batch.size(); ++i) decideOne(i);
+        }
+        else
+        {
+            parallelFor(batch.size(), decideOne, maxThreads);
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : TurnPipeline::commit
+        Description : The commit phase: carries out the intents in order.  A move
+                      goes ahead if the cell is still open to it and nothing is in
+                      it, and frees the cell it leaves; an open goes ahead if the
+                      tile still responds.  Each entity's wanted step is used up
+                      either way.
+        Inputs      : level, intents from decide(), cells occupied before them
+        Outputs     : the occupied cells, after the moves
+        Return      : size_t (number of intents carried out)
+    --------------------------------------------------------------------------------*/
+    size_t TurnPipeline::commit(Level& level, const vector<Intent>& intents, Occupancy& occupied)
+    {
+        EntityStore& entities = level.getEntities();
+        int height = level.getMapHeight();
+        size_t done = 0;
+
+        for(size_t i=0; i<intents.size(); ++i)
+        {
+            const Intent& intent = intents[i];
+            uint32_t slot = intent.who.index;
+            entities.steps.remove(slot);
+
+            switch(intent.type)
+            {
+                case INTENT_MOVE:
+                {
+                    const MovementType* type = entities.movement.find(slot);
+                    int cell = intent.target.X() * height + intent.target.Y();
+                    if(occupied.count(cell) > 0 || !level.moveLegal(intent.target, type ? *type : WALKING))
+                    {
+                        break;
+                    }
+
+                    Point& position = entities.positions.get(slot);
+                    Occupancy::iterator left = occupied.find(position.X() * height + position.Y());
+                    if(left != occupied.end()) occupied.erase(left);
+                    occupied.insert(cell);
+                    position = intent.target;
+                    ++done;
+                    break;
+                }
+
+                case INTENT_OPEN:
+                {
+                    if(level.signalTile(intent.target, OPEN)) ++done;
+                    break;
+                }
+
+                default:
+                    break;
+            }
+        }
+
+        return done;
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef RLNS_TURNPIPELINE_HPP
+#define RLNS_TURNPIPELINE_HPP
+
+#include <unordered_set>
+#include <vector>
+
+#include <stdint.h>
+
+#include "EntityStore.hpp"
+#include "Point.hpp"
+#include "Types.hpp"
+
+namespace rlns
+{
+    enum IntentType
+    {
+        INTENT_WAIT,
+        INTENT_MOVE,
+        INTENT_OPEN  // signal the tile at the target to open
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Struct      : Intent
+        Description : What an entity has decided to do with its turn, and where.
+    --------------------------------------------------------------------------------*/
+    struct Intent
+    {
+        Entity who;
+        IntentType type;
+        Point target;
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : TurnPipeline
+        Description : Takes the turns of the entities due on one tick in two
+                      phases.  In the decision phase every entity works out its
+                      intent from the level as it stood when the tick began; the
+                      level is only read, so the entities are spread across
+                      threads.  In the commit phase the intents are carried out
+                      one at a time in the order the entities were scheduled,
+                      each checked again against what the earlier ones did.  A
+                      cell holding an entity or a party member can't be moved
+                      into until its occupant leaves; of the entities moving
+                      into a free cell, the first gets it and the rest wait.
+                      The occupied cells are found once and kept up to date by
+                      the commits, so they must be found again if anything else
+                      moves.  Random
+                      choices come from the tick, the entity and its position,
+                      never from a shared generator, so the outcome is the same
+                      however many threads decide.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class TurnPipeline
+    {
+        // Member Variables
+        public:
+            // cells by x * map height + y, once for each occupant
+            typedef std::unordered_multiset<int> Occupancy;
+
+        private:
+            static const size_t PARALLEL_BATCH = 256; // fewer are decided on one thread
+            static size_t maxThreads;                 // 0 for every hardware thread
+
+        // Member Functions
+        public:
+            static void findOccupied(const Level&, Occupancy&);
+            static void decide(const Level&, const std::vector<Entity>&, const uint64_t,
+                               std::vector<Intent>&);
+            static size_t commit(Level&, const std::vector<Intent>&, Occupancy&);
+
+            static void setMaxThreads(const size_t n) { maxThreads = n; }
+    };
+}
+
+#endif
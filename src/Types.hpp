@@ -43,7 +43,8 @@ namespace rlns
         MOVE_NORTHWEST,
         MOVE_CENTER,
         NO_EVENT,
-        ITEM
+        ITEM,
+        SAVE
     };
 
 
@@ -85,7 +86,8 @@ namespace rlns
     enum MapType
     {
         DUNGEON,
-        CAVE
+        CAVE,
+        OVERWORLD
     };
 
     enum MovementType
@@ -115,43 +117,73 @@ namespace rlns
     class AbstractTile;
     class Actor;
     class Area;
-    class DieRoller;
+    class Arena;
+    class Autopilot;
+    class BSPTree;
+    class ChunkSource;
+    class EntityStore;
     class Feature;
     class GameData;
+    class GameSnapshot;
+    class InactiveLevels;
     class Level;
     class LevelNode;
+    class LevelSnapshot;
     class LevelTree;
     class Light;
     class Inventory;
     class Item;
+    class ItemType;
     class Map;
     class MapBuilder;
+    class MapChunk;
     class MapObject;
+    class MapSnapshot;
+    class OccupationTable;
     class Party;
+    class Pool;
     class Race;
+    class Recording;
+    class SavedLevels;
+    class SwapFile;
     class Tile;
     class Tileset;
+    class Vault;
 
     typedef boost::shared_ptr<AbstractTile> AbstractTilePtr;
     typedef boost::shared_ptr<Actor> ActorPtr;
     typedef boost::shared_ptr<Area> AreaPtr;
-    typedef boost::shared_ptr<DieRoller> DieRollerPtr;
+    typedef boost::shared_ptr<Arena> ArenaPtr;
+    typedef boost::shared_ptr<Autopilot> AutopilotPtr;
+    typedef boost::shared_ptr<BSPTree> BSPTreePtr;
+    typedef boost::shared_ptr<const ChunkSource> ChunkSourcePtr;
+    typedef boost::shared_ptr<EntityStore> EntityStorePtr;
     typedef boost::shared_ptr<Feature> FeaturePtr;
     typedef boost::shared_ptr<GameData> GameDataPtr;
+    typedef boost::shared_ptr<GameSnapshot> GameSnapshotPtr;
     typedef boost::shared_ptr<Level> LevelPtr;
     typedef boost::shared_ptr<LevelNode> LevelNodePtr;
+    typedef boost::shared_ptr<LevelSnapshot> LevelSnapshotPtr;
     typedef boost::shared_ptr<LevelTree> LevelTreePtr;
     typedef boost::shared_ptr<Light> LightPtr;
     typedef boost::shared_ptr<Inventory> InventoryPtr;
     typedef boost::shared_ptr<Item> ItemPtr;
+    typedef boost::shared_ptr<ItemType> ItemTypePtr;
     typedef boost::shared_ptr<Map> MapPtr;
     typedef boost::shared_ptr<MapBuilder> MapBuilderPtr;
+    typedef boost::shared_ptr<MapChunk> MapChunkPtr;
     typedef boost::shared_ptr<MapObject> MapObjectPtr;
-    typedef boost::shared_ptr<TCODBsp> TCODBspPtr;
+    typedef boost::shared_ptr<MapSnapshot> MapSnapshotPtr;
+    typedef boost::shared_ptr<OccupationTable> OccupationTablePtr;
     typedef boost::shared_ptr<Party> PartyPtr;
+    typedef boost::shared_ptr<Pool> PoolPtr;
     typedef boost::shared_ptr<Race> RacePtr;
+    typedef boost::shared_ptr<Recording> RecordingPtr;
+    typedef boost::shared_ptr<SavedLevels> SavedLevelsPtr;
+    typedef boost::shared_ptr<SwapFile> SwapFilePtr;
     typedef boost::shared_ptr<Tile> TilePtr;
     typedef boost::shared_ptr<Tileset> TilesetPtr;
+    typedef boost::shared_ptr<Vault> VaultPtr;
 
     // if this is the debug build, we want to save games using the CheckedZip class which
     // checks the consistency of the save files but inflates the size of the save.
@@ -1,10 +1,12 @@
 #ifndef RLNS_UTILITY_HPP
 #define RLNS_UTILITY_HPP
 
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <cmath>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "CheckedSave.hpp"
@@ -26,6 +28,48 @@ namespace rlns
 
 
 
+// threading template functions
+
+    /*--------------------------------------------------------------------------------
+        Function    : parallelFor
+        Description : Calls f(i) for every i in [0, n), spreading the calls across
+                      the available hardware threads, or at most the given number
+                      of threads.  The calling thread takes its share of the work
+                      too.  f must be safe to call concurrently for different
+                      values of i.
+        Inputs      : number of calls, function to call, optional thread limit (0 for
+                      none)
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    template<typename Function>
+    void parallelFor(const size_t n, Function f, const size_t maxThreads = 0)
+    {
+        size_t numThreads = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), n);
+        if(maxThreads > 0) numThreads = std::min(numThreads, maxThreads);
+        if(numThreads <= 1)
+        {
+            for(size_t i=0; i<n; ++i) f(i);
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        threads.reserve(numThreads-1);
+        for(size_t t=1; t<numThreads; ++t)
+        {
+            threads.push_back(std::thread([&f, t, n, numThreads]()
+            {
+                for(size_t i=t; i<n; i+=numThreads) f(i);
+            }));
+        }
+
+        for(size_t i=0; i<n; i+=numThreads) f(i);
+
+        for(size_t t=0; t<threads.size(); ++t) threads[t].join();
+    }
+
+
+
 
 // save buffer template functions
 
@@ -0,0 +1,440 @@
+#include "Vault.hpp"
+#include "Pool.hpp"
+
+using namespace std;
+
+namespace rlns
+{
+    vector<VaultPtr> Vault::list;
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Vault::reloadList
+        Description : Rereads the vaults file while the game is running.  Vaults are
+                      only used while generating, so the list is simply replaced;
+                      levels already built keep the vaults stamped into them.
+        Inputs      : file name
+        Outputs     : throws, keeping the old list, if the file has no vaults
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void Vault::reloadList(const string& filename)
+    {
+        vector<VaultPtr> live;
+        live.swap(list);
+        try
+        {
+            VaultParser(filename).run(); // starts from an empty list
+        }
+        catch(...)
+        {
+            list.swap(live);
+            throw;
+        }
+
+        // a file caught halfway through being written may parse to nothing
+        if(list.empty())
+        {
+            list.swap(live);
+            throw runtime_error("no vaults found");
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Vault::allowedIn
+        Description : Checks whether this vault may appear in the given tileset.
+        Inputs      : tileset name
+        Outputs     : None
+        Return      : bool
+    --------------------------------------------------------------------------------*/
+    bool Vault::allowedIn(const string& tileset) const
+    {
+        return find(tilesets.begin(), tilesets.end(), tileset) != tilesets.end();
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : Vault::stamp
+        Description : Writes the vault into the map with its topleft corner at the
+                      given point.  The caller has checked that it fits.
+        Inputs      : map, topleft corner
+        Outputs     : None
+        Return      : AreaPtr (the area covered by the vault)
+    --------------------------------------------------------------------------------*/
+    AreaPtr Vault::stamp(const MapPtr map, const Point& tl) const
+    {
+        int floorID = map->tileset->getFloorTileID();
+        int wallID = map->tileset->getWallTileID();
+
+        for(int y=0; y<getHeight(); ++y)
+        {
+            for(int x=0; x<getWidth(); ++x)
+            {
+                Point pt(tl.X()+x, tl.Y()+y);
+                char c = layout[y][x];
+                if(c == ' ') continue;
+
+                if(c == '#')
+                {
+                    map->setBottomMostAt(pt, wallID);
+                }
+                else
+                {
+                    map->setBottomMostAt(pt, floorID);
+                    std::map<char, int>::const_iterator feature = legend.find(c);
+                    if(feature != legend.end())
+                    {
+                        map->addFeature(pt, feature->second);
+                    }
+                }
+            }
+        }
+
+        return allocatePooled<Area>(Arena::global(), "Area", tl,
+                                    Point(tl.X()+getWidth()-1, tl.Y()+getHeight()-1));
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : fillerTable
+        Description : Builds a summed-area table of the filler tiles of a map, so
+                      that whether a rectangle is still untouched rock can be
+                      answered in constant time.
+        Inputs      : map
+        Outputs     : None
+        Return      : SummedAreaTable
+    --------------------------------------------------------------------------------*/
+    SummedAreaTable fillerTable(const Map& map)
+    {
+        int fillerID = map.tileset->getFillerTileID();
+        return SummedAreaTable(map.getWidth(), map.getHeight(), [&map, fillerID](const int x, const int y)
+        {
+            return map.bottomMostAt(x,y) == fillerID;
+        });
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : walkableTable
+        Description : Builds a summed-area table of the walkable tiles of a map.
+        Inputs      : map
+        Outputs     : None
+        Return      : SummedAreaTable
+    --------------------------------------------------------------------------------*/
+    static SummedAreaTable walkableTable(const Map& map)
+    {
+        return SummedAreaTable(map.getWidth(), map.getHeight(), [&map](const int x, const int y)
+        {
+            return map.isWalkable(x,y);
+        });
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : findFits
+        Description : Counts the positions inside the BSP leaves where a w by h
+                      rectangle is entirely made of counted cells.  If wholeLeaf is
+                      set, only leaves that are entirely counted cells are searched.
+        Inputs      : summed-area table, BSP leaves, rectangle width and height,
+                      whether to only search whole leaves, index of the fit to
+                      return (or -1), point to receive its topleft corner
+        Outputs     : topleft corner of the chosen fit
+        Return      : int (number of fits, or of fits up to the chosen one)
+    --------------------------------------------------------------------------------*/
+    static int findFits(const SummedAreaTable& table, const vector<const BSPNode*>& leaves,
+                        const int w, const int h, const bool wholeLeaf, const int chosen, Point* topLeft)
+    {
+        int fits = 0;
+        for(size_t i=0; i<leaves.size(); ++i)
+        {
+            const BSPNode& leaf = *leaves[i];
+            if(wholeLeaf && !table.all(leaf.x, leaf.y, leaf.w, leaf.h)) continue;
+
+            for(int x=leaf.x; x<=leaf.x+leaf.w-w; ++x)
+            {
+                for(int y=leaf.y; y<=leaf.y+leaf.h-h; ++y)
+                {
+                    if(!table.all(x, y, w, h)) continue;
+                    if(fits == chosen)
+                    {
+                        *topLeft = Point(x,y);
+                        return fits;
+                    }
+                    ++fits;
+                }
+            }
+        }
+        return fits;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : placeVaults
+        Description : Stamps up to the given number of vaults for the map's tileset
+                      into the BSP leaves.  Vaults are tried in random order.  For
+                      each one, every position where it fits inside a leaf is
+                      counted and one is picked at random.  A solid vault needs an
+                      untouched leaf with a one tile margin of rock around it; an
+                      open vault needs its whole rectangle to be walkable.  Both
+                      tests are a single summed-area table lookup, and the table is
+                      only rebuilt after a vault is stamped, so trying many vaults
+                      costs little more than trying one.
+        Inputs      : map, random number generator, BSP leaves, whether to place
+                      open or solid vaults, maximum number of vaults to place
+        Outputs     : the Areas of the placed vaults are appended
+        Return      : size_t (number of vaults placed)
+    --------------------------------------------------------------------------------*/
+    size_t placeVaults(const MapPtr map, Random& rand, const vector<const BSPNode*>& leaves,
+                       const bool open, const size_t maxVaults, vector<AreaPtr>& vaults)
+    {
+        if(maxVaults == 0) return 0;
+
+        vector<VaultPtr> candidates;
+        string tileset = map->tileset->getName();
+        for(size_t i=0; i<Vault::list.size(); ++i)
+        {
+            if(Vault::list[i]->isOpen() == open && Vault::list[i]->allowedIn(tileset))
+                candidates.push_back(Vault::list[i]);
+        }
+        if(candidates.empty()) return 0;
+
+        for(size_t i=candidates.size()-1; i>0; --i)
+        {
+            swap(candidates[i], candidates[rand.getInt(0, i)]);
+        }
+
+        SummedAreaTable table = open ? walkableTable(*map) : fillerTable(*map);
+
+        size_t placed = 0;
+        int margin = open ? 0 : 1;
+        for(size_t v=0; v<candidates.size() && placed<maxVaults; ++v)
+        {
+            int w = candidates[v]->getWidth() + 2*margin;
+            int h = candidates[v]->getHeight() + 2*margin;
+
+            int fits = findFits(table, leaves, w, h, !open, -1, NULL);
+            if(fits == 0) continue;
+
+            Point topLeft;
+            findFits(table, leaves, w, h, !open, rand.getInt(0, fits-1), &topLeft);
+            topLeft = Point(topLeft.X()+margin, topLeft.Y()+margin);
+
+            vaults.push_back(candidates[v]->stamp(map, topLeft));
+            ++placed;
+
+            table = open ? walkableTable(*map) : fillerTable(*map);
+        }
+
+        return placed;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : VaultParser::VaultListener::parserNewStruct
+        Description : Called when the parser finds a new vault, this clears the data
+                      left over from the previous one.
+        Inputs      : parser, parser struct, name of the struct
+        Outputs     : None
+        Return      : bool
+    --------------------------------------------------------------------------------*/
+    bool VaultParser::VaultListener::parserNewStruct(TCODParser* parser, const TCODParserStruct* str, const char* n)
+    {
+        // unused parameters
+        (void) parser;
+        (void) str;
+
+        name = n;
+        layout.clear();
+        tilesets.clear();
+        legend.clear();
+        open = false;
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : VaultParser::VaultListener::parserFlag
+        Description : Called when the parser finds a flag.  The only flag is "open".
+        Inputs      : parser, flag name
+        Outputs     : None
+        Return      : bool
+    --------------------------------------------------------------------------------*/
+    bool VaultParser::VaultListener::parserFlag(TCODParser* parser, const char* n)
+    {
+        if(strcmp(n, "open") == 0)
+        {
+            open = true;
+        }
+        else
+        {
+            parser->error("Unknown flag '%s' in vault '%s'", n, name.c_str());
+            return false;
+        }
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : VaultParser::VaultListener::parserProperty
+        Description : Called when the parser finds a property, this updates the
+                      relevant tracking variable in VaultListener.  Legend entries
+                      take the form "c=id", mapping the character c to a tile ID.
+        Inputs      : parser, property name, value type, value data
+        Outputs     : None
+        Return      : bool
+    --------------------------------------------------------------------------------*/
+    bool VaultParser::VaultListener::parserProperty
+    (TCODParser* parser, const char* n, TCOD_value_type_t valtype, TCOD_value_t value)
+    {
+        // unused parameters
+        (void) valtype;
+
+        TCODList<char*> strings;
+        strings = value.list;
+
+        if(strcmp(n, "layout") == 0)
+        {
+            for(char** it = strings.begin(); it != strings.end(); ++it)
+            {
+                layout.push_back(*it);
+            }
+        }
+        else if(strcmp(n, "tilesets") == 0)
+        {
+            for(char** it = strings.begin(); it != strings.end(); ++it)
+            {
+                tilesets.push_back(*it);
+            }
+        }
+        else if(strcmp(n, "legend") == 0)
+        {
+            for(char** it = strings.begin(); it != strings.end(); ++it)
+            {
+                string entry(*it);
+                if(entry.size() < 3 || entry[1] != '=' || entry[0] == '.' || entry[0] == '#' || entry[0] == ' ')
+                {
+                    parser->error("bad legend entry '%s' in vault '%s'", *it, name.c_str());
+                    return false;
+                }
+
+                int id = atoi(entry.c_str()+2);
+                if(!Tile::tileExists(id))
+                {
+                    parser->error("tile ID '%d' not found in Tile list", id);
+                }
+                legend[entry[0]] = id;
+            }
+        }
+        else
+        {
+            parser->error("Unknown property '%s' in vault '%s'", n, name.c_str());
+            return false;
+        }
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : VaultParser::VaultListener::parserEndStruct
+        Description : Called when the parser comes to the end of a vault, this checks
+                      the layout and adds a new Vault to the Vault list.
+        Inputs      : parser, vault struct, name of the struct
+        Outputs     : None
+        Return      : bool
+    --------------------------------------------------------------------------------*/
+    bool VaultParser::VaultListener::parserEndStruct
+    (TCODParser* parser, const TCODParserStruct* str, const char* n)
+    {
+        // unused parameters
+        (void) str;
+        (void) n;
+
+        if(layout.empty() || layout[0].empty())
+        {
+            parser->error("vault '%s' has an empty layout", name.c_str());
+            return false;
+        }
+
+        for(size_t y=0; y<layout.size(); ++y)
+        {
+            if(layout[y].size() != layout[0].size())
+            {
+                parser->error("rows of vault '%s' differ in length", name.c_str());
+                return false;
+            }
+
+            for(size_t x=0; x<layout[y].size(); ++x)
+            {
+                char c = layout[y][x];
+                if(c != '.' && c != '#' && c != ' ' && legend.find(c) == legend.end())
+                {
+                    parser->error("character '%c' of vault '%s' is not in its legend", c, name.c_str());
+                    return false;
+                }
+            }
+        }
+
+        Vault::list.push_back(VaultPtr(new Vault(name, layout, tilesets, legend, open)));
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : VaultParser::VaultListener::error
+        Description : Called when the parser detects an error.  Prints the given error
+                      message.  If this function is called, it will terminate the
+                      program.
+        Inputs      : error message
+        Outputs     : error message
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void VaultParser::VaultListener::error(const char* error)
+    {
+        cout << "VAULT PARSING ERROR: " << error << endl;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : VaultParser::defineSyntax
+        Description : defines the syntax for the vault config file.
+        Inputs      : None
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void VaultParser::defineSyntax()
+    {
+        TCODParserStruct VaultStruct = *(parser.newStructure("Vault"));
+        VaultStruct.addListProperty("layout", TCOD_TYPE_STRING, true);
+        VaultStruct.addListProperty("tilesets", TCOD_TYPE_STRING, true);
+        VaultStruct.addListProperty("legend", TCOD_TYPE_STRING, false);
+        VaultStruct.addFlag("open");
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : VaultParser::run
+        Description : Entry point into the Vault Parser.
+        Inputs      : None
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void VaultParser::run()
+    {
+        defineSyntax();
+        parser.run(filename.c_str(), &listener);
+    }
+}
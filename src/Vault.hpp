@@ -0,0 +1,179 @@
+#ifndef RLNS_VAULT_HPP
+#define RLNS_VAULT_HPP
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Area.hpp"
+#include "BSPTree.hpp"
+#include "FileParser.hpp"
+#include "Map.hpp"
+#include "PhasedBuilder.hpp"
+#include "Point.hpp"
+#include "Random.hpp"
+#include "SummedAreaTable.hpp"
+#include "Tile.hpp"
+#include "Types.hpp"
+
+#include "libtcod.hpp"
+
+namespace rlns
+{
+    /*--------------------------------------------------------------------------------
+        Class       : Vault
+        Description : A hand-made room read from vaults.txt and stamped into maps of
+                      the tilesets it lists.  The layout is a grid of characters:
+                      '.' is the tileset's floor, '#' its wall, a space leaves the
+                      map as it is, and any other character is a floor tile with the
+                      feature given for it in the vault's legend on top.
+
+                      A solid vault is cut into the untouched rock of a BSP leaf
+                      before the rooms are dug, and is walled in by the finisher like
+                      any room.  An open vault is laid over open ground once the
+                      carver is done.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class Vault
+    {
+        // Member Variables
+        public:
+            static std::vector<VaultPtr> list;
+
+        private:
+            std::string name;
+            std::vector<std::string> layout; // one string per row
+            std::vector<std::string> tilesets;
+            std::map<char, int> legend;
+            bool open;
+
+        // Member Functions
+        public:
+            Vault(const std::string& n, const std::vector<std::string>& l,
+                  const std::vector<std::string>& t, const std::map<char, int>& lg,
+                  const bool o)
+            : name(n), layout(l), tilesets(t), legend(lg), open(o) {}
+
+            std::string getName() const { return name; }
+            int getWidth() const        { return layout.empty() ? 0 : layout[0].size(); }
+            int getHeight() const       { return layout.size(); }
+            bool isOpen() const         { return open; }
+
+            const std::vector<std::string>& getLayout() const   { return layout;   }
+            const std::vector<std::string>& getTilesets() const { return tilesets; }
+            const std::map<char, int>& getLegend() const        { return legend;   }
+
+            bool allowedIn(const std::string&) const;
+            AreaPtr stamp(const MapPtr, const Point&) const;
+
+            static void reloadList(const std::string&);
+    };
+
+    // Non-member Functions
+
+    size_t placeVaults(const MapPtr, Random&, const std::vector<const BSPNode*>&,
+                       const bool, const size_t, std::vector<AreaPtr>&);
+    SummedAreaTable fillerTable(const Map&);
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : VaultParser
+        Description : Reads in data from the datafile vaults.txt and stores it in
+                      Vault's list variable.
+        Parents     : FileParser
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    class VaultParser: public FileParser
+    {
+        // Member Variables
+        private:
+            /*--------------------------------------------------------------------------------
+                Class       : VaultListener
+                Description : Constructs and executes a parser to read the datafile
+                              vaults.txt.
+                Parents     : ITCODParserListener (see libtcod file parser documentation)
+                Children    : None
+                Friends     : None
+            --------------------------------------------------------------------------------*/
+            class VaultListener: public ITCODParserListener
+            {
+                // Member Variables
+                private:
+                    std::string name;
+                    std::vector<std::string> layout;
+                    std::vector<std::string> tilesets;
+                    std::map<char, int> legend;
+                    bool open;
+
+                // Member Functions
+                public:
+                    bool parserNewStruct(TCODParser*, const TCODParserStruct*, const char*);
+                    bool parserFlag(TCODParser*, const char*);
+                    bool parserProperty(TCODParser*, const char*, TCOD_value_type_t, TCOD_value_t);
+                    bool parserEndStruct(TCODParser*, const TCODParserStruct*, const char*);
+                    void error(const char*);
+            } listener;
+
+        // Member Functions
+        protected:
+            void defineSyntax();
+
+        public:
+            VaultParser(const std::string& n): FileParser(n)
+            {
+                Vault::list.clear();
+            }
+
+            void run();
+    };
+
+
+
+    /*--------------------------------------------------------------------------------
+        Class       : VaultCarver
+        Description : Carving policy that adds up to MaxVaults prefab vaults to the
+                      map around another carving policy.  Solid vaults go in first,
+                      so the carver can leave their leaves alone; open vaults go in
+                      after it, over the open ground it made.  Each vault becomes an
+                      Area.
+        Parents     : None
+        Children    : None
+        Friends     : None
+    --------------------------------------------------------------------------------*/
+    template<class Carver, int MaxVaults>
+    struct VaultCarver
+    {
+        template<class Builder>
+        static void run(Builder& b)
+        {
+            std::vector<const BSPNode*> leaves;
+            b.bsp->getLeaves(leaves);
+
+            std::vector<AreaPtr> vaults;
+            size_t wanted = b.rand.getInt(0, MaxVaults);
+            size_t placed = placeVaults(b.map, b.rand, leaves, false, wanted, vaults);
+
+            Carver::run(b);
+
+            placeVaults(b.map, b.rand, leaves, true, wanted - placed, vaults);
+
+            for(size_t i=0; i<vaults.size(); ++i)
+            {
+                b.addArea(vaults[i]);
+            }
+        }
+    };
+
+    template<class Carver, int MaxVaults>
+    struct WrappedPolicy< VaultCarver<Carver, MaxVaults> >
+    {
+        typedef Carver type;
+    };
+}
+
+#endif
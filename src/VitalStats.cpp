@@ -39,28 +39,73 @@ namespace rlns
 
 
 
+    /*--------------------------------------------------------------------------------
+        Function    : VitalStats::generateFunnel
+        Description : Generates a whole funnel of characters at once.  The
+                      occupations are drawn together from the shared table, and
+                      every character's dice are rolled in two batches.
+        Inputs      : vector to fill, number of characters
+        Outputs     : the new characters are appended
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void VitalStats::generateFunnel(vector<VitalStats>& funnel, const size_t count)
+    {
+        vector<const Occupation*> occupations;
+        OccupationTable::get()->chooseMany(occupations, count);
+
+        // 3d6 for each of six ability scores, and 1d4 hit points
+        vector<int> scores(count * 18);
+        vector<int> hitPoints(count);
+        if(count > 0)
+        {
+            rollDice(&scores[0], scores.size(), D6);
+            rollDice(&hitPoints[0], hitPoints.size(), D4);
+        }
+
+        funnel.reserve(funnel.size() + count);
+        for(size_t i=0; i<count; ++i)
+        {
+            const int* d6 = &scores[i * 18];
+            VitalStats stats;
+            stats.STR.setMaxAndCurrent(d6[0] + d6[1] + d6[2]);
+            stats.AGI.setMaxAndCurrent(d6[3] + d6[4] + d6[5]);
+            stats.STA.setMaxAndCurrent(d6[6] + d6[7] + d6[8]);
+            stats.PER.setMaxAndCurrent(d6[9] + d6[10] + d6[11]);
+            stats.INT.setMaxAndCurrent(d6[12] + d6[13] + d6[14]);
+            stats.LUCK.setMaxAndCurrent(d6[15] + d6[16] + d6[17]);
+            stats.setOccupation(*occupations[i]);
+            stats.hp.setMaxAndCurrent(hitPoints[i] + stats.getSTA().mod());
+            funnel.push_back(stats);
+        }
+    }
+
+
+
     /*--------------------------------------------------------------------------------
         Function    : VitalStats::chooseOccupation
-        Description : Randomly chooses an occupation from occupations.txt
+        Description : Randomly chooses an occupation from occupations.txt, weighted
+                      by how often it is listed there
         Inputs      : None
         Outputs     : None
         Return      : void
     --------------------------------------------------------------------------------*/
     void VitalStats::chooseOccupation()
     {
-        ifstream occupationsFile;
-        occupationsFile.open("./datafiles/occupations.txt");
+        setOccupation(OccupationTable::get()->choose());
+    }
+
 
-        vector<string> lines;
-        string line;
-        while(occupationsFile.good())
-        {
-            getline(occupationsFile, line);
-            lines.push_back(line);
-        }
-        occupationsFile.close();
 
-        int i = randomInt(0, lines.size());
-        occupation = lines.at(i); 
+    /*--------------------------------------------------------------------------------
+        Function    : VitalStats::setOccupation
+        Description : Takes the name and trained weapon of an occupation
+        Inputs      : occupation
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void VitalStats::setOccupation(const Occupation& chosen)
+    {
+        occupation = chosen.name;
+        weapon = chosen.weapon;
     }
 }
@@ -1,11 +1,11 @@
 #ifndef RLNS_VITALSTATS_HPP
 #define RLNS_VITALSTATS_HPP
 
-#include <fstream>
 #include <vector>
 
 #include "AbilityScore.hpp"
 #include "Dice.hpp"
+#include "Occupation.hpp"
 #include "Types.hpp"
 
 namespace rlns
@@ -14,7 +14,7 @@ namespace rlns
     {
         public:
             VitalStats()
-            : name(""), title(""), occupation(""),
+            : name(""), title(""), occupation(""), weapon(""),
               alignment(AlignmentType::LAWFUL),
               characterClass(CharacterClassType::WARRIOR),
               level(0), xp(0),
@@ -30,16 +30,20 @@ namespace rlns
             Score getHP() const { return hp; }
 
             std::string getOccupation() const { return occupation; }
+            std::string getWeapon() const { return weapon; }
 
             void generate();
+            static void generateFunnel(std::vector<VitalStats>&, const size_t);
 
         private:
             void rollAbilityScores();
             void chooseOccupation();
+            void setOccupation(const Occupation&);
 
             std::string name;
             std::string title;
             std::string occupation;
+            std::string weapon;
             AlignmentType alignment;
             CharacterClassType characterClass;
             int level;
@@ -6,8 +6,16 @@ namespace rlns
 {
     /*--------------------------------------------------------------------------------
         Function    : LCRL::initialize
-        Description : Run on game start, this starts InitData reading init.txt and
-                      loads any saved games.
+        Description : Run on game start, this reads init.txt, opens the window, loads
+                      the datafiles and resumes the saved game or creates the first
+                      level.  These run as a small task graph: the datafiles are
+                      loaded on a worker thread while the main thread reads init.txt
+                      and opens the window, and the first level is loaded or
+                      generated as soon as the datafiles are in.
+                      libtcod's text parser keeps global state, so the datafiles
+                      themselves are parsed one after the other.
+                      A game being recorded or played back always starts anew,
+                      from the recording's seed.
         Inputs      : None
         Outputs     : None
         Return      : bool (whether initialization is successful)
@@ -15,42 +23,151 @@ namespace rlns
     bool LCRL::initialize()
     {
     #ifdef _WIN32
-        initData.readInitFile(".\\init.txt");
+        string initFile(".\\init.txt");
+        string tilesFile(".\\datafiles\\tiles.txt");
+        string tilesetFile(".\\datafiles\\tileset.txt");
+        string vaultsFile(".\\datafiles\\vaults.txt");
+        DataCache cache(".\\datafiles\\datafiles.cache");
+        saveFile = ".\\save\\game.sav";
     #else
-        initData.readInitFile("./init.txt");
+        string initFile("./init.txt");
+        string tilesFile("./datafiles/tiles.txt");
+        string tilesetFile("./datafiles/tileset.txt");
+        string vaultsFile("./datafiles/vaults.txt");
+        DataCache cache("./datafiles/datafiles.cache");
+        saveFile = "./save/game.sav";
     #endif
-        initData.initRoot();
-        display.reset(new Display(initData));
+        cache.addSource(tilesFile);
+        cache.addSource(tilesetFile);
+        cache.addSource(vaultsFile);
 
-        // run file parsers
-    #ifdef _WIN32
-        TileParser tileParser(".\\datafiles\\tiles.txt");
-        TilesetParser tilesetParser(".\\datafiles\\tileset.txt");
-    #else
-        TileParser tileParser("./datafiles/tiles.txt");
-        TilesetParser tilesetParser("./datafiles/tileset.txt");
-    #endif
-        tileParser.run();
-        tilesetParser.run();
+        uint32_t seed = replaying ? recording->getSeed()
+                                  : static_cast<uint32_t>(TCODRandom::getInstance()->getInt(0, 0x7FFFFFFF));
+        if(!replaying && !recordFile.empty()) recording.reset(new Recording(seed));
+        Level::setGameSeed(seed);
+        Random::seedStreams(seed);
+
+        TaskGraph startup;
 
-        // create the first level
-        Level::addLevel("Castle");
+        size_t readInit = startup.addMainThreadTask("read init.txt", [&]()
+        {
+            initData.readInitFile(initFile.c_str());
+        });
+
+        startup.addMainThreadTask("open window", [this]()
+        {
+            initData.initRoot();
+            display.reset(new Display(initData));
+        }, vector<size_t>(1, readInit));
+
+        // load the datafiles, from the binary cache if they haven't changed
+        size_t loadData = startup.addTask("load datafiles", [&]()
+        {
+            if(cache.load()) return;
+
+            // the tileset and vault parsers check tile IDs against the Tile list
+            profiler.time("parse tiles.txt", [&]() { TileParser(tilesFile).run(); });
+            profiler.time("parse tileset.txt", [&]() { TilesetParser(tilesetFile).run(); });
+            profiler.time("parse vaults.txt", [&]() { VaultParser(vaultsFile).run(); });
+
+            if(!cache.save())
+                cerr << "Couldn't write the datafile cache" << endl;
+        });
+
+        // resume the saved game if there is one; only its current level is read
+        bool resumed = false;
+        startup.addTask("resume or generate first level", [&]()
+        {
+            if(recording)
+            {
+                Level::addLevel("Castle");
+                return;
+            }
 
-        // add the player to the party
-        Point pos = Level::getCurrentLevel()->getUpStairLocation();
-        ActorPtr player(new Actor(pos, '@', TCODColor::white));
-        Party::getPlayerParty()->addMember(player);
-        Level::getCurrentLevel()->addParty(Party::getPlayerParty());
+            try
+            {
+                Level::loadLevelsFromFile(saveFile);
+                resumed = true;
+                return;
+            }
+            catch(const runtime_error& e)
+            {
+                if(MappedFile(saveFile).isOpen())
+                    cerr << "Couldn't resume " << saveFile << ": " << e.what() << endl;
+            }
+            Level::addLevel("Castle");
+        }, vector<size_t>(1, loadData));
 
-        display->setFocalPoint(player->getPosition());
+        startup.run(profiler);
+        watchDatafiles(tilesFile, tilesetFile, vaultsFile);
+        Level::setMemoryBudget(static_cast<size_t>(initData.getLevelMemory()) * 1024);
+
+        if(resumed)
+        {
+            try
+            {
+                loadMessages(saveFile, *display->messageTracker);
+            }
+            catch(const runtime_error&) {} // the levels loaded, so play on without the log
+        }
+        else
+        {
+            // add the player to the party
+            Point pos = Level::getCurrentLevel()->getUpStairLocation();
+            ActorPtr player = allocatePooled<Actor>(Arena::global(), "Actor", pos, '@', TCODColor::white);
+            Party::getPlayerParty()->addMember(player);
+            Level::getCurrentLevel()->addParty(Party::getPlayerParty());
+        }
+
+        display->setFocalPoint(Party::getPlayerParty()->getLeader()->getPosition());
         return true;
     }
 
 
 
+    /*--------------------------------------------------------------------------------
+        Function    : LCRL::watchDatafiles
+        Description : Reloads the datafiles whenever they are saved, without
+                      restarting.  The tiles and tilesets are patched in place and
+                      the live levels are told which tiles changed, so they only
+                      recompute the cells that use them; the levels and their maps
+                      are kept.
+        Inputs      : tiles file, tileset file, vaults file
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void LCRL::watchDatafiles(const string& tilesFile, const string& tilesetFile,
+                              const string& vaultsFile)
+    {
+        // added in this order so that a change to several files at once reloads
+        // the tiles before the tilesets and vaults that refer to them
+        watcher.addFile(tilesFile, [tilesFile]()
+        {
+            vector<int> changed;
+            Tile::reloadList(tilesFile, changed);
+            Level::refreshTiles(changed);
+        });
+
+        watcher.addFile(tilesetFile, [tilesetFile]()
+        {
+            vector<TilesetPtr> changed;
+            Tileset::reloadList(tilesetFile, changed);
+            Level::refreshLighting(changed);
+        });
+
+        watcher.addFile(vaultsFile, [vaultsFile]()
+        {
+            Vault::reloadList(vaultsFile);
+        });
+    }
+
+
+
     /*--------------------------------------------------------------------------------
         Function    : LCRL::gameLoop
-        Description : Starts the main game loop.
+        Description : Starts the main game loop.  A recording is played back as
+                      fast as it will go, timing each event, and the loop ends
+                      with it.
         Inputs      : None
         Outputs     : None
         Return      : void
@@ -58,13 +175,100 @@ namespace rlns
     void LCRL::gameLoop()
     {
         EventHandler eventHandler;
+        EventSource screenInput = [&]() { return nextScreenEvent(eventHandler); };
+        if(replaying) TCODSystem::setFps(0);
 
         while(IS_RUNNING && !TCODConsole::isWindowClosed())
         {
-            render(display);
-            EventType event = eventHandler.getPlayerInput();
-            mainEventContext(event, display);
+            watcher.poll();
+            saver.poll(*display->messageTracker);
+            if(rendering) render(display);
+            if(!profiler.hasFirstFrame())
+            {
+                profiler.markFirstFrame();
+                profiler.report(cerr);
+            }
+
+            EventType event;
+            string command;
+            if(!nextEvent(eventHandler, event, command)) break;
+
+            if(replaying) turnProfiler.beginTurn();
+            if(event == SAVE) saveGame();
+            else if(mainEventContext(event, display, command, screenInput, rendering))
+            {
+                Level::getCurrentLevel()->runUntilPlayer(Scheduler::NORMAL_COST);
+                Level::simulateInactive();
+            }
+            if(replaying) turnProfiler.endTurn();
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : LCRL::nextEvent
+        Description : Gets the player's next event, with the command typed if it
+                      is a COMMAND.  When replaying, it comes from the recording;
+                      otherwise it is read from the keyboard, and added to the
+                      recording if there is one.  Saving isn't recorded, nor are
+                      the times no key was pressed.
+        Inputs      : event handler
+        Outputs     : event, command (empty unless a COMMAND)
+        Return      : bool (false once a recording has been played to the end)
+    --------------------------------------------------------------------------------*/
+    bool LCRL::nextEvent(const EventHandler& eventHandler, EventType& event, string& command)
+    {
+        if(replaying) return recording->next(event, command);
+
+        event = eventHandler.getPlayerInput();
+        command.clear();
+        if(event == COMMAND) command = getTextInput(display);
+        if(recording && event != NO_EVENT && event != SAVE) recording->add(event, command);
+        return true;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : LCRL::nextScreenEvent
+        Description : Gets the player's next event inside a screen opened from the
+                      game, such as the inventory.  Like nextEvent, it comes from
+                      the recording when replaying, and is otherwise read from
+                      the keyboard and recorded, so the screen plays back as it
+                      was used.  A recording that ends inside a screen closes it.
+        Inputs      : event handler
+        Outputs     : None
+        Return      : EventType
+    --------------------------------------------------------------------------------*/
+    EventType LCRL::nextScreenEvent(const EventHandler& eventHandler)
+    {
+        if(replaying)
+        {
+            EventType event;
+            string command;
+            return recording->next(event, command) ? event : CANCEL;
         }
+
+        EventType event = eventHandler.getPlayerInput();
+        if(recording && event != NO_EVENT) recording->add(event);
+        return event;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : LCRL::saveGame
+        Description : Starts saving the game in the background.  Only the snapshot
+                      is taken here, so the game keeps responding while the save is
+                      written; gameLoop reports when it is done.
+        Inputs      : None
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void LCRL::saveGame()
+    {
+        saver.start(saveFile, *display->messageTracker);
     }
 
 
@@ -87,14 +291,58 @@ namespace rlns
     /*--------------------------------------------------------------------------------
         Function    : LCRL::cleanup
         Description : Called once the player decides to exit the game.  Saves the
-                      player's game and releases all game resources.
+                      player's game and releases all game resources.  A recording
+                      is written out; a replay reports its timings.
         Inputs      : None
         Outputs     : None
         Return      : void
     --------------------------------------------------------------------------------*/
     void LCRL::cleanup()
     {
-        //cout << "cleanup" << endl;
+        // let a save in progress finish before the game state goes away
+        saver.wait(*display->messageTracker);
+
+        if(replaying)
+        {
+            turnProfiler.report(cerr);
+            StartupProfiler::reportPools(cerr);
+        }
+        else if(recording && !recording->saveToFile(recordFile))
+        {
+            cerr << "Couldn't write the recording to " << recordFile << endl;
+        }
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : LCRL::recordTo
+        Description : Has the game record the player's events, to be written to the
+                      given file on exit.
+        Inputs      : file name
+        Outputs     : None
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void LCRL::recordTo(const string& file)
+    {
+        recordFile = file;
+    }
+
+
+
+    /*--------------------------------------------------------------------------------
+        Function    : LCRL::replayFrom
+        Description : Has the game play back a recording instead of reading the
+                      keyboard, drawing as it goes or not.
+        Inputs      : file name, whether to render
+        Outputs     : throws runtime_error if the recording can't be read
+        Return      : void
+    --------------------------------------------------------------------------------*/
+    void LCRL::replayFrom(const string& file, const bool render)
+    {
+        recording.reset(new Recording(file));
+        replaying = true;
+        rendering = render;
     }
 
 
@@ -118,8 +366,37 @@ namespace rlns
 
 
 
-int main()
+int main(int argc, char* argv[])
 {
+    std::string recordFile, replayFile;
+    bool render = true;
+    for(int i=1; i<argc; ++i)
+    {
+        std::string arg(argv[i]);
+        if(arg == "--record" && i+1 < argc)      recordFile = argv[++i];
+        else if(arg == "--replay" && i+1 < argc) replayFile = argv[++i];
+        else if(arg == "--no-render")            render = false;
+        else recordFile = replayFile = "?";
+    }
+    if(recordFile == "?" || (!recordFile.empty() && !replayFile.empty()))
+    {
+        std::cerr << "usage: lcrl [--record file | --replay file [--no-render]]" << std::endl;
+        return 1;
+    }
+
     rlns::LCRL game;
+    if(!recordFile.empty()) game.recordTo(recordFile);
+    if(!replayFile.empty())
+    {
+        try
+        {
+            game.replayFrom(replayFile, render);
+        }
+        catch(const std::runtime_error& e)
+        {
+            std::cerr << "Couldn't replay " << replayFile << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
     return game.run();
 }
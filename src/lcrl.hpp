@@ -12,14 +12,23 @@
 #include <iostream>
 
 #include "Actor.hpp"
+#include "DataCache.hpp"
+#include "DatafileWatcher.hpp"
 #include "Display.hpp"
 #include "Events.hpp"
 #include "EventHandler.hpp"
 #include "InitData.hpp"
 #include "Party.hpp"
+#include "Pool.hpp"
+#include "Profiler.hpp"
+#include "Random.hpp"
+#include "Recording.hpp"
+#include "SaveGame.hpp"
+#include "TaskGraph.hpp"
 #include "Tile.hpp"
 #include "Tileset.hpp"
 #include "Types.hpp"
+#include "Vault.hpp"
 
 namespace rlns
 {
@@ -37,17 +46,34 @@ namespace rlns
         private:
             InitData initData;
             DisplayPtr display;
+            StartupProfiler profiler; // created with the game, so it times all of startup
+            DatafileWatcher watcher;
+            BackgroundSaver saver;
+            std::string saveFile;
+
+            // the player's events are recorded to recordFile, or played back
+            RecordingPtr recording;
+            std::string recordFile;
+            bool replaying;
+            bool rendering;
+            TurnProfiler turnProfiler; // while replaying
 
         // Member Functions
         private:
             bool initialize();
+            void watchDatafiles(const std::string&, const std::string&, const std::string&);
             void gameLoop();
+            bool nextEvent(const EventHandler&, EventType&, std::string&);
+            EventType nextScreenEvent(const EventHandler&);
+            void saveGame();
             void render(const DisplayPtr) const;
             void cleanup();
 
         public:
-            LCRL() {}
+            LCRL() : replaying(false), rendering(true) {}
 
+            void recordTo(const std::string&);
+            void replayFrom(const std::string&, const bool);
             int run();
     };
 }